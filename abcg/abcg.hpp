@@ -13,9 +13,20 @@
 #ifndef ABCG_HPP_
 #define ABCG_HPP_
 
+#include "abcgAllocationTracker.hpp"
 #include "abcgApplication.hpp"
+#include "abcgBVH.hpp"
 #include "abcgException.hpp"
 #include "abcgExternal.hpp"
+#include "abcgFrameArena.hpp"
+#include "abcgFrameStatistics.hpp"
+#include "abcgFrameTimeHistory.hpp"
+#include "abcgInputRecorder.hpp"
+#include "abcgJobSystem.hpp"
+#include "abcgMetrics.hpp"
+#include "abcgMesh.hpp"
+#include "abcgMeshOptimizer.hpp"
+#include "abcgProfiler.hpp"
 #include "abcgTrackball.hpp"
 #include "abcgUtil.hpp"
 #include "abcgWindow.hpp"
@@ -0,0 +1,385 @@
+/**
+ * @file abcgAllocationTracker.cpp
+ * @brief Definition of abcg::AllocationTracker members and of the replaced
+ * global allocation functions.
+ *
+ * This file is part of ABCg (https://github.com/hbatagelo/abcg).
+ *
+ * @copyright (c) 2021--2022 Harlen Batagelo. All rights reserved.
+ * This project is released under the MIT License.
+ */
+
+#include "abcgAllocationTracker.hpp"
+
+#include <SDL_stdinc.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <new>
+#include <span>
+#include <string_view>
+#include <vector>
+
+#include <cppitertools/itertools.hpp>
+#include <fmt/core.h>
+#include <gsl/gsl>
+
+#include "abcgException.hpp"
+#include "abcgProfiler.hpp"
+#include "abcgUtil.hpp"
+
+#if __has_include(<execinfo.h>) && !defined(__EMSCRIPTEN__)
+#include <execinfo.h>
+// @cond Skipped by Doxygen
+#define ABCG_BACKTRACE
+// @endcond
+#endif
+
+namespace {
+
+#if defined(ABCG_BACKTRACE)
+// Stack frames of captureStack and recordAllocation
+constexpr std::size_t skippedStackFrames{2};
+#endif
+
+// Allocations of the calling thread. Trivially initialized, so that they can
+// be used by allocations made during static initialization
+thread_local constinit abcg::AllocationStatistics threadTotal{};
+
+// Set while a call stack is captured, since the unwinder may allocate
+thread_local constinit bool capturingStack{};
+
+#if defined(ABCG_ALLOCATION_TRACKER)
+void *SDLCALL trackedMalloc(std::size_t size) {
+  abcg::AllocationTracker::getInstance().recordAllocation(size);
+  return std::malloc(size); // NOLINT(cppcoreguidelines-no-malloc)
+}
+
+void *SDLCALL trackedCalloc(std::size_t count, std::size_t size) {
+  abcg::AllocationTracker::getInstance().recordAllocation(count * size);
+  return std::calloc(count, size); // NOLINT(cppcoreguidelines-no-malloc)
+}
+
+void *SDLCALL trackedRealloc(void *pointer, std::size_t size) {
+  abcg::AllocationTracker::getInstance().recordAllocation(size);
+  // NOLINTNEXTLINE(cppcoreguidelines-no-malloc)
+  return std::realloc(pointer, size);
+}
+
+void SDLCALL trackedFree(void *pointer) {
+  std::free(pointer); // NOLINT(cppcoreguidelines-no-malloc)
+}
+
+// Allocates like the default operator new, calling the new handler until the
+// allocation succeeds
+void *trackedNew(std::size_t size, std::size_t alignment) {
+  abcg::AllocationTracker::getInstance().recordAllocation(size);
+  size = std::max<std::size_t>(size, 1);
+  while (true) {
+    void *pointer{};
+    if (alignment <= __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+      pointer = std::malloc(size); // NOLINT(cppcoreguidelines-no-malloc)
+    } else {
+#if defined(WIN32)
+      pointer = _aligned_malloc(size, alignment);
+#else
+      // The size must be a multiple of the alignment
+      pointer = std::aligned_alloc(alignment,
+                                   (size + alignment - 1) / alignment *
+                                       alignment);
+#endif
+    }
+    if (pointer != nullptr)
+      return pointer;
+    auto *handler{std::get_new_handler()};
+    if (handler == nullptr)
+      throw std::bad_alloc{};
+    handler();
+  }
+}
+#endif
+
+} // namespace
+
+#if defined(ABCG_ALLOCATION_TRACKER)
+// The nothrow and array versions of the default allocation functions call
+// these ones
+void *operator new(std::size_t size) {
+  return trackedNew(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+}
+
+void *operator new(std::size_t size, std::align_val_t alignment) {
+  return trackedNew(size, static_cast<std::size_t>(alignment));
+}
+
+void operator delete(void *pointer) noexcept {
+  std::free(pointer); // NOLINT(cppcoreguidelines-no-malloc)
+}
+
+void operator delete(void *pointer,
+                     [[maybe_unused]] std::align_val_t alignment) noexcept {
+#if defined(WIN32)
+  if (static_cast<std::size_t>(alignment) > __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+    _aligned_free(pointer);
+    return;
+  }
+#endif
+  std::free(pointer); // NOLINT(cppcoreguidelines-no-malloc)
+}
+
+void operator delete(void *pointer,
+                     [[maybe_unused]] std::size_t size) noexcept {
+  ::operator delete(pointer);
+}
+
+void operator delete(void *pointer, [[maybe_unused]] std::size_t size,
+                     std::align_val_t alignment) noexcept {
+  ::operator delete(pointer, alignment);
+}
+#endif
+
+/**
+ * @brief Returns the allocation tracker of the application.
+ *
+ * The tracker is constant-initialized, so it can be used by allocations made
+ * before `main`.
+ *
+ * @return Reference to the tracker.
+ */
+abcg::AllocationTracker &abcg::AllocationTracker::getInstance() noexcept {
+  static constinit AllocationTracker tracker;
+  return tracker;
+}
+
+/**
+ * @brief Makes SDL allocate memory through functions that count the
+ * allocations.
+ *
+ * This must be called before any other SDL function. It does nothing unless
+ * ABCg was built with `ENABLE_ALLOCATION_TRACKER`.
+ */
+void abcg::AllocationTracker::installSDLHooks() noexcept {
+#if defined(ABCG_ALLOCATION_TRACKER)
+  SDL_SetMemoryFunctions(trackedMalloc, trackedCalloc, trackedRealloc,
+                         trackedFree);
+#endif
+}
+
+/**
+ * @brief Counts an allocation of the calling thread.
+ *
+ * This is called by the replaced allocation functions, and captures the call
+ * stack of the allocation if the warm-up frames have passed.
+ *
+ * @param bytes Number of bytes requested.
+ */
+void abcg::AllocationTracker::recordAllocation(std::size_t bytes) noexcept {
+  m_count.fetch_add(1, std::memory_order_relaxed);
+  m_bytes.fetch_add(bytes, std::memory_order_relaxed);
+  ++threadTotal.count;
+  threadTotal.bytes += bytes;
+
+  if (m_captureStacks.load(std::memory_order_relaxed) && !capturingStack) {
+    captureStack(bytes);
+  }
+}
+
+/**
+ * @brief Returns the allocations of all threads since the application
+ * started.
+ *
+ * @return Number and size of the allocations.
+ */
+abcg::AllocationStatistics abcg::AllocationTracker::getTotal() const noexcept {
+  return {.count = m_count.load(std::memory_order_relaxed),
+          .bytes = m_bytes.load(std::memory_order_relaxed)};
+}
+
+/**
+ * @brief Returns the allocations of the calling thread since it started.
+ *
+ * @return Number and size of the allocations.
+ */
+abcg::AllocationStatistics abcg::AllocationTracker::getThreadTotal() noexcept {
+  return threadTotal;
+}
+
+/**
+ * @brief Ends a frame.
+ *
+ * This is called by abcg::Window before painting each frame. Frames after
+ * the warm-up are counted in the steady state, and the call stacks of their
+ * allocations are captured.
+ *
+ * @return Allocations of all threads since the previous call.
+ */
+abcg::AllocationStatistics abcg::AllocationTracker::recordFrame() noexcept {
+  auto const total{getTotal()};
+  auto const frame{total - m_lastTotal};
+  m_lastTotal = total;
+
+  // Stacks are captured from the first frame after the warm-up
+  ++m_frames;
+  if (m_frames == std::max<std::uint64_t>(m_warmupFrames, 1)) {
+    m_captureStacks.store(isEnabled(), std::memory_order_relaxed);
+  }
+  if (m_frames > m_warmupFrames) {
+    if (frame.count > 0)
+      ++m_allocatingFrames;
+    m_maxFrameAllocations = std::max(m_maxFrameAllocations, frame.count);
+    m_steadyState.count += frame.count;
+    m_steadyState.bytes += frame.bytes;
+  }
+  return frame;
+}
+
+/**
+ * @brief Sets the number of frames before the steady state.
+ *
+ * This must be called before the first frame.
+ *
+ * @param frames Number of warm-up frames.
+ */
+void abcg::AllocationTracker::setWarmupFrames(std::uint64_t frames) noexcept {
+  m_warmupFrames = frames;
+}
+
+/**
+ * @brief Writes a report of the allocations to a JSON file.
+ *
+ * The report contains the totals, the allocations of the steady state, the
+ * allocations of each profiling zone (including its nested zones) and the
+ * call stacks with the most allocations in the steady state. Stack capture is
+ * stopped, so this is usually called once, on exit.
+ *
+ * @param path Path of the JSON file. An existing file is overwritten.
+ *
+ * @throw abcg::RuntimeError if the file could not be created.
+ */
+void abcg::AllocationTracker::exportReport(std::string const &path) {
+  m_captureStacks.store(false, std::memory_order_relaxed);
+
+  std::vector<Stack> stacks;
+  std::uint64_t droppedStacks{};
+  {
+    std::scoped_lock const lock{m_stacksMutex};
+    std::copy_if(m_stacks.begin(), m_stacks.end(), std::back_inserter(stacks),
+                 [](Stack const &stack) { return stack.depth > 0; });
+    droppedStacks = m_droppedStacks;
+  }
+  std::sort(stacks.begin(), stacks.end(), [](auto const &a, auto const &b) {
+    return a.allocations.count > b.allocations.count;
+  });
+  stacks.resize(std::min(stacks.size(), reportedStacks));
+
+  // Zones of all threads, by name
+  struct ZoneAllocations {
+    std::uint64_t calls{};
+    AllocationStatistics allocations{};
+  };
+  std::map<std::string_view, ZoneAllocations> zones;
+  auto &profiler{Profiler::getInstance()};
+  for (std::size_t thread{};; ++thread) {
+    auto const threadZones{profiler.getZones(thread)};
+    if (threadZones.empty())
+      break;
+    for (auto const &zone : threadZones) {
+      auto &zoneAllocations{zones[zone.name]};
+      ++zoneAllocations.calls;
+      zoneAllocations.allocations.count += zone.allocations.count;
+      zoneAllocations.allocations.bytes += zone.allocations.bytes;
+    }
+  }
+
+  std::ofstream stream(path, std::ios::trunc);
+  if (!stream) {
+    throw abcg::RuntimeError(
+        fmt::format("Failed to create allocation report {}", path));
+  }
+
+  auto const total{getTotal()};
+  auto const steadyFrames{m_frames - std::min(m_frames, m_warmupFrames)};
+  stream << fmt::format(
+      R"({{"frames":{},"warmupFrames":{},)"
+      R"("total":{{"allocations":{},"bytes":{}}},)"
+      R"("steadyState":{{"frames":{},"allocatingFrames":{},)"
+      R"("maxFrameAllocations":{},"allocations":{},"bytes":{}}},)"
+      R"("droppedStacks":{},"zones":[)",
+      m_frames, m_warmupFrames, total.count, total.bytes, steadyFrames,
+      m_allocatingFrames, m_maxFrameAllocations, m_steadyState.count,
+      m_steadyState.bytes, droppedStacks);
+
+  auto separator{""};
+  for (auto const &[name, zone] : zones) {
+    stream << fmt::format(
+        R"({}{{"name":"{}","calls":{},"allocations":{},"bytes":{}}})",
+        separator, abcg::escapeJSON(name), zone.calls, zone.allocations.count,
+        zone.allocations.bytes);
+    separator = ",\n";
+  }
+
+  stream << R"(],"stacks":[)";
+  separator = "";
+  for (auto const &stack : stacks) {
+    stream << fmt::format(R"({}{{"allocations":{},"bytes":{},"frames":[)",
+                          separator, stack.allocations.count,
+                          stack.allocations.bytes);
+#if defined(ABCG_BACKTRACE)
+    auto *symbols{backtrace_symbols(stack.frames.data(),
+                                    gsl::narrow<int>(stack.depth))};
+    if (symbols != nullptr) {
+      std::span const frames{symbols, stack.depth};
+      for (auto &&[index, frame] : iter::enumerate(frames)) {
+        stream << fmt::format(R"({}"{}")", index == 0 ? "" : ",",
+                              abcg::escapeJSON(frame));
+      }
+      std::free(symbols); // NOLINT(cppcoreguidelines-no-malloc)
+    }
+#endif
+    stream << "]}";
+    separator = ",\n";
+  }
+  stream << "]}\n";
+}
+
+// Adds an allocation to the entry of its call stack. Nothing here may
+// allocate with operator new
+void abcg::AllocationTracker::captureStack(
+    [[maybe_unused]] std::size_t bytes) noexcept {
+#if defined(ABCG_BACKTRACE)
+  capturingStack = true;
+  std::array<void *, maxStackDepth + skippedStackFrames> frames{};
+  auto const captured{gsl::narrow_cast<std::size_t>(
+      backtrace(frames.data(), gsl::narrow_cast<int>(frames.size())))};
+  capturingStack = false;
+  if (captured <= skippedStackFrames)
+    return;
+
+  Stack stack{.depth = captured - skippedStackFrames};
+  std::copy_n(frames.begin() + skippedStackFrames, stack.depth,
+              stack.frames.begin());
+
+  // FNV-1a
+  stack.hash = 14695981039346656037ULL;
+  for (auto const *frame : stack.frames) {
+    stack.hash ^= reinterpret_cast<std::uintptr_t>(frame);
+    stack.hash *= 1099511628211ULL;
+  }
+
+  std::scoped_lock const lock{m_stacksMutex};
+  for (auto const probe : iter::range(maxStacks)) {
+    auto &entry{m_stacks.at((stack.hash + probe) % maxStacks)};
+    if (entry.depth == 0) {
+      entry = stack;
+    } else if (entry.hash != stack.hash || entry.frames != stack.frames) {
+      continue;
+    }
+    ++entry.allocations.count;
+    entry.allocations.bytes += bytes;
+    return;
+  }
+  ++m_droppedStacks;
+#endif
+}
@@ -0,0 +1,127 @@
+/**
+ * @file abcgAllocationTracker.hpp
+ * @brief Header file of abcg::AllocationTracker.
+ *
+ * Declaration of the heap allocation tracker.
+ *
+ * This file is part of ABCg (https://github.com/hbatagelo/abcg).
+ *
+ * @copyright (c) 2021--2022 Harlen Batagelo. All rights reserved.
+ * This project is released under the MIT License.
+ */
+
+#ifndef ABCG_ALLOCATION_TRACKER_HPP_
+#define ABCG_ALLOCATION_TRACKER_HPP_
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+#include "abcgFrameStatistics.hpp"
+
+namespace abcg {
+class AllocationTracker;
+} // namespace abcg
+
+/**
+ * @brief Counts the heap allocations of the application per frame and per
+ * profiling zone.
+ *
+ * When ABCg is built with `ENABLE_ALLOCATION_TRACKER`, the global `operator
+ * new` is replaced and the memory functions of SDL are hooked, so that every
+ * allocation made with `new`, by the standard containers, or by SDL is
+ * counted. Allocations made directly with `malloc` are not counted.
+ *
+ * The allocations of each frame are reported in
+ * abcg::FrameStatistics::allocations, and the allocations of each profiling
+ * zone are written to the Chrome trace exported with `--profile`. After a
+ * number of warm-up frames, the call stack of each allocation is also
+ * captured, so that the code allocating in the steady state can be found.
+ *
+ * Launching the application with `--allocations <file>` writes a JSON report
+ * on exit, whose `steadyState.allocatingFrames` can be checked by a CI job to
+ * enforce a zero-allocation policy for the frames after the warm-up:
+ * @code
+ * ./app --replay input.rec --allocations report.json
+ * jq -e '.steadyState.allocatingFrames == 0' report.json
+ * @endcode
+ *
+ * Call stacks are only captured on glibc and macOS. Their symbols are
+ * resolved with `backtrace_symbols`, so the application should be linked
+ * with `-rdynamic` (done by the CMake option).
+ */
+class abcg::AllocationTracker {
+public:
+  /** @brief Default number of frames before the steady state. */
+  static constexpr std::uint64_t defaultWarmupFrames{120};
+  /** @brief Maximum number of distinct call stacks kept. */
+  static constexpr std::size_t maxStacks{1024};
+  /** @brief Maximum number of frames of a call stack. */
+  static constexpr std::size_t maxStackDepth{16};
+  /** @brief Number of call stacks written to the report. */
+  static constexpr std::size_t reportedStacks{20};
+
+  constexpr AllocationTracker() noexcept = default;
+  AllocationTracker(AllocationTracker const &) = delete;
+  AllocationTracker(AllocationTracker &&) = delete;
+  AllocationTracker &operator=(AllocationTracker const &) = delete;
+  AllocationTracker &operator=(AllocationTracker &&) = delete;
+  ~AllocationTracker() = default;
+
+  [[nodiscard]] static AllocationTracker &getInstance() noexcept;
+  static void installSDLHooks() noexcept;
+
+  void recordAllocation(std::size_t bytes) noexcept;
+  [[nodiscard]] AllocationStatistics getTotal() const noexcept;
+  [[nodiscard]] static AllocationStatistics getThreadTotal() noexcept;
+
+  [[nodiscard]] AllocationStatistics recordFrame() noexcept;
+  void setWarmupFrames(std::uint64_t frames) noexcept;
+  void exportReport(std::string const &path);
+
+  /**
+   * @brief Whether allocations are tracked.
+   *
+   * @return `true` if ABCg was built with `ENABLE_ALLOCATION_TRACKER`.
+   */
+  [[nodiscard]] static constexpr bool isEnabled() noexcept {
+#if defined(ABCG_ALLOCATION_TRACKER)
+    return true;
+#else
+    return false;
+#endif
+  }
+
+private:
+  // Allocations made from the same call stack
+  struct Stack {
+    std::array<void *, maxStackDepth> frames{};
+    std::size_t depth{};
+    std::uint64_t hash{};
+    AllocationStatistics allocations{};
+  };
+
+  void captureStack(std::size_t bytes) noexcept;
+
+  std::atomic<std::uint64_t> m_count{};
+  std::atomic<std::uint64_t> m_bytes{};
+
+  // Frame counters, only updated by recordFrame
+  AllocationStatistics m_lastTotal{};
+  std::uint64_t m_frames{};
+  std::uint64_t m_warmupFrames{defaultWarmupFrames};
+  std::uint64_t m_allocatingFrames{};
+  std::uint64_t m_maxFrameAllocations{};
+  AllocationStatistics m_steadyState{};
+
+  // Open-addressing table of call stacks captured in the steady state
+  std::atomic<bool> m_captureStacks{};
+  std::mutex m_stacksMutex;
+  std::array<Stack, maxStacks> m_stacks{};
+  std::uint64_t m_droppedStacks{};
+};
+
+#endif
@@ -13,9 +13,12 @@
 #include <SDL_image.h>
 #include <SDL_thread.h>
 
+#include <charconv>
 #include <span>
+#include <string_view>
 
 #include "abcgException.hpp"
+#include "abcgProfiler.hpp"
 #include "abcgWindow.hpp"
 
 #if defined(__EMSCRIPTEN__)
@@ -27,6 +30,24 @@
 // @endcond
 #include "tiny_obj_loader.h"
 
+namespace {
+
+// Parses the unsigned integer value of a command-line option
+template <typename T>
+[[nodiscard]] T parseOptionValue(std::string_view option,
+                                 std::string_view value) {
+  T result{};
+  auto const *const last{value.data() + value.size()};
+  if (auto const [end, error]{std::from_chars(value.data(), last, result)};
+      error != std::errc{} || end != last) {
+    throw abcg::RuntimeError(
+        fmt::format("Invalid value '{}' of option {}", value, option));
+  }
+  return result;
+}
+
+} // namespace
+
 #if defined(__EMSCRIPTEN__)
 void abcg::mainLoopCallback(void *userData) {
   abcg::Application &app{*(static_cast<abcg::Application *>(userData))};
@@ -38,14 +59,42 @@ void abcg::mainLoopCallback(void *userData) {
 /**
  * @brief Constructs an abcg::Application object.
  *
+ * The following command-line options are recognized:
+ * - `--record <file>`: records the input of the window to a file;
+ * - `--replay <file>`: replays the input recorded in a file;
+ * - `--profile <file>`: writes the profiling zones to a Chrome trace file on
+ *   exit;
+ * - `--frame-stats <file>`: writes the timings of the last frames on exit, as
+ *   a summary of percentiles if the file name ends with `.json`, or as one
+ *   line per frame in CSV otherwise;
+ * - `--metrics <name>`: publishes the metrics of each frame to the POSIX
+ *   shared memory object `<name>`, which can be followed with the
+ *   `abcgmetrics` tool;
+ * - `--allocations <file>`: writes a JSON report of the heap allocations on
+ *   exit;
+ * - `--allocation-warmup <frames>`: number of frames before the steady state
+ *   of the allocation report (120 by default);
+ * - `--jobs <count>`: number of worker threads of the job system (one per
+ *   core besides the main thread by default).
+ *
+ * @sa abcg::InputRecorder.
+ * @sa abcg::Profiler.
+ * @sa abcg::FrameTimeHistory.
+ * @sa abcg::MetricsPublisher.
+ * @sa abcg::AllocationTracker.
+ * @sa abcg::JobSystem.
+ *
  * @param argc Number of arguments passed to the program from the environment in
  * which the program is run.
  * @param argv Pointer to the first element of an array of @a argc + 1 pointers,
  * of which the last one is nullptr and the previous ones, if any, point to
  * null-terminated multibyte strings that represent the arguments passed to the
  * program from the execution environment.
+ *
+ * @throw abcg::RuntimeError if the value of `--allocation-warmup` or `--jobs`
+ * is not an unsigned integer.
  */
-abcg::Application::Application([[maybe_unused]] int argc, char **argv) {
+abcg::Application::Application(int argc, char **argv) {
   // Get executable relative path
   std::string const argv_str{*std::span{&argv, 1}[0]};
 #if defined(WIN32)
@@ -61,20 +110,54 @@ abcg::Application::Application([[maybe_unused]] int argc, char **argv) {
 #endif
 
   abcg::Application::m_assetsPath = abcg::Application::m_basePath + "/assets/";
+
+  // Input recording, profiling, frame statistics, metrics, allocation
+  // tracking and job system options
+  std::span const arguments{argv, gsl::narrow<std::size_t>(argc)};
+  for (auto const index : iter::range<std::size_t>(1, arguments.size() - 1)) {
+    std::string_view const option{arguments[index]};
+    if (option == "--record") {
+      m_recordPath = arguments[index + 1];
+    } else if (option == "--replay") {
+      m_replayPath = arguments[index + 1];
+    } else if (option == "--profile") {
+      m_profilePath = arguments[index + 1];
+    } else if (option == "--frame-stats") {
+      m_frameStatisticsPath = arguments[index + 1];
+    } else if (option == "--metrics") {
+      m_metricsName = arguments[index + 1];
+    } else if (option == "--allocations") {
+      m_allocationsPath = arguments[index + 1];
+    } else if (option == "--allocation-warmup") {
+      m_allocationWarmupFrames = parseOptionValue<std::uint64_t>(
+          option, arguments[index + 1]);
+    } else if (option == "--jobs") {
+      m_jobWorkerCount =
+          parseOptionValue<std::size_t>(option, arguments[index + 1]);
+    }
+  }
 }
 
 /**
  * @brief Runs the application for the given window.
  *
- * Initializes the SDL library and its subsystems, initializes the window and
- * runs the event loop.
+ * Initializes the SDL library and its subsystems, starts the job system,
+ * initializes the window and runs the event loop.
  *
  * @param window L-value reference to the window object.
  *
  * @throw abcg::SDLError if `SDL_Init` failed.
  * @throw abcg::SDLImageError if `IMG_Init` failed.
+ * @throw abcg::RuntimeError if the input recording could not be opened, or if
+ * the profiler trace, the frame statistics or the allocation report could not
+ * be written, or if the metrics shared memory could not be created.
  */
 void abcg::Application::run(Window &window) {
+  // SDL must not allocate before its memory functions are set
+  auto &allocationTracker{AllocationTracker::getInstance()};
+  AllocationTracker::installSDLHooks();
+  allocationTracker.setWarmupFrames(m_allocationWarmupFrames);
+
   if (Uint32 const subsystemMask{SDL_INIT_VIDEO | SDL_INIT_AUDIO |
                                  SDL_INIT_GAMECONTROLLER};
       SDL_Init(subsystemMask) != 0) {
@@ -91,6 +174,22 @@ void abcg::Application::run(Window &window) {
 #endif
 
   m_window = &window;
+
+  // The window may read the random seed on creation
+  auto &recorder{m_window->m_inputRecorder};
+  if (!m_replayPath.empty()) {
+    recorder.startReplay(m_replayPath);
+  } else if (!m_recordPath.empty()) {
+    recorder.startRecording(m_recordPath);
+  }
+  if (!m_metricsName.empty()) {
+    m_window->m_metricsPublisher.open(m_metricsName);
+  }
+
+  // The window may submit jobs on creation
+  auto &jobSystem{JobSystem::getInstance()};
+  jobSystem.start(m_jobWorkerCount);
+
   m_window->templateCreate();
 
 #if defined(__EMSCRIPTEN__)
@@ -102,22 +201,86 @@ void abcg::Application::run(Window &window) {
   };
 #endif
 
+  if (recorder.getMode() != InputRecorderMode::Off) {
+    fmt::print("{} {} frames ({:.3f} s)\n",
+               recorder.getMode() == InputRecorderMode::Record ? "Recorded"
+                                                               : "Replayed",
+               recorder.getFrameCount(), recorder.getClockTime());
+  }
+
+  if (!m_frameStatisticsPath.empty()) {
+    auto const &history{m_window->m_frameTimeHistory};
+    if (m_frameStatisticsPath.ends_with(".json")) {
+      history.exportJSON(m_frameStatisticsPath);
+    } else {
+      history.exportCSV(m_frameStatisticsPath);
+    }
+  }
+
+  if (!m_allocationsPath.empty()) {
+    if (AllocationTracker::isEnabled()) {
+      allocationTracker.exportReport(m_allocationsPath);
+    } else {
+      fmt::print(
+          "Warning: ABCg was built without ENABLE_ALLOCATION_TRACKER\n");
+    }
+  }
+
+  // Pending jobs and main thread continuations may still use the window and
+  // its graphics context
+  jobSystem.stop();
   m_window->templateDestroy();
 
+  if (!m_profilePath.empty()) {
+    if (Profiler::isEnabled()) {
+      Profiler::getInstance().exportChromeTrace(m_profilePath);
+    } else {
+      fmt::print("Warning: ABCg was built without ENABLE_PROFILER\n");
+    }
+  }
+
 #if !defined(__EMSCRIPTEN__)
   IMG_Quit();
 #endif
   SDL_Quit();
 }
 
-void abcg::Application::mainLoopIterator([[maybe_unused]] bool &done) const {
+void abcg::Application::mainLoopIterator([[maybe_unused]] bool &done) {
+  ABCG_PROFILE_ZONE("Application::mainLoopIterator");
+
+  auto &recorder{m_window->m_inputRecorder};
+  auto const replaying{recorder.getMode() == InputRecorderMode::Replay};
+
   SDL_Event event{};
   while (SDL_PollEvent(&event) != 0) {
 #if !defined(__EMSCRIPTEN__)
     if (event.type == SDL_QUIT)
       done = true;
 #endif
+    // Live input is ignored during replay
+    if (replaying && InputRecorder::isRecordable(event))
+      continue;
+    recorder.recordEvent(event);
     m_window->templateHandleEvent(event, done);
   }
+
+  if (replaying) {
+    if (!recorder.replayFrame(m_replayedEvents)) {
+      done = true;
+#if defined(__EMSCRIPTEN__)
+      emscripten_cancel_main_loop();
+#endif
+      return;
+    }
+    for (auto &replayedEvent : m_replayedEvents) {
+      // Recorded events are sent to the current window
+      replayedEvent.window.windowID = m_window->getSDLWindowID();
+      m_window->templateHandleEvent(replayedEvent, done);
+    }
+  }
+
+  // Continuations of the jobs that finished since the last frame
+  JobSystem::getInstance().runMainThreadJobs();
+
   m_window->templatePaint();
 }
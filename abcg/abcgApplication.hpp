@@ -11,7 +11,14 @@
 #ifndef ABCG_APPLICATION_HPP_
 #define ABCG_APPLICATION_HPP_
 
+#include <cstddef>
+#include <cstdint>
 #include <string>
+#include <vector>
+
+#include "abcgAllocationTracker.hpp"
+#include "abcgExternal.hpp"
+#include "abcgJobSystem.hpp"
 
 #define ABCG_VERSION_MAJOR 3
 #define ABCG_VERSION_MINOR 0
@@ -74,10 +81,22 @@ public:
   [[nodiscard]] static std::string const &getBasePath() { return m_basePath; }
 
 private:
-  void mainLoopIterator(bool &done) const;
+  void mainLoopIterator(bool &done);
 
   Window *m_window{};
 
+  // Options given in the command line
+  std::string m_recordPath;
+  std::string m_replayPath;
+  std::string m_profilePath;
+  std::string m_frameStatisticsPath;
+  std::string m_metricsName;
+  std::string m_allocationsPath;
+  std::uint64_t m_allocationWarmupFrames{
+      AllocationTracker::defaultWarmupFrames};
+  std::size_t m_jobWorkerCount{JobSystem::getDefaultWorkerCount()};
+  std::vector<SDL_Event> m_replayedEvents;
+
 #if defined(__EMSCRIPTEN__)
   friend void mainLoopCallback(void *userData);
 #endif
@@ -0,0 +1,513 @@
+/**
+ * @file abcgBVH.cpp
+ * @brief Definition of abcg::BVH and related classes.
+ *
+ * This file is part of ABCg (https://github.com/hbatagelo/abcg).
+ *
+ * @copyright (c) 2021--2022 Harlen Batagelo. All rights reserved.
+ * This project is released under the MIT License.
+ */
+
+#include "abcgBVH.hpp"
+
+#include <algorithm>
+
+#if defined(__SSE__) || defined(_M_X64) || defined(_M_AMD64)
+#define ABCG_BVH_SSE
+#include <xmmintrin.h>
+#endif
+
+#include "abcgException.hpp"
+
+/**
+ * @brief Returns the bounding box of this box transformed by a matrix.
+ *
+ * @param matrix Affine transformation matrix (e.g., a model matrix).
+ *
+ * @return Smallest axis-aligned box that contains the transformed box.
+ */
+abcg::AABB abcg::AABB::transformed(glm::mat4 const &matrix) const noexcept {
+  auto const center{(min + max) * 0.5f};
+  auto const extent{(max - min) * 0.5f};
+  auto const newCenter{glm::vec3{matrix * glm::vec4{center, 1.0f}}};
+  glm::vec3 newExtent{};
+  for (auto const row : iter::range(3)) {
+    for (auto const column : iter::range(3)) {
+      newExtent[row] += std::abs(matrix[column][row]) * extent[column];
+    }
+  }
+  return {.min = newCenter - newExtent, .max = newCenter + newExtent};
+}
+
+/**
+ * @brief Constructs a frustum from a view-projection matrix.
+ *
+ * The planes are extracted as described by Gribb and Hartmann, "Fast
+ * Extraction of Viewing Frustum Planes from the World-View-Projection
+ * Matrix", 2001, assuming OpenGL clip-space depth in [-w, w]. For Vulkan
+ * projection matrices with depth in [0, w], the near plane is conservative.
+ *
+ * @param viewProjMatrix Product of the projection matrix and the view matrix.
+ * If it also includes a model matrix, the frustum is in object space.
+ */
+abcg::Frustum::Frustum(glm::mat4 const &viewProjMatrix) noexcept {
+  auto const row{[&](int index) {
+    return glm::vec4{viewProjMatrix[0][index], viewProjMatrix[1][index],
+                     viewProjMatrix[2][index], viewProjMatrix[3][index]};
+  }};
+
+  std::array const planes{
+      row(3) + row(0), // Left
+      row(3) - row(0), // Right
+      row(3) + row(1), // Bottom
+      row(3) - row(1), // Top
+      row(3) + row(2), // Near
+      row(3) - row(2)  // Far
+  };
+
+  m_distance.fill(1.0f);
+  for (auto &&[lane, plane] : iter::enumerate(planes)) {
+    auto const length{glm::length(glm::vec3{plane})};
+    auto const normalized{length > 0.0f ? plane / length : plane};
+    m_normalX.at(lane) = normalized.x;
+    m_normalY.at(lane) = normalized.y;
+    m_normalZ.at(lane) = normalized.z;
+    m_distance.at(lane) = normalized.w;
+  }
+}
+
+/**
+ * @brief Tests a box against the planes of the frustum.
+ *
+ * @param box Box in the same space as the frustum.
+ *
+ * @return abcg::Frustum::Intersection::Outside if the box is entirely behind
+ * one of the planes, abcg::Frustum::Intersection::Inside if the box is
+ * entirely in front of all planes, and
+ * abcg::Frustum::Intersection::Intersecting otherwise.
+ */
+abcg::Frustum::Intersection
+abcg::Frustum::test(AABB const &box) const noexcept {
+  auto const center{(box.min + box.max) * 0.5f};
+  auto const extent{(box.max - box.min) * 0.5f};
+
+#if defined(ABCG_BVH_SSE)
+  auto const zero{_mm_setzero_ps()};
+  auto const centerX{_mm_set1_ps(center.x)};
+  auto const centerY{_mm_set1_ps(center.y)};
+  auto const centerZ{_mm_set1_ps(center.z)};
+  auto const extentX{_mm_set1_ps(extent.x)};
+  auto const extentY{_mm_set1_ps(extent.y)};
+  auto const extentZ{_mm_set1_ps(extent.z)};
+  auto const abs{[zero](__m128 value) {
+    return _mm_max_ps(value, _mm_sub_ps(zero, value));
+  }};
+
+  int outside{};
+  int intersecting{};
+  for (std::size_t lane{}; lane < m_lanes; lane += 4) {
+    auto const normalX{_mm_load_ps(&m_normalX.at(lane))};
+    auto const normalY{_mm_load_ps(&m_normalY.at(lane))};
+    auto const normalZ{_mm_load_ps(&m_normalZ.at(lane))};
+    auto const distance{_mm_add_ps(
+        _mm_add_ps(_mm_mul_ps(normalX, centerX), _mm_mul_ps(normalY, centerY)),
+        _mm_add_ps(_mm_mul_ps(normalZ, centerZ),
+                   _mm_load_ps(&m_distance.at(lane))))};
+    auto const radius{
+        _mm_add_ps(_mm_add_ps(_mm_mul_ps(abs(normalX), extentX),
+                              _mm_mul_ps(abs(normalY), extentY)),
+                   _mm_mul_ps(abs(normalZ), extentZ))};
+    outside |= _mm_movemask_ps(_mm_cmplt_ps(_mm_add_ps(distance, radius), zero));
+    intersecting |=
+        _mm_movemask_ps(_mm_cmplt_ps(_mm_sub_ps(distance, radius), zero));
+  }
+
+  if (outside != 0)
+    return Intersection::Outside;
+  return intersecting != 0 ? Intersection::Intersecting : Intersection::Inside;
+#else
+  auto result{Intersection::Inside};
+  for (auto const lane : iter::range(m_lanes)) {
+    auto const distance{m_normalX[lane] * center.x +
+                        m_normalY[lane] * center.y +
+                        m_normalZ[lane] * center.z + m_distance[lane]};
+    auto const radius{std::abs(m_normalX[lane]) * extent.x +
+                      std::abs(m_normalY[lane]) * extent.y +
+                      std::abs(m_normalZ[lane]) * extent.z};
+    if (distance + radius < 0.0f)
+      return Intersection::Outside;
+    if (distance - radius < 0.0f)
+      result = Intersection::Intersecting;
+  }
+  return result;
+#endif
+}
+
+/**
+ * @brief Inserts an object into the hierarchy.
+ *
+ * @param bounds Bounding box of the object.
+ * @param userData User value returned by abcg::BVH::cull when the object is
+ * visible.
+ *
+ * @return Proxy that identifies the object in the hierarchy.
+ */
+abcg::BVH::ProxyID abcg::BVH::insert(AABB const &bounds,
+                                     std::uint32_t userData) {
+  auto const leaf{allocateNode()};
+  auto &node{m_nodes[leaf]};
+  node.bounds = bounds;
+  node.userData = userData;
+  node.height = 0;
+  insertLeaf(leaf);
+  ++m_leafCount;
+  return leaf;
+}
+
+/**
+ * @brief Removes an object from the hierarchy.
+ *
+ * @param proxy Proxy returned by abcg::BVH::insert.
+ *
+ * @throw abcg::RuntimeError if the proxy is not a valid object.
+ */
+void abcg::BVH::remove(ProxyID proxy) {
+  if (proxy >= m_nodes.size() || !m_nodes[proxy].isLeaf() ||
+      m_nodes[proxy].height != 0) {
+    throw abcg::RuntimeError("Invalid BVH proxy");
+  }
+  removeLeaf(proxy);
+  freeNode(proxy);
+  --m_leafCount;
+}
+
+/**
+ * @brief Updates the bounds of an object.
+ *
+ * If the new bounds overlap the previous ones, the boxes of the ancestors of
+ * the object are refitted. Otherwise, as when an object teleports, the object
+ * is reinserted so that the quality of the tree does not degrade.
+ *
+ * @param proxy Proxy returned by abcg::BVH::insert.
+ * @param bounds New bounding box of the object.
+ *
+ * @throw abcg::RuntimeError if the proxy is not a valid object.
+ */
+void abcg::BVH::update(ProxyID proxy, AABB const &bounds) {
+  if (proxy >= m_nodes.size() || !m_nodes[proxy].isLeaf() ||
+      m_nodes[proxy].height != 0) {
+    throw abcg::RuntimeError("Invalid BVH proxy");
+  }
+
+  auto &node{m_nodes[proxy]};
+  if (node.bounds == bounds)
+    return;
+
+  if (node.bounds.overlaps(bounds)) {
+    node.bounds = bounds;
+    refit(node.parent);
+  } else {
+    removeLeaf(proxy);
+    m_nodes[proxy].bounds = bounds;
+    insertLeaf(proxy);
+  }
+}
+
+/**
+ * @brief Removes all objects from the hierarchy.
+ */
+void abcg::BVH::clear() noexcept {
+  m_nodes.clear();
+  m_root = nullProxy;
+  m_freeList = nullProxy;
+  m_leafCount = 0;
+}
+
+/**
+ * @brief Returns the bounds of an object.
+ *
+ * @param proxy Proxy returned by abcg::BVH::insert.
+ *
+ * @return Bounding box of the object.
+ */
+abcg::AABB const &abcg::BVH::getBounds(ProxyID proxy) const {
+  return m_nodes.at(proxy).bounds;
+}
+
+/**
+ * @brief Returns the user value of an object.
+ *
+ * @param proxy Proxy returned by abcg::BVH::insert.
+ *
+ * @return User value passed to abcg::BVH::insert.
+ */
+std::uint32_t abcg::BVH::getUserData(ProxyID proxy) const {
+  return m_nodes.at(proxy).userData;
+}
+
+/**
+ * @brief Computes the set of objects whose bounds intersect a frustum.
+ *
+ * Subtrees entirely outside the frustum are skipped, and the objects of
+ * subtrees entirely inside the frustum are added without further tests. The
+ * cost is thus roughly proportional to the number of visible objects.
+ *
+ * @param frustum Frustum in the same space as the bounds of the objects.
+ * @param visible Vector to which the user values of the visible objects are
+ * appended.
+ * @param scratch Resource from which the traversal stack is allocated, such
+ * as abcg::Window::getFrameArena.
+ *
+ * @return Number of visible and culled objects, and number of boxes tested.
+ */
+abcg::CullingStatistics
+abcg::BVH::cull(Frustum const &frustum, std::vector<std::uint32_t> &visible,
+                std::pmr::memory_resource *scratch) const {
+  CullingStatistics statistics{};
+  if (m_root == nullProxy)
+    return statistics;
+
+  auto const firstVisible{visible.size()};
+
+  std::pmr::vector<ProxyID> stack{scratch};
+  stack.reserve(64);
+  stack.push_back(m_root);
+  while (!stack.empty()) {
+    auto const index{stack.back()};
+    stack.pop_back();
+    auto const &node{m_nodes[index]};
+
+    ++statistics.nodesTested;
+    switch (frustum.test(node.bounds)) {
+    case Frustum::Intersection::Outside:
+      break;
+    case Frustum::Intersection::Inside:
+      collectLeaves(index, visible, stack);
+      break;
+    case Frustum::Intersection::Intersecting:
+      if (node.isLeaf()) {
+        visible.push_back(node.userData);
+      } else {
+        stack.push_back(node.children[0]);
+        stack.push_back(node.children[1]);
+      }
+      break;
+    }
+  }
+
+  statistics.visible = visible.size() - firstVisible;
+  statistics.culled = m_leafCount - statistics.visible;
+  return statistics;
+}
+
+abcg::BVH::ProxyID abcg::BVH::allocateNode() {
+  if (m_freeList == nullProxy) {
+    m_nodes.emplace_back();
+    return gsl::narrow<ProxyID>(m_nodes.size() - 1);
+  }
+  auto const index{m_freeList};
+  m_freeList = m_nodes[index].parent;
+  m_nodes[index] = Node{};
+  return index;
+}
+
+// Free nodes are linked through their parent index
+void abcg::BVH::freeNode(ProxyID node) {
+  m_nodes[node] = Node{};
+  m_nodes[node].parent = m_freeList;
+  m_freeList = node;
+}
+
+void abcg::BVH::insertLeaf(ProxyID leaf) {
+  if (m_root == nullProxy) {
+    m_root = leaf;
+    m_nodes[leaf].parent = nullProxy;
+    return;
+  }
+
+  // Descend to the sibling that minimizes the increase of surface area
+  auto const leafBounds{m_nodes[leaf].bounds};
+  auto index{m_root};
+  while (!m_nodes[index].isLeaf()) {
+    auto const &node{m_nodes[index]};
+    auto const area{node.bounds.area()};
+    auto const combinedArea{merge(node.bounds, leafBounds).area()};
+
+    // Cost of creating a new parent for this node and the new leaf
+    auto const cost{2.0f * combinedArea};
+    // Minimum cost of pushing the leaf further down the tree
+    auto const inheritanceCost{2.0f * (combinedArea - area)};
+
+    std::array<float, 2> childCosts{};
+    for (auto const child : iter::range(std::size_t{2})) {
+      auto const &childNode{m_nodes[node.children.at(child)]};
+      auto const childArea{merge(childNode.bounds, leafBounds).area()};
+      childCosts.at(child) =
+          (childNode.isLeaf() ? childArea
+                              : childArea - childNode.bounds.area()) +
+          inheritanceCost;
+    }
+
+    if (cost < childCosts[0] && cost < childCosts[1])
+      break;
+
+    index = node.children[childCosts[0] < childCosts[1] ? 0 : 1];
+  }
+
+  // Create a new parent for the sibling and the leaf
+  auto const sibling{index};
+  auto const oldParent{m_nodes[sibling].parent};
+  auto const newParent{allocateNode()};
+  m_nodes[newParent].parent = oldParent;
+  m_nodes[newParent].bounds = merge(leafBounds, m_nodes[sibling].bounds);
+  m_nodes[newParent].height = m_nodes[sibling].height + 1;
+  m_nodes[newParent].children = {sibling, leaf};
+  m_nodes[sibling].parent = newParent;
+  m_nodes[leaf].parent = newParent;
+
+  if (oldParent == nullProxy) {
+    m_root = newParent;
+  } else {
+    auto &children{m_nodes[oldParent].children};
+    children[children[0] == sibling ? 0 : 1] = newParent;
+  }
+
+  // Walk back up fixing heights and bounds
+  index = m_nodes[leaf].parent;
+  while (index != nullProxy) {
+    index = balance(index);
+    auto &node{m_nodes[index]};
+    auto const &first{m_nodes[node.children[0]]};
+    auto const &second{m_nodes[node.children[1]]};
+    node.height = 1 + std::max(first.height, second.height);
+    node.bounds = merge(first.bounds, second.bounds);
+    index = node.parent;
+  }
+}
+
+void abcg::BVH::removeLeaf(ProxyID leaf) {
+  if (leaf == m_root) {
+    m_root = nullProxy;
+    return;
+  }
+
+  auto const parent{m_nodes[leaf].parent};
+  auto const grandParent{m_nodes[parent].parent};
+  auto const &parentChildren{m_nodes[parent].children};
+  auto const sibling{parentChildren[0] == leaf ? parentChildren[1]
+                                               : parentChildren[0]};
+
+  if (grandParent == nullProxy) {
+    m_root = sibling;
+    m_nodes[sibling].parent = nullProxy;
+    freeNode(parent);
+    return;
+  }
+
+  // Replace the parent with the sibling
+  auto &children{m_nodes[grandParent].children};
+  children[children[0] == parent ? 0 : 1] = sibling;
+  m_nodes[sibling].parent = grandParent;
+  freeNode(parent);
+
+  auto index{grandParent};
+  while (index != nullProxy) {
+    index = balance(index);
+    auto &node{m_nodes[index]};
+    auto const &first{m_nodes[node.children[0]]};
+    auto const &second{m_nodes[node.children[1]]};
+    node.height = 1 + std::max(first.height, second.height);
+    node.bounds = merge(first.bounds, second.bounds);
+    index = node.parent;
+  }
+}
+
+// Recomputes the bounds of a node and its ancestors, stopping as soon as a
+// node does not change
+void abcg::BVH::refit(ProxyID node) {
+  while (node != nullProxy) {
+    auto &current{m_nodes[node]};
+    auto const bounds{merge(m_nodes[current.children[0]].bounds,
+                            m_nodes[current.children[1]].bounds)};
+    if (bounds == current.bounds)
+      break;
+    current.bounds = bounds;
+    node = current.parent;
+  }
+}
+
+// Performs a tree rotation if the subtrees of a node differ in height by more
+// than one. Returns the node that takes the place of the given node.
+abcg::BVH::ProxyID abcg::BVH::balance(ProxyID node) {
+  auto &a{m_nodes[node]};
+  if (a.isLeaf() || a.height < 2)
+    return node;
+
+  auto const indexB{a.children[0]};
+  auto const indexC{a.children[1]};
+  auto &b{m_nodes[indexB]};
+  auto &c{m_nodes[indexC]};
+  auto const balanceFactor{c.height - b.height};
+
+  // Promotes the child at position `side` of node A (the taller child), and
+  // moves its shorter grandchild to node A
+  auto const rotate{[&](Node &up, ProxyID upIndex, std::size_t side) {
+    auto const indexF{up.children[0]};
+    auto const indexG{up.children[1]};
+    auto &f{m_nodes[indexF]};
+    auto &g{m_nodes[indexG]};
+    auto &other{m_nodes[a.children[1 - side]]};
+
+    up.children[0] = node;
+    up.parent = a.parent;
+    a.parent = upIndex;
+
+    if (up.parent == nullProxy) {
+      m_root = upIndex;
+    } else {
+      auto &children{m_nodes[up.parent].children};
+      children[children[0] == node ? 0 : 1] = upIndex;
+    }
+
+    auto const [tallIndex, shortIndex]{f.height > g.height
+                                           ? std::pair{indexF, indexG}
+                                           : std::pair{indexG, indexF}};
+    auto &tall{m_nodes[tallIndex]};
+    auto &shorter{m_nodes[shortIndex]};
+    up.children[1] = tallIndex;
+    a.children.at(side) = shortIndex;
+    shorter.parent = node;
+    a.bounds = merge(other.bounds, shorter.bounds);
+    up.bounds = merge(a.bounds, tall.bounds);
+    a.height = 1 + std::max(other.height, shorter.height);
+    up.height = 1 + std::max(a.height, tall.height);
+  }};
+
+  if (balanceFactor > 1) {
+    rotate(c, indexC, 1);
+    return indexC;
+  }
+  if (balanceFactor < -1) {
+    rotate(b, indexB, 0);
+    return indexB;
+  }
+  return node;
+}
+
+// Appends the user values of all leaves of a subtree, using the top of the
+// traversal stack of cull
+void abcg::BVH::collectLeaves(ProxyID node, std::vector<std::uint32_t> &visible,
+                              std::pmr::vector<ProxyID> &stack) const {
+  auto const base{stack.size()};
+  stack.push_back(node);
+  while (stack.size() > base) {
+    auto const &current{m_nodes[stack.back()]};
+    stack.pop_back();
+    if (current.isLeaf()) {
+      visible.push_back(current.userData);
+    } else {
+      stack.push_back(current.children[0]);
+      stack.push_back(current.children[1]);
+    }
+  }
+}
@@ -0,0 +1,236 @@
+/**
+ * @file abcgBVH.hpp
+ * @brief Header file of abcg::BVH.
+ *
+ * Declaration of abcg::BVH and related classes.
+ *
+ * This file is part of ABCg (https://github.com/hbatagelo/abcg).
+ *
+ * @copyright (c) 2021--2022 Harlen Batagelo. All rights reserved.
+ * This project is released under the MIT License.
+ */
+
+#ifndef ABCG_BVH_HPP_
+#define ABCG_BVH_HPP_
+
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <memory_resource>
+#include <vector>
+
+#include "abcgExternal.hpp"
+#include "abcgFrameStatistics.hpp"
+
+namespace abcg {
+struct AABB;
+class Frustum;
+class BVH;
+} // namespace abcg
+
+/**
+ * @brief Axis-aligned bounding box.
+ */
+struct abcg::AABB {
+  /** @brief Minimum corner. */
+  glm::vec3 min{};
+  /** @brief Maximum corner. */
+  glm::vec3 max{};
+
+  [[nodiscard]] AABB transformed(glm::mat4 const &matrix) const noexcept;
+
+  /**
+   * @brief Returns the smallest box that contains two boxes.
+   *
+   * @param lhs First box.
+   * @param rhs Second box.
+   *
+   * @return Union of the boxes.
+   */
+  [[nodiscard]] friend AABB merge(AABB const &lhs, AABB const &rhs) noexcept {
+    return {.min = glm::min(lhs.min, rhs.min),
+            .max = glm::max(lhs.max, rhs.max)};
+  }
+
+  /**
+   * @brief Returns whether this box contains another box.
+   *
+   * @param other Box to be tested.
+   *
+   * @return `true` if @p other is inside this box or on its boundary.
+   */
+  [[nodiscard]] bool contains(AABB const &other) const noexcept {
+    return glm::all(glm::lessThanEqual(min, other.min)) &&
+           glm::all(glm::lessThanEqual(other.max, max));
+  }
+
+  /**
+   * @brief Returns whether this box overlaps another box.
+   *
+   * @param other Box to be tested.
+   *
+   * @return `true` if the boxes intersect.
+   */
+  [[nodiscard]] bool overlaps(AABB const &other) const noexcept {
+    return glm::all(glm::lessThanEqual(min, other.max)) &&
+           glm::all(glm::lessThanEqual(other.min, max));
+  }
+
+  /**
+   * @brief Returns the surface area of the box.
+   *
+   * @return Surface area, used as the cost of a node of the hierarchy.
+   */
+  [[nodiscard]] float area() const noexcept {
+    auto const extent{max - min};
+    return 2.0f * (extent.x * extent.y + extent.y * extent.z +
+                   extent.z * extent.x);
+  }
+
+  /**
+   * @brief Equality operator.
+   */
+  friend bool operator==(AABB const &, AABB const &) = default;
+};
+
+/**
+ * @brief View frustum used for visibility culling.
+ *
+ * The six planes of the frustum are extracted from a view-projection matrix
+ * and stored in structure-of-arrays layout so that a box can be tested
+ * against all planes at once with SIMD instructions.
+ */
+class abcg::Frustum {
+public:
+  /**
+   * @brief Result of a frustum-box test.
+   */
+  enum class Intersection {
+    /** @brief The box is entirely outside the frustum. */
+    Outside,
+    /** @brief The box crosses at least one plane of the frustum. */
+    Intersecting,
+    /** @brief The box is entirely inside the frustum. */
+    Inside
+  };
+
+  Frustum() = default;
+  explicit Frustum(glm::mat4 const &viewProjMatrix) noexcept;
+
+  [[nodiscard]] Intersection test(AABB const &box) const noexcept;
+
+  /**
+   * @brief Returns a plane of the frustum.
+   *
+   * @param index Plane index, in the order left, right, bottom, top, near and
+   * far.
+   *
+   * @return Normalized plane equation (normal in xyz, distance in w). Points
+   * inside the frustum are in front of the plane.
+   */
+  [[nodiscard]] glm::vec4 getPlane(std::size_t index) const {
+    return {m_normalX.at(index), m_normalY.at(index), m_normalZ.at(index),
+            m_distance.at(index)};
+  }
+
+  /** @brief Number of planes of a frustum. */
+  static constexpr std::size_t planeCount{6};
+
+private:
+  // Six planes padded to eight lanes. The padding planes always pass.
+  static constexpr std::size_t m_lanes{8};
+  alignas(16) std::array<float, m_lanes> m_normalX{};
+  alignas(16) std::array<float, m_lanes> m_normalY{};
+  alignas(16) std::array<float, m_lanes> m_normalZ{};
+  alignas(16) std::array<float, m_lanes> m_distance{};
+};
+
+/**
+ * @brief Dynamic bounding volume hierarchy of object bounds.
+ *
+ * This is a binary tree of axis-aligned bounding boxes that supports
+ * incremental insertion and removal of objects, and refitting when the bounds
+ * of an object change. Insertion chooses the sibling that minimizes the
+ * increase of surface area of the tree, and tree rotations keep it balanced.
+ *
+ * Each object is identified by a proxy returned by abcg::BVH::insert and
+ * carries a user value (e.g., the index of the object in the application's
+ * array of objects). abcg::BVH::cull returns the user values of the objects
+ * whose bounds intersect a frustum, skipping whole subtrees that are outside
+ * it:
+ * @code
+ * m_visible.clear();
+ * auto const statistics{m_bvh.cull(abcg::Frustum{m_projMatrix * m_viewMatrix},
+ *                                  m_visible)};
+ * recordCullingStatistics(statistics);
+ * for (auto const object : m_visible) {
+ *   m_objects.at(object).paint();
+ * }
+ * @endcode
+ */
+class abcg::BVH {
+public:
+  /** @brief Identifier of an object in the hierarchy. */
+  using ProxyID = std::uint32_t;
+  /** @brief Invalid proxy. */
+  static constexpr ProxyID nullProxy{std::numeric_limits<ProxyID>::max()};
+
+  [[nodiscard]] ProxyID insert(AABB const &bounds, std::uint32_t userData);
+  void remove(ProxyID proxy);
+  void update(ProxyID proxy, AABB const &bounds);
+  void clear() noexcept;
+
+  [[nodiscard]] AABB const &getBounds(ProxyID proxy) const;
+  [[nodiscard]] std::uint32_t getUserData(ProxyID proxy) const;
+
+  /**
+   * @brief Returns the number of objects in the hierarchy.
+   *
+   * @return Number of leaves.
+   */
+  [[nodiscard]] std::size_t size() const noexcept { return m_leafCount; }
+
+  /**
+   * @brief Returns the height of the tree.
+   *
+   * @return Height of the root node, or zero if the tree is empty.
+   */
+  [[nodiscard]] std::int32_t getHeight() const noexcept {
+    return m_root == nullProxy ? 0 : m_nodes[m_root].height;
+  }
+
+  CullingStatistics cull(Frustum const &frustum,
+                         std::vector<std::uint32_t> &visible,
+                         std::pmr::memory_resource *scratch =
+                             std::pmr::get_default_resource()) const;
+
+private:
+  struct Node {
+    AABB bounds{};
+    ProxyID parent{nullProxy};
+    std::array<ProxyID, 2> children{nullProxy, nullProxy};
+    std::uint32_t userData{};
+    // Leaves have height 0. Free nodes have height -1.
+    std::int32_t height{-1};
+
+    [[nodiscard]] bool isLeaf() const noexcept {
+      return children[0] == nullProxy;
+    }
+  };
+
+  [[nodiscard]] ProxyID allocateNode();
+  void freeNode(ProxyID node);
+  void insertLeaf(ProxyID leaf);
+  void removeLeaf(ProxyID leaf);
+  void refit(ProxyID node);
+  [[nodiscard]] ProxyID balance(ProxyID node);
+  void collectLeaves(ProxyID node, std::vector<std::uint32_t> &visible,
+                     std::pmr::vector<ProxyID> &stack) const;
+
+  std::vector<Node> m_nodes;
+  ProxyID m_root{nullProxy};
+  ProxyID m_freeList{nullProxy};
+  std::size_t m_leafCount{};
+};
+
+#endif
@@ -0,0 +1,125 @@
+/**
+ * @file abcgFrameArena.cpp
+ * @brief Definition of abcg::FrameArena members.
+ *
+ * This file is part of ABCg (https://github.com/hbatagelo/abcg).
+ *
+ * @copyright (c) 2021--2022 Harlen Batagelo. All rights reserved.
+ * This project is released under the MIT License.
+ */
+
+#include "abcgFrameArena.hpp"
+
+#include <algorithm>
+#include <memory>
+#include <utility>
+
+namespace {
+
+// Alignment of the blocks
+constexpr std::size_t blockAlignment{alignof(std::max_align_t)};
+
+} // namespace
+
+/**
+ * @brief Constructs an arena.
+ *
+ * @param capacity Size of the first block, in bytes. It is allocated on the
+ * first allocation.
+ * @param upstream Resource from which the blocks are allocated.
+ */
+abcg::FrameArena::FrameArena(std::size_t capacity,
+                             std::pmr::memory_resource *upstream)
+    : m_upstream{upstream}, m_capacity{capacity} {}
+
+abcg::FrameArena::FrameArena(FrameArena &&other) noexcept
+    : m_upstream{other.m_upstream}, m_blocks{std::move(other.m_blocks)},
+      m_offset{std::exchange(other.m_offset, 0)},
+      m_capacity{std::exchange(other.m_capacity, 0)},
+      m_usedBytes{std::exchange(other.m_usedBytes, 0)},
+      m_peakBytes{std::exchange(other.m_peakBytes, 0)} {
+  other.m_blocks.clear();
+}
+
+abcg::FrameArena &abcg::FrameArena::operator=(FrameArena &&other) noexcept {
+  if (this != &other) {
+    releaseBlocks();
+    m_upstream = other.m_upstream;
+    m_blocks = std::move(other.m_blocks);
+    other.m_blocks.clear();
+    m_offset = std::exchange(other.m_offset, 0);
+    m_capacity = std::exchange(other.m_capacity, 0);
+    m_usedBytes = std::exchange(other.m_usedBytes, 0);
+    m_peakBytes = std::exchange(other.m_peakBytes, 0);
+  }
+  return *this;
+}
+
+abcg::FrameArena::~FrameArena() { releaseBlocks(); }
+
+/**
+ * @brief Releases all memory allocated from the arena.
+ *
+ * If more than one block was used, they are replaced by a single block with
+ * their total size.
+ */
+void abcg::FrameArena::reset() {
+  if (m_blocks.size() > 1) {
+    releaseBlocks();
+    addBlock(m_capacity);
+  }
+  m_offset = 0;
+  m_usedBytes = 0;
+}
+
+void *abcg::FrameArena::do_allocate(std::size_t bytes, std::size_t alignment) {
+  if (m_blocks.empty()) {
+    addBlock(std::max(m_capacity, bytes + alignment));
+  }
+
+  while (true) {
+    auto const &block{m_blocks.back()};
+    void *pointer{block.data + m_offset};
+    auto space{block.size - m_offset};
+    if (std::align(alignment, bytes, pointer, space) != nullptr) {
+      auto const end{block.size - space + bytes};
+      m_usedBytes += end - m_offset;
+      m_peakBytes = std::max(m_peakBytes, m_usedBytes);
+      m_offset = end;
+      return pointer;
+    }
+
+    // The rest of the full block is wasted until the next reset
+    m_usedBytes += block.size - m_offset;
+    addBlock(std::max(block.size * 2, bytes + alignment));
+    m_offset = 0;
+  }
+}
+
+void abcg::FrameArena::do_deallocate([[maybe_unused]] void *pointer,
+                                     [[maybe_unused]] std::size_t bytes,
+                                     [[maybe_unused]] std::size_t alignment) {
+  // Memory is released by reset
+}
+
+bool abcg::FrameArena::do_is_equal(
+    std::pmr::memory_resource const &other) const noexcept {
+  return this == &other;
+}
+
+void abcg::FrameArena::addBlock(std::size_t size) {
+  auto *data{static_cast<std::byte *>(m_upstream->allocate(size,
+                                                           blockAlignment))};
+  if (m_blocks.empty()) {
+    m_capacity = 0;
+  }
+  m_blocks.push_back({.data = data, .size = size});
+  m_capacity += size;
+}
+
+void abcg::FrameArena::releaseBlocks() {
+  for (auto const &block : m_blocks) {
+    m_upstream->deallocate(block.data, block.size, blockAlignment);
+  }
+  m_blocks.clear();
+}
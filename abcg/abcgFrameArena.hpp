@@ -0,0 +1,139 @@
+/**
+ * @file abcgFrameArena.hpp
+ * @brief Header file of abcg::FrameArena.
+ *
+ * Declaration of the per-frame linear allocator.
+ *
+ * This file is part of ABCg (https://github.com/hbatagelo/abcg).
+ *
+ * @copyright (c) 2021--2022 Harlen Batagelo. All rights reserved.
+ * This project is released under the MIT License.
+ */
+
+#ifndef ABCG_FRAME_ARENA_HPP_
+#define ABCG_FRAME_ARENA_HPP_
+
+#include <cstddef>
+#include <iterator>
+#include <memory_resource>
+#include <string>
+#include <vector>
+
+#include <fmt/format.h>
+
+namespace abcg {
+class FrameArena;
+} // namespace abcg
+
+/**
+ * @brief Linear allocator for transient data of a frame.
+ *
+ * Allocations bump a pointer into a block of memory, and deallocations do
+ * nothing. All memory is released at once by abcg::FrameArena::reset, which
+ * abcg::Window calls at the start of each frame, before
+ * abcg::Window::paint. The arena is a `std::pmr::memory_resource`, so it can
+ * be used with the polymorphic allocator containers:
+ * @code
+ * void Window::onPaint() {
+ *   std::pmr::vector<glm::mat4> transforms{&getFrameArena()};
+ *   transforms.reserve(m_objects.size());
+ *   // ...
+ * }
+ * @endcode
+ *
+ * Memory allocated from the arena must not be used after the frame in which
+ * it was allocated. When a block is full, another one is allocated from the
+ * upstream resource. On the next reset, the blocks are merged into a single
+ * block that fits the whole frame, so that frames of similar sizes do not
+ * allocate from the upstream resource.
+ *
+ * The arena is not thread-safe.
+ */
+class abcg::FrameArena : public std::pmr::memory_resource {
+public:
+  /** @brief Default size of the first block, in bytes. */
+  static constexpr std::size_t defaultCapacity{std::size_t{1} << 20U};
+
+  explicit FrameArena(
+      std::size_t capacity = defaultCapacity,
+      std::pmr::memory_resource *upstream = std::pmr::new_delete_resource());
+  FrameArena(FrameArena const &) = delete;
+  FrameArena(FrameArena &&other) noexcept;
+  FrameArena &operator=(FrameArena const &) = delete;
+  FrameArena &operator=(FrameArena &&other) noexcept;
+  ~FrameArena() override;
+
+  void reset();
+
+  /**
+   * @brief Formats a string allocated from the arena.
+   *
+   * @param format Format string of the {fmt} library.
+   * @param args Arguments to be formatted.
+   *
+   * @return Formatted string.
+   */
+  template <typename... T>
+  [[nodiscard]] std::pmr::string format(fmt::format_string<T...> format,
+                                        T &&...args) {
+    // Short strings are formatted on the stack, then copied once to the
+    // arena, so that no reallocated buffers are left in it
+    fmt::memory_buffer buffer;
+    fmt::format_to(std::back_inserter(buffer), format,
+                   std::forward<T>(args)...);
+    return {buffer.data(), buffer.size(), this};
+  }
+
+  /**
+   * @brief Returns the number of bytes allocated since the last reset.
+   *
+   * @return Number of bytes, including alignment padding.
+   */
+  [[nodiscard]] std::size_t getUsedBytes() const noexcept {
+    return m_usedBytes;
+  }
+
+  /**
+   * @brief Returns the largest number of bytes allocated in a frame.
+   *
+   * @return Number of bytes, including alignment padding.
+   */
+  [[nodiscard]] std::size_t getPeakBytes() const noexcept {
+    return m_peakBytes;
+  }
+
+  /**
+   * @brief Returns the total size of the blocks.
+   *
+   * @return Number of bytes.
+   */
+  [[nodiscard]] std::size_t getCapacity() const noexcept {
+    return m_capacity;
+  }
+
+private:
+  struct Block {
+    std::byte *data{};
+    std::size_t size{};
+  };
+
+  void *do_allocate(std::size_t bytes, std::size_t alignment) override;
+  void do_deallocate(void *pointer, std::size_t bytes,
+                     std::size_t alignment) override;
+  [[nodiscard]] bool
+  do_is_equal(std::pmr::memory_resource const &other) const noexcept override;
+
+  void addBlock(std::size_t size);
+  void releaseBlocks();
+
+  std::pmr::memory_resource *m_upstream{};
+  std::vector<Block> m_blocks;
+  // Offset of the first free byte of the last block, which is being filled
+  std::size_t m_offset{};
+
+  std::size_t m_capacity{};
+  std::size_t m_usedBytes{};
+  std::size_t m_peakBytes{};
+};
+
+#endif
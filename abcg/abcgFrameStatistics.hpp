@@ -0,0 +1,170 @@
+/**
+ * @file abcgFrameStatistics.hpp
+ * @brief Header file of abcg::FrameStatistics.
+ *
+ * Declaration of abcg::FrameStatistics and related structures.
+ *
+ * This file is part of ABCg (https://github.com/hbatagelo/abcg).
+ *
+ * @copyright (c) 2021--2022 Harlen Batagelo. All rights reserved.
+ * This project is released under the MIT License.
+ */
+
+#ifndef ABCG_FRAME_STATISTICS_HPP_
+#define ABCG_FRAME_STATISTICS_HPP_
+
+#include <cstddef>
+#include <cstdint>
+
+namespace abcg {
+struct AllocationStatistics;
+struct CullingStatistics;
+struct GPUTimeStatistics;
+struct FrameStatistics;
+struct FrameTimeSample;
+struct FrameTimePercentiles;
+struct FrameTimeSummary;
+} // namespace abcg
+
+/**
+ * @brief Number and size of heap allocations.
+ *
+ * @sa abcg::AllocationTracker.
+ */
+struct abcg::AllocationStatistics {
+  /** @brief Number of allocations. */
+  std::uint64_t count{};
+  /** @brief Number of bytes requested by the allocations. */
+  std::uint64_t bytes{};
+
+  /**
+   * @brief Returns the allocations made since an earlier total.
+   *
+   * @param earlier Total taken before this one.
+   *
+   * @return Difference between both totals.
+   */
+  [[nodiscard]] AllocationStatistics
+  operator-(AllocationStatistics const &earlier) const noexcept {
+    return {.count = count - earlier.count, .bytes = bytes - earlier.bytes};
+  }
+};
+
+/**
+ * @brief Result counters of a visibility culling pass.
+ *
+ * @sa abcg::BVH::cull.
+ */
+struct abcg::CullingStatistics {
+  /** @brief Number of objects in the visible set. */
+  std::size_t visible{};
+  /** @brief Number of objects rejected by the culling test. */
+  std::size_t culled{};
+  /** @brief Number of bounding volumes tested. */
+  std::size_t nodesTested{};
+
+  /**
+   * @brief Accumulates the counters of another culling pass.
+   *
+   * @param other Counters to be added.
+   *
+   * @return Reference to this object.
+   */
+  CullingStatistics &operator+=(CullingStatistics const &other) noexcept {
+    visible += other.visible;
+    culled += other.culled;
+    nodesTested += other.nodesTested;
+    return *this;
+  }
+};
+
+/**
+ * @brief GPU times of the passes of a frame.
+ *
+ * The times are measured with timer queries and read back a few frames later,
+ * so they lag behind the frame they are reported with.
+ */
+struct abcg::GPUTimeStatistics {
+  /** @brief Whether the GPU times are measured. */
+  bool available{};
+  /** @brief GPU time of the application's paint pass, in milliseconds. */
+  double paint{};
+  /** @brief GPU time of the Dear ImGui render pass, in milliseconds. */
+  double ui{};
+  /** @brief GPU time of the buffer swap or presentation, in milliseconds. */
+  double swap{};
+};
+
+/**
+ * @brief Statistics of a frame.
+ *
+ * @sa abcg::Window::getFrameStatistics.
+ * @sa abcg::Window::recordCullingStatistics.
+ */
+struct abcg::FrameStatistics {
+  /** @brief Counters of all culling passes of the frame. */
+  CullingStatistics culling{};
+  /** @brief GPU times of the passes of the frame. */
+  GPUTimeStatistics gpu{};
+  /** @brief Heap allocations of the frame, including event handling. Zero
+   * unless ABCg was built with `ENABLE_ALLOCATION_TRACKER`. */
+  AllocationStatistics allocations{};
+};
+
+/**
+ * @brief Raw timings of a frame.
+ *
+ * @sa abcg::FrameTimeHistory.
+ */
+struct abcg::FrameTimeSample {
+  /** @brief CPU time spent painting the frame, in milliseconds. */
+  double cpuTime{};
+  /** @brief Time since the previous frame started, in milliseconds. */
+  double frameInterval{};
+  /** @brief Sum of the GPU times of the frame, in milliseconds. */
+  double gpuTime{};
+  /** @brief Whether abcg::FrameTimeSample::gpuTime was measured. */
+  bool gpuAvailable{};
+};
+
+/**
+ * @brief Distribution of a frame timing, in milliseconds.
+ *
+ * Percentiles use the nearest-rank method.
+ */
+struct abcg::FrameTimePercentiles {
+  /** @brief Median. */
+  double p50{};
+  /** @brief 95th percentile. */
+  double p95{};
+  /** @brief 99th percentile. */
+  double p99{};
+  /** @brief Largest value. */
+  double max{};
+  /** @brief Mean of the largest 1% of the values ("1% low" when converted to
+   * frames per second). */
+  double onePercentLow{};
+};
+
+/**
+ * @brief Summary of the frames kept by an abcg::FrameTimeHistory.
+ */
+struct abcg::FrameTimeSummary {
+  /** @brief Number of frames the distributions are computed from. */
+  std::size_t sampleCount{};
+  /** @brief Number of frames recorded since the history was cleared. */
+  std::size_t frameCount{};
+  /** @brief Number of hitches since the history was cleared. */
+  std::size_t hitchCount{};
+  /** @brief Distribution of abcg::FrameTimeSample::cpuTime. */
+  FrameTimePercentiles cpuTime{};
+  /** @brief Distribution of abcg::FrameTimeSample::frameInterval. */
+  FrameTimePercentiles frameInterval{};
+  /** @brief Distribution of abcg::FrameTimeSample::gpuTime, over the frames
+   * whose GPU time was measured. */
+  FrameTimePercentiles gpuTime{};
+  /** @brief Whether any frame had its GPU time measured. */
+  bool gpuAvailable{};
+};
+
+#endif
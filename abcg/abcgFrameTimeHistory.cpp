@@ -0,0 +1,222 @@
+/**
+ * @file abcgFrameTimeHistory.cpp
+ * @brief Definition of abcg::FrameTimeHistory members.
+ *
+ * This file is part of ABCg (https://github.com/hbatagelo/abcg).
+ *
+ * @copyright (c) 2021--2022 Harlen Batagelo. All rights reserved.
+ * This project is released under the MIT License.
+ */
+
+#include "abcgFrameTimeHistory.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <numeric>
+#include <string_view>
+
+#include <cppitertools/itertools.hpp>
+#include <fmt/core.h>
+#include <gsl/gsl>
+
+#include "abcgException.hpp"
+
+namespace {
+
+// Weight of the last interval in the moving average used for detecting
+// hitches
+constexpr double averageWeight{1.0 / 16.0};
+
+// Computes the distribution of the values. The order of the values is changed
+abcg::FrameTimePercentiles computePercentiles(std::vector<double> &values) {
+  if (values.empty())
+    return {};
+
+  auto const count{values.size()};
+  // Nearest rank: the smallest value such that p% of the values are <= it
+  auto const percentile{[&values, count](double fraction) {
+    auto const rank{gsl::narrow_cast<std::size_t>(
+        std::ceil(fraction * gsl::narrow_cast<double>(count)))};
+    auto const nth{std::next(values.begin(),
+                             gsl::narrow<std::ptrdiff_t>(
+                                 std::clamp<std::size_t>(rank, 1, count) - 1))};
+    std::nth_element(values.begin(), nth, values.end());
+    return *nth;
+  }};
+
+  abcg::FrameTimePercentiles result{};
+  result.max = *std::ranges::max_element(values);
+
+  // Largest 1% of the values, at least one
+  auto const lowCount{std::max<std::size_t>(count / 100, 1)};
+  auto const lowBegin{
+      std::next(values.begin(), gsl::narrow<std::ptrdiff_t>(count - lowCount))};
+  std::nth_element(values.begin(), lowBegin, values.end());
+  result.onePercentLow = std::accumulate(lowBegin, values.end(), 0.0) /
+                         gsl::narrow_cast<double>(lowCount);
+
+  // Each selection only reorders the values around the selected rank
+  result.p99 = percentile(0.99);
+  result.p95 = percentile(0.95);
+  result.p50 = percentile(0.50);
+  return result;
+}
+
+void writePercentiles(std::ofstream &stream, std::string_view name,
+                      abcg::FrameTimePercentiles const &percentiles) {
+  stream << fmt::format(R"("{}":{{"p50":{:.4f},"p95":{:.4f},"p99":{:.4f},)"
+                        R"("max":{:.4f},"onePercentLow":{:.4f}}})",
+                        name, percentiles.p50, percentiles.p95,
+                        percentiles.p99, percentiles.max,
+                        percentiles.onePercentLow);
+}
+
+} // namespace
+
+/**
+ * @brief Constructs an empty history.
+ *
+ * @param capacity Maximum number of frames kept. Older frames are
+ * overwritten.
+ * @param hitchFactor Ratio between the interval of a frame and the moving
+ * average of the previous intervals above which the frame is a hitch.
+ */
+abcg::FrameTimeHistory::FrameTimeHistory(std::size_t capacity,
+                                         double hitchFactor)
+    : m_samples(std::max<std::size_t>(capacity, 1)),
+      m_hitchFactor{hitchFactor} {}
+
+/**
+ * @brief Records the timings of a frame.
+ *
+ * @param sample Timings of the frame.
+ */
+void abcg::FrameTimeHistory::record(FrameTimeSample const &sample) {
+  if (m_frameCount == 0) {
+    m_averageInterval = sample.frameInterval;
+  } else if (sample.frameInterval > m_hitchFactor * m_averageInterval) {
+    ++m_hitchCount;
+  }
+  m_averageInterval +=
+      (sample.frameInterval - m_averageInterval) * averageWeight;
+
+  m_samples.at(m_frameCount % m_samples.size()) = sample;
+  ++m_frameCount;
+}
+
+/**
+ * @brief Removes all frames and resets the frame and hitch counters.
+ */
+void abcg::FrameTimeHistory::clear() {
+  m_frameCount = 0;
+  m_hitchCount = 0;
+  m_averageInterval = 0.0;
+}
+
+/**
+ * @brief Returns the timings of a frame kept in the history.
+ *
+ * @param index Index of the frame, from 0 (oldest) to
+ * abcg::FrameTimeHistory::size - 1 (newest).
+ *
+ * @return Reference to the timings of the frame.
+ */
+abcg::FrameTimeSample const &
+abcg::FrameTimeHistory::getSample(std::size_t index) const {
+  Expects(index < size());
+  return m_samples.at((m_frameCount - size() + index) % m_samples.size());
+}
+
+/**
+ * @brief Computes the distributions of the timings of the frames kept.
+ *
+ * This takes linear time in the number of frames kept.
+ *
+ * @return Percentiles of the CPU times, frame intervals and GPU times.
+ */
+abcg::FrameTimeSummary abcg::FrameTimeHistory::getSummary() const {
+  FrameTimeSummary summary{.sampleCount = size(),
+                           .frameCount = m_frameCount,
+                           .hitchCount = m_hitchCount};
+
+  auto const collect{[this](auto const &member, bool gpuOnly) {
+    m_values.clear();
+    for (auto const index : iter::range(size())) {
+      auto const &sample{getSample(index)};
+      if (!gpuOnly || sample.gpuAvailable) {
+        m_values.push_back(sample.*member);
+      }
+    }
+    return computePercentiles(m_values);
+  }};
+
+  summary.cpuTime = collect(&FrameTimeSample::cpuTime, false);
+  summary.frameInterval = collect(&FrameTimeSample::frameInterval, false);
+  summary.gpuTime = collect(&FrameTimeSample::gpuTime, true);
+  summary.gpuAvailable = !m_values.empty();
+  return summary;
+}
+
+/**
+ * @brief Writes the timings of the frames kept to a CSV file.
+ *
+ * The file has a header and one line per frame with the columns `frame`,
+ * `cpu_ms`, `interval_ms` and `gpu_ms`. The GPU time is empty if it was not
+ * measured.
+ *
+ * @param path Path of the file. An existing file is overwritten.
+ *
+ * @throw abcg::RuntimeError if the file could not be created.
+ */
+void abcg::FrameTimeHistory::exportCSV(std::string const &path) const {
+  std::ofstream stream(path, std::ios::trunc);
+  if (!stream) {
+    throw abcg::RuntimeError(
+        fmt::format("Failed to create frame statistics {}", path));
+  }
+
+  stream << "frame,cpu_ms,interval_ms,gpu_ms\n";
+  auto const firstFrame{m_frameCount - size()};
+  for (auto const index : iter::range(size())) {
+    auto const &sample{getSample(index)};
+    stream << fmt::format("{},{:.4f},{:.4f},", firstFrame + index,
+                          sample.cpuTime, sample.frameInterval);
+    if (sample.gpuAvailable) {
+      stream << fmt::format("{:.4f}", sample.gpuTime);
+    }
+    stream << '\n';
+  }
+}
+
+/**
+ * @brief Writes the summary of the frames kept to a JSON file.
+ *
+ * @param path Path of the file. An existing file is overwritten.
+ *
+ * @throw abcg::RuntimeError if the file could not be created.
+ *
+ * @sa abcg::FrameTimeHistory::getSummary.
+ */
+void abcg::FrameTimeHistory::exportJSON(std::string const &path) const {
+  std::ofstream stream(path, std::ios::trunc);
+  if (!stream) {
+    throw abcg::RuntimeError(
+        fmt::format("Failed to create frame statistics {}", path));
+  }
+
+  auto const summary{getSummary()};
+  stream << fmt::format(R"({{"samples":{},"frames":{},"hitches":{},)",
+                        summary.sampleCount, summary.frameCount,
+                        summary.hitchCount);
+  writePercentiles(stream, "cpu", summary.cpuTime);
+  stream << ',';
+  writePercentiles(stream, "interval", summary.frameInterval);
+  stream << ',';
+  if (summary.gpuAvailable) {
+    writePercentiles(stream, "gpu", summary.gpuTime);
+  } else {
+    stream << R"("gpu":null)";
+  }
+  stream << "}\n";
+}
@@ -0,0 +1,90 @@
+/**
+ * @file abcgFrameTimeHistory.hpp
+ * @brief Header file of abcg::FrameTimeHistory.
+ *
+ * Declaration of abcg::FrameTimeHistory.
+ *
+ * This file is part of ABCg (https://github.com/hbatagelo/abcg).
+ *
+ * @copyright (c) 2021--2022 Harlen Batagelo. All rights reserved.
+ * This project is released under the MIT License.
+ */
+
+#ifndef ABCG_FRAME_TIME_HISTORY_HPP_
+#define ABCG_FRAME_TIME_HISTORY_HPP_
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "abcgFrameStatistics.hpp"
+
+namespace abcg {
+class FrameTimeHistory;
+} // namespace abcg
+
+/**
+ * @brief Ring buffer of the raw timings of the last frames.
+ *
+ * Every window keeps a history of its frames (see
+ * abcg::Window::getFrameTimeHistory). The distributions of the timings are
+ * computed on demand by abcg::FrameTimeHistory::getSummary.
+ *
+ * A frame is counted as a hitch if its interval is larger than the hitch
+ * factor times the moving average of the previous intervals.
+ */
+class abcg::FrameTimeHistory {
+public:
+  explicit FrameTimeHistory(std::size_t capacity = 2048,
+                            double hitchFactor = 2.0);
+
+  void record(FrameTimeSample const &sample);
+  void clear();
+
+  [[nodiscard]] FrameTimeSample const &getSample(std::size_t index) const;
+  [[nodiscard]] FrameTimeSummary getSummary() const;
+
+  void exportCSV(std::string const &path) const;
+  void exportJSON(std::string const &path) const;
+
+  /**
+   * @brief Returns the number of frames kept.
+   *
+   * @return Number of samples, up to the capacity of the history.
+   */
+  [[nodiscard]] std::size_t size() const noexcept {
+    return m_frameCount < m_samples.size() ? m_frameCount : m_samples.size();
+  }
+
+  /**
+   * @brief Returns the number of frames recorded since the history was
+   * cleared.
+   *
+   * @return Number of frames, including the ones no longer kept.
+   */
+  [[nodiscard]] std::size_t getFrameCount() const noexcept {
+    return m_frameCount;
+  }
+
+  /**
+   * @brief Returns the number of hitches since the history was cleared.
+   *
+   * @return Number of frames counted as hitches.
+   */
+  [[nodiscard]] std::size_t getHitchCount() const noexcept {
+    return m_hitchCount;
+  }
+
+private:
+  std::vector<FrameTimeSample> m_samples;
+  double m_hitchFactor{};
+
+  std::size_t m_frameCount{};
+  std::size_t m_hitchCount{};
+  double m_averageInterval{};
+
+  // Scratch values for computing percentiles
+  mutable std::vector<double> m_values;
+};
+
+#endif
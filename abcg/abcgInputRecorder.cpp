@@ -0,0 +1,222 @@
+/**
+ * @file abcgInputRecorder.cpp
+ * @brief Definition of abcg::InputRecorder members.
+ *
+ * This file is part of ABCg (https://github.com/hbatagelo/abcg).
+ *
+ * @copyright (c) 2021--2022 Harlen Batagelo. All rights reserved.
+ * This project is released under the MIT License.
+ */
+
+#include "abcgInputRecorder.hpp"
+
+#include <array>
+#include <chrono>
+
+#include "abcgException.hpp"
+
+namespace {
+
+constexpr std::array<char, 8> logMagic{'A', 'B', 'C', 'G', 'R', 'E', 'C', '1'};
+
+// Size of the part of the event union used by the event type, or zero if the
+// event is not recorded
+std::size_t eventSize(Uint32 type) noexcept {
+  switch (type) {
+  case SDL_KEYDOWN:
+  case SDL_KEYUP:
+    return sizeof(SDL_KeyboardEvent);
+  case SDL_TEXTEDITING:
+    return sizeof(SDL_TextEditingEvent);
+  case SDL_TEXTINPUT:
+    return sizeof(SDL_TextInputEvent);
+  case SDL_MOUSEMOTION:
+    return sizeof(SDL_MouseMotionEvent);
+  case SDL_MOUSEBUTTONDOWN:
+  case SDL_MOUSEBUTTONUP:
+    return sizeof(SDL_MouseButtonEvent);
+  case SDL_MOUSEWHEEL:
+    return sizeof(SDL_MouseWheelEvent);
+  default:
+    return 0;
+  }
+}
+
+template <typename T> void write(std::fstream &stream, T const &value) {
+  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+  stream.write(reinterpret_cast<char const *>(&value), sizeof(T));
+}
+
+template <typename T> bool read(std::fstream &stream, T &value) {
+  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+  return static_cast<bool>(
+      stream.read(reinterpret_cast<char *>(&value), sizeof(T)));
+}
+
+} // namespace
+
+/**
+ * @brief Constructs an abcg::InputRecorder in abcg::InputRecorderMode::Off
+ * mode, with a random seed taken from the clock.
+ */
+abcg::InputRecorder::InputRecorder()
+    : m_seed{gsl::narrow_cast<std::uint64_t>(
+          std::chrono::steady_clock::now().time_since_epoch().count())} {}
+
+/**
+ * @brief Starts writing the seed, the delta times and the events to a log.
+ *
+ * @param path Path of the log file. An existing file is overwritten.
+ *
+ * @throw abcg::RuntimeError if the file could not be created.
+ */
+void abcg::InputRecorder::startRecording(std::string const &path) {
+  stop();
+
+  m_stream.open(path, std::ios::out | std::ios::binary | std::ios::trunc);
+  if (!m_stream) {
+    throw abcg::RuntimeError(
+        fmt::format("Failed to create input recording {}", path));
+  }
+  m_stream.write(logMagic.data(), logMagic.size());
+  write(m_stream, m_seed);
+
+  m_mode = InputRecorderMode::Record;
+}
+
+/**
+ * @brief Starts reading the seed, the delta times and the events from a log.
+ *
+ * @param path Path of a log written by abcg::InputRecorder::startRecording.
+ *
+ * @throw abcg::RuntimeError if the file could not be read or is not a
+ * recording.
+ */
+void abcg::InputRecorder::startReplay(std::string const &path) {
+  stop();
+
+  m_stream.open(path, std::ios::in | std::ios::binary);
+  std::array<char, logMagic.size()> magic{};
+  if (!m_stream || !m_stream.read(magic.data(), magic.size()) ||
+      magic != logMagic || !read(m_stream, m_seed)) {
+    m_stream.close();
+    throw abcg::RuntimeError(
+        fmt::format("Failed to read input recording {}", path));
+  }
+
+  m_mode = InputRecorderMode::Replay;
+}
+
+/**
+ * @brief Closes the log and returns to abcg::InputRecorderMode::Off mode.
+ *
+ * Events recorded after the last frame are discarded.
+ */
+void abcg::InputRecorder::stop() {
+  if (m_mode == InputRecorderMode::Off)
+    return;
+
+  m_stream.close();
+  m_pendingEvents.clear();
+  m_deltaTime = 0.0;
+  m_clockTime = 0.0;
+  m_frameCount = 0;
+  m_mode = InputRecorderMode::Off;
+}
+
+/**
+ * @brief Whether an event is written to the log.
+ *
+ * @param event SDL event.
+ *
+ * @return `true` for keyboard, text input and mouse events; `false`
+ * otherwise.
+ */
+bool abcg::InputRecorder::isRecordable(SDL_Event const &event) noexcept {
+  return eventSize(event.type) != 0;
+}
+
+/**
+ * @brief Adds an event to the frame being recorded.
+ *
+ * Events that are not recordable, or that arrive when not recording, are
+ * ignored.
+ *
+ * @param event SDL event.
+ */
+void abcg::InputRecorder::recordEvent(SDL_Event const &event) {
+  if (m_mode == InputRecorderMode::Record && isRecordable(event)) {
+    m_pendingEvents.push_back(event);
+  }
+}
+
+/**
+ * @brief Writes the frame being recorded.
+ *
+ * @param deltaTime Delta time of the frame, in seconds.
+ */
+void abcg::InputRecorder::recordFrame(double deltaTime) {
+  if (m_mode != InputRecorderMode::Record)
+    return;
+
+  write(m_stream, deltaTime);
+  write(m_stream, gsl::narrow<std::uint32_t>(m_pendingEvents.size()));
+  for (auto const &event : m_pendingEvents) {
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+    m_stream.write(reinterpret_cast<char const *>(&event),
+                   gsl::narrow<std::streamsize>(eventSize(event.type)));
+  }
+  m_pendingEvents.clear();
+
+  m_deltaTime = deltaTime;
+  m_clockTime += deltaTime;
+  ++m_frameCount;
+}
+
+/**
+ * @brief Reads the next frame of the log.
+ *
+ * The delta time of the frame is returned by
+ * abcg::InputRecorder::getDeltaTime.
+ *
+ * @param events Vector that receives the events of the frame.
+ *
+ * @return `true` on success; `false` at the end of the log.
+ *
+ * @throw abcg::RuntimeError if the log contains an event that cannot be
+ * replayed.
+ */
+bool abcg::InputRecorder::replayFrame(std::vector<SDL_Event> &events) {
+  events.clear();
+  if (m_mode != InputRecorderMode::Replay)
+    return false;
+
+  auto deltaTime{0.0};
+  std::uint32_t eventCount{};
+  if (!read(m_stream, deltaTime) || !read(m_stream, eventCount))
+    return false;
+
+  events.resize(eventCount);
+  for (auto &event : events) {
+    if (!read(m_stream, event.type))
+      return false;
+    auto const size{eventSize(event.type)};
+    if (size == 0) {
+      throw abcg::RuntimeError("Invalid event in input recording");
+    }
+    // The type was already read
+    auto const offset{sizeof(event.type)};
+    // NOLINTBEGIN(cppcoreguidelines-pro-type-reinterpret-cast)
+    // NOLINTBEGIN(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+    if (!m_stream.read(reinterpret_cast<char *>(&event) + offset,
+                       gsl::narrow<std::streamsize>(size - offset)))
+      return false;
+    // NOLINTEND(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+    // NOLINTEND(cppcoreguidelines-pro-type-reinterpret-cast)
+  }
+
+  m_deltaTime = deltaTime;
+  m_clockTime += deltaTime;
+  ++m_frameCount;
+  return true;
+}
@@ -0,0 +1,130 @@
+/**
+ * @file abcgInputRecorder.hpp
+ * @brief Header file of abcg::InputRecorder.
+ *
+ * Declaration of abcg::InputRecorder and related enumerations.
+ *
+ * This file is part of ABCg (https://github.com/hbatagelo/abcg).
+ *
+ * @copyright (c) 2021--2022 Harlen Batagelo. All rights reserved.
+ * This project is released under the MIT License.
+ */
+
+#ifndef ABCG_INPUT_RECORDER_HPP_
+#define ABCG_INPUT_RECORDER_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "abcgExternal.hpp"
+
+namespace abcg {
+enum class InputRecorderMode;
+class InputRecorder;
+} // namespace abcg
+
+/**
+ * @brief Operating modes of abcg::InputRecorder.
+ */
+enum class abcg::InputRecorderMode {
+  /** @brief Live input and clock. */
+  Off,
+  /** @brief Live input and clock, written to a log file. */
+  Record,
+  /** @brief Input and clock read from a log file. */
+  Replay
+};
+
+/**
+ * @brief Records and replays the input of a window.
+ *
+ * A recording stores the random seed of the run, and for each frame the
+ * delta time and the keyboard, text and mouse events handled before the
+ * frame was painted. Replaying it feeds the same events to
+ * abcg::Window::handleEvent and the same delta times to
+ * abcg::Window::getDeltaTime and abcg::Window::getElapsedTime, so that an
+ * application that only depends on these and on abcg::Window::getRandomSeed
+ * runs identically, frame by frame. This is useful for comparing the
+ * performance of different builds on the same workload.
+ *
+ * Recording and replay are enabled from the command line:
+ * @code
+ * ./app --record run.abcgrec  # Play, then close the window
+ * ./app --replay run.abcgrec  # Closes when the recording ends
+ * @endcode
+ *
+ * During replay, live keyboard and mouse events are ignored, but the window
+ * can still be closed. Window events (e.g., resizing) are not recorded.
+ *
+ * The log is a binary file in the native byte order. Each event only takes
+ * the size of its SDL event structure.
+ *
+ * @remark Dear ImGui measures its own delta time, so time-dependent widget
+ * behavior (e.g., double clicks) may differ during replay.
+ */
+class abcg::InputRecorder {
+public:
+  InputRecorder();
+
+  void startRecording(std::string const &path);
+  void startReplay(std::string const &path);
+  void stop();
+
+  [[nodiscard]] static bool isRecordable(SDL_Event const &event) noexcept;
+
+  void recordEvent(SDL_Event const &event);
+  void recordFrame(double deltaTime);
+  [[nodiscard]] bool replayFrame(std::vector<SDL_Event> &events);
+
+  /**
+   * @brief Returns the current mode.
+   *
+   * @return Operating mode.
+   */
+  [[nodiscard]] InputRecorderMode getMode() const noexcept { return m_mode; }
+
+  /**
+   * @brief Returns the random seed of the run.
+   *
+   * @return Seed taken from the clock, or read from the log during replay.
+   */
+  [[nodiscard]] std::uint64_t getSeed() const noexcept { return m_seed; }
+
+  /**
+   * @brief Returns the delta time of the last replayed frame.
+   *
+   * @return Time in seconds.
+   */
+  [[nodiscard]] double getDeltaTime() const noexcept { return m_deltaTime; }
+
+  /**
+   * @brief Returns the sum of the delta times recorded or replayed so far.
+   *
+   * @return Time in seconds.
+   */
+  [[nodiscard]] double getClockTime() const noexcept { return m_clockTime; }
+
+  /**
+   * @brief Returns the number of frames recorded or replayed so far.
+   *
+   * @return Number of frames.
+   */
+  [[nodiscard]] std::size_t getFrameCount() const noexcept {
+    return m_frameCount;
+  }
+
+private:
+  InputRecorderMode m_mode{InputRecorderMode::Off};
+  std::uint64_t m_seed{};
+  std::fstream m_stream;
+
+  std::vector<SDL_Event> m_pendingEvents;
+  double m_deltaTime{};
+  double m_clockTime{};
+  std::size_t m_frameCount{};
+};
+
+#endif
\ No newline at end of file
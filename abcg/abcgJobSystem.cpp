@@ -0,0 +1,361 @@
+/**
+ * @file abcgJobSystem.cpp
+ * @brief Definition of abcg::JobSystem members.
+ *
+ * This file is part of ABCg (https://github.com/hbatagelo/abcg).
+ *
+ * @copyright (c) 2021--2022 Harlen Batagelo. All rights reserved.
+ * This project is released under the MIT License.
+ */
+
+#include "abcgJobSystem.hpp"
+
+#include <algorithm>
+#include <utility>
+
+#include <cppitertools/itertools.hpp>
+
+#include "abcgProfiler.hpp"
+
+namespace {
+
+// Queue of the calling thread: 0 for threads that are not workers
+thread_local std::size_t threadQueue{};
+
+// Number of chunks per thread of a parallel loop with automatic grain size
+constexpr std::size_t chunksPerThread{4};
+
+} // namespace
+
+/**
+ * @brief Returns the job system of the application.
+ *
+ * @return Reference to the job system.
+ */
+abcg::JobSystem &abcg::JobSystem::getInstance() {
+  static JobSystem jobSystem;
+  return jobSystem;
+}
+
+// Queued jobs are dropped, since they may refer to destroyed objects
+abcg::JobSystem::~JobSystem() { stopWorkers(); }
+
+/**
+ * @brief Returns the default number of worker threads.
+ *
+ * @return Number of hardware threads minus one (for the main thread), or zero
+ * if threads are not supported.
+ */
+std::size_t abcg::JobSystem::getDefaultWorkerCount() noexcept {
+#if defined(__EMSCRIPTEN__) && !defined(__EMSCRIPTEN_PTHREADS__)
+  return 0;
+#else
+  auto const hardwareThreads{std::thread::hardware_concurrency()};
+  return hardwareThreads > 1 ? hardwareThreads - 1 : 0;
+#endif
+}
+
+/**
+ * @brief Starts the worker threads.
+ *
+ * The calling thread becomes the main thread. Jobs already queued are kept.
+ *
+ * @param workerCount Number of worker threads. With zero workers, jobs run
+ * when they are submitted.
+ */
+void abcg::JobSystem::start(std::size_t workerCount) {
+  stop();
+
+  m_mainThread = std::this_thread::get_id();
+  threadQueue = 0;
+  m_queues.resize(workerCount + 1);
+  for (auto &queue : m_queues) {
+    if (!queue)
+      queue = std::make_unique<Queue>();
+  }
+  for (auto const worker : iter::range(workerCount)) {
+    m_workers.emplace_back([this, worker](std::stop_token const &token) {
+      workerLoop(token, worker + 1);
+    });
+  }
+}
+
+/**
+ * @brief Stops the worker threads.
+ *
+ * Queued jobs, including those of the main thread, are run before returning.
+ */
+void abcg::JobSystem::stop() {
+  // Help the workers with the queued jobs
+  while (m_queued.load(std::memory_order_acquire) > 0) {
+    if (auto job{findJob(threadQueue)}) {
+      run(*job);
+    } else {
+      std::this_thread::yield();
+    }
+  }
+
+  stopWorkers();
+
+  // Jobs queued by the last jobs of the workers
+  while (auto job{findJob(threadQueue)}) {
+    run(*job);
+  }
+  runMainThreadJobs();
+}
+
+/**
+ * @brief Submits a job to the worker threads.
+ *
+ * @param function Function run by the job.
+ * @param counter Counter of the group of the job, or nullptr.
+ * @param dependency Counter that must reach zero before the job starts, or
+ * nullptr.
+ */
+void abcg::JobSystem::submit(Function function, JobCounter *counter,
+                             JobCounter *dependency) {
+  enqueue({.function = std::move(function), .counter = counter}, dependency);
+}
+
+/**
+ * @brief Submits a job to be run on the main thread.
+ *
+ * Use this for functions that must run on the thread of the graphics
+ * context, such as uploading data decoded by other jobs.
+ *
+ * @param function Function run by the job.
+ * @param counter Counter of the group of the job, or nullptr.
+ * @param dependency Counter that must reach zero before the job starts, or
+ * nullptr.
+ */
+void abcg::JobSystem::submitOnMainThread(Function function,
+                                         JobCounter *counter,
+                                         JobCounter *dependency) {
+  enqueue({.function = std::move(function),
+           .counter = counter,
+           .mainThread = true},
+          dependency);
+}
+
+/**
+ * @brief Submits a parallel loop over a range of indices.
+ *
+ * The range [0, count) is split into chunks of `grainSize` indices, and each
+ * chunk is run by a job. The function is not copied, so it must outlive the
+ * jobs, e.g., until abcg::JobSystem::wait returns for the counter.
+ *
+ * @param count Number of indices.
+ * @param grainSize Number of indices per job, or zero to split the range into
+ * a few chunks per thread.
+ * @param function Function called with the range of indices [begin, end) of
+ * each chunk.
+ * @param counter Counter of the group of the jobs.
+ * @param dependency Counter that must reach zero before the jobs start, or
+ * nullptr.
+ */
+void abcg::JobSystem::parallelFor(std::size_t count, std::size_t grainSize,
+                                  RangeFunction const &function,
+                                  JobCounter &counter,
+                                  JobCounter *dependency) {
+  if (grainSize == 0) {
+    auto const chunks{(getWorkerCount() + 1) * chunksPerThread};
+    grainSize = (count + chunks - 1) / chunks;
+  }
+  grainSize = std::max<std::size_t>(grainSize, 1);
+
+  for (std::size_t begin{}; begin < count; begin += grainSize) {
+    enqueue({.range = &function,
+             .begin = begin,
+             .end = std::min(begin + grainSize, count),
+             .counter = &counter},
+            dependency);
+  }
+}
+
+/**
+ * @brief Runs a parallel loop over a range of indices and waits for it.
+ *
+ * The calling thread also runs chunks of the loop.
+ *
+ * @param count Number of indices.
+ * @param grainSize Number of indices per job, or zero to split the range into
+ * a few chunks per thread.
+ * @param function Function called with the range of indices [begin, end) of
+ * each chunk.
+ */
+void abcg::JobSystem::parallelFor(std::size_t count, std::size_t grainSize,
+                                  RangeFunction const &function) {
+  JobCounter counter;
+  parallelFor(count, grainSize, function, counter);
+  wait(counter);
+}
+
+/**
+ * @brief Waits until all jobs of a counter have finished.
+ *
+ * The calling thread runs other jobs while it waits, including the jobs of
+ * the main thread if it is the main thread.
+ *
+ * @param counter Counter to wait for.
+ */
+void abcg::JobSystem::wait(JobCounter &counter) {
+  while (!counter.isDone()) {
+    if (isMainThread()) {
+      runMainThreadJobs();
+    }
+    if (auto job{findJob(threadQueue)}) {
+      run(*job);
+    } else {
+      std::this_thread::yield();
+    }
+  }
+  // The thread that finished the last job may still hold the mutex
+  std::scoped_lock const lock{counter.m_mutex};
+}
+
+/**
+ * @brief Runs the jobs submitted to the main thread whose dependencies are
+ * done.
+ *
+ * This is called by abcg::Application before painting each frame, and must
+ * only be called from the main thread.
+ */
+void abcg::JobSystem::runMainThreadJobs() {
+  std::vector<Job> jobs;
+  {
+    std::scoped_lock const lock{m_mainThreadMutex};
+    if (m_mainThreadJobs.empty())
+      return;
+    jobs.swap(m_mainThreadJobs);
+  }
+  for (auto &job : jobs) {
+    run(job);
+  }
+}
+
+/**
+ * @brief Whether the calling thread is the main thread.
+ *
+ * @return `true` if the calling thread started the job system.
+ */
+bool abcg::JobSystem::isMainThread() const noexcept {
+  return std::this_thread::get_id() == m_mainThread;
+}
+
+void abcg::JobSystem::stopWorkers() {
+  for (auto &worker : m_workers) {
+    worker.request_stop();
+  }
+  // Wake up the idle workers
+  m_queued.fetch_add(1, std::memory_order_release);
+  m_queued.notify_all();
+  m_workers.clear();
+  m_queued.fetch_sub(1, std::memory_order_relaxed);
+}
+
+void abcg::JobSystem::enqueue(Job job, JobCounter *dependency) {
+  if (job.counter != nullptr) {
+    job.counter->m_pending.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  if (dependency != nullptr) {
+    std::scoped_lock const lock{dependency->m_mutex};
+    if (dependency->m_pending.load(std::memory_order_acquire) > 0) {
+      dependency->m_waiting.push_back(std::move(job));
+      return;
+    }
+  }
+  schedule(std::move(job));
+}
+
+void abcg::JobSystem::schedule(Job job) {
+  if (job.mainThread) {
+    std::scoped_lock const lock{m_mainThreadMutex};
+    m_mainThreadJobs.push_back(std::move(job));
+    return;
+  }
+
+  if (m_workers.empty()) {
+    run(job);
+    return;
+  }
+
+  {
+    auto &queue{*m_queues.at(threadQueue)};
+    std::scoped_lock const lock{queue.mutex};
+    queue.jobs.push_back(std::move(job));
+  }
+  m_queued.fetch_add(1, std::memory_order_release);
+  m_queued.notify_one();
+}
+
+void abcg::JobSystem::run(Job &job) {
+  {
+    ABCG_PROFILE_ZONE("JobSystem::run");
+    if (job.range != nullptr) {
+      (*job.range)(job.begin, job.end);
+    } else {
+      job.function();
+    }
+  }
+  finish(job.counter);
+}
+
+// Decrements the counter of a finished job and schedules the jobs that
+// depend on it if it reached zero
+void abcg::JobSystem::finish(JobCounter *counter) {
+  if (counter == nullptr)
+    return;
+
+  std::vector<Job> ready;
+  {
+    std::scoped_lock const lock{counter->m_mutex};
+    if (counter->m_pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      ready.swap(counter->m_waiting);
+    }
+  }
+  for (auto &job : ready) {
+    schedule(std::move(job));
+  }
+}
+
+// Takes the newest job of a queue, or steals the oldest job of another one
+std::optional<abcg::Job> abcg::JobSystem::findJob(std::size_t queue) {
+  if (m_queues.empty())
+    return std::nullopt;
+
+  for (auto const offset : iter::range(m_queues.size())) {
+    auto &victim{*m_queues[(queue + offset) % m_queues.size()]};
+    std::scoped_lock const lock{victim.mutex};
+    if (victim.jobs.empty())
+      continue;
+
+    Job job;
+    if (offset == 0) {
+      job = std::move(victim.jobs.back());
+      victim.jobs.pop_back();
+    } else {
+      job = std::move(victim.jobs.front());
+      victim.jobs.pop_front();
+    }
+    m_queued.fetch_sub(1, std::memory_order_relaxed);
+    return job;
+  }
+  return std::nullopt;
+}
+
+void abcg::JobSystem::workerLoop(std::stop_token const &token,
+                                 std::size_t queue) {
+  threadQueue = queue;
+  while (!token.stop_requested()) {
+    if (auto job{findJob(queue)}) {
+      run(*job);
+    } else if (m_queued.load(std::memory_order_acquire) == 0) {
+      // Sleep until a job is queued or the job system is stopped
+      m_queued.wait(0, std::memory_order_acquire);
+    } else {
+      // A job is being taken by another thread
+      std::this_thread::yield();
+    }
+  }
+}
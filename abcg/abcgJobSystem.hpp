@@ -0,0 +1,199 @@
+/**
+ * @file abcgJobSystem.hpp
+ * @brief Header file of abcg::JobSystem and abcg::JobCounter.
+ *
+ * Declaration of the work-stealing job system.
+ *
+ * This file is part of ABCg (https://github.com/hbatagelo/abcg).
+ *
+ * @copyright (c) 2021--2022 Harlen Batagelo. All rights reserved.
+ * This project is released under the MIT License.
+ */
+
+#ifndef ABCG_JOB_SYSTEM_HPP_
+#define ABCG_JOB_SYSTEM_HPP_
+
+#include <atomic>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+namespace abcg {
+struct Job;
+class JobCounter;
+class JobSystem;
+} // namespace abcg
+
+/**
+ * @brief Job scheduled by abcg::JobSystem.
+ *
+ * Jobs are created by the functions of abcg::JobSystem.
+ */
+struct abcg::Job {
+  /** @brief Function run by the job, unless it is a range of a parallel
+   * loop. */
+  std::function<void()> function{};
+  /** @brief Function of the parallel loop, or nullptr. */
+  std::function<void(std::size_t, std::size_t)> const *range{};
+  /** @brief First index of the range. */
+  std::size_t begin{};
+  /** @brief One past the last index of the range. */
+  std::size_t end{};
+  /** @brief Counter decremented when the job finishes, or nullptr. */
+  JobCounter *counter{};
+  /** @brief Whether the job must run on the main thread. */
+  bool mainThread{};
+};
+
+/**
+ * @brief Number of unfinished jobs of a group.
+ *
+ * A counter is incremented when a job is submitted with it, and decremented
+ * when the job finishes. It can be waited on with abcg::JobSystem::wait, and
+ * used as the dependency of other jobs, which are only started when the
+ * counter reaches zero.
+ *
+ * A counter must outlive its jobs, and must not be destroyed before
+ * abcg::JobSystem::wait returns for it.
+ */
+class abcg::JobCounter {
+public:
+  JobCounter() = default;
+  JobCounter(JobCounter const &) = delete;
+  JobCounter(JobCounter &&) = delete;
+  JobCounter &operator=(JobCounter const &) = delete;
+  JobCounter &operator=(JobCounter &&) = delete;
+  ~JobCounter() = default;
+
+  /**
+   * @brief Whether all jobs submitted with the counter have finished.
+   *
+   * @return `true` if the counter is zero.
+   */
+  [[nodiscard]] bool isDone() const noexcept {
+    return m_pending.load(std::memory_order_acquire) == 0;
+  }
+
+private:
+  std::atomic<std::size_t> m_pending{};
+  // Jobs that depend on this counter. The mutex also guards the decrement
+  // of the last job
+  std::mutex m_mutex;
+  std::vector<Job> m_waiting;
+
+  friend JobSystem;
+};
+
+/**
+ * @brief Runs jobs on a fixed pool of worker threads.
+ *
+ * Each worker thread owns a queue of jobs. A thread takes the newest job of
+ * its own queue and, when it is empty, steals the oldest job of another
+ * queue, so that the work spreads across all cores without a central queue.
+ * Jobs submitted by threads other than the workers go to a shared queue.
+ * Threads waiting for a counter run jobs while they wait.
+ *
+ * The job system is started by abcg::Application::run before the window is
+ * created, and stopped before it is destroyed, so that pending jobs finish
+ * before abcg::Window::onDestroy. It has one worker per core besides the main
+ * thread (or the number given with `--jobs <count>`):
+ * @code
+ * void Window::onUpdate() {
+ *   auto &jobs{abcg::JobSystem::getInstance()};
+ *
+ *   // Blocking parallel loop over the particles
+ *   jobs.parallelFor(m_particles.size(), 1024,
+ *                    [&](std::size_t begin, std::size_t end) {
+ *                      updateParticles(begin, end, getDeltaTime());
+ *                    });
+ *
+ *   // Decode in the background, then upload on the main thread
+ *   jobs.submit([this] { m_image = decodeImage(m_path); }, &m_decoded);
+ *   jobs.submitOnMainThread([this] { uploadTexture(m_image); }, nullptr,
+ *                           &m_decoded);
+ * }
+ * @endcode
+ *
+ * Jobs submitted with abcg::JobSystem::submitOnMainThread, such as those
+ * calling OpenGL functions, are run by the main thread before each frame is
+ * painted, or while it waits for a counter.
+ *
+ * Jobs must not throw exceptions. Without worker threads (e.g., on
+ * WebAssembly), jobs run when they are submitted.
+ */
+class abcg::JobSystem {
+public:
+  /** @brief Function of a job. */
+  using Function = std::function<void()>;
+  /** @brief Function of a parallel loop, called with ranges of indices
+   * [begin, end). */
+  using RangeFunction = std::function<void(std::size_t, std::size_t)>;
+
+  JobSystem() = default;
+  JobSystem(JobSystem const &) = delete;
+  JobSystem(JobSystem &&) = delete;
+  JobSystem &operator=(JobSystem const &) = delete;
+  JobSystem &operator=(JobSystem &&) = delete;
+  ~JobSystem();
+
+  [[nodiscard]] static JobSystem &getInstance();
+  [[nodiscard]] static std::size_t getDefaultWorkerCount() noexcept;
+
+  void start(std::size_t workerCount = getDefaultWorkerCount());
+  void stop();
+
+  void submit(Function function, JobCounter *counter = nullptr,
+              JobCounter *dependency = nullptr);
+  void submitOnMainThread(Function function, JobCounter *counter = nullptr,
+                          JobCounter *dependency = nullptr);
+  void parallelFor(std::size_t count, std::size_t grainSize,
+                   RangeFunction const &function, JobCounter &counter,
+                   JobCounter *dependency = nullptr);
+  void parallelFor(std::size_t count, std::size_t grainSize,
+                   RangeFunction const &function);
+  void wait(JobCounter &counter);
+  void runMainThreadJobs();
+
+  [[nodiscard]] bool isMainThread() const noexcept;
+
+  /**
+   * @brief Returns the number of worker threads.
+   *
+   * @return Number of threads besides the main thread.
+   */
+  [[nodiscard]] std::size_t getWorkerCount() const noexcept {
+    return m_workers.size();
+  }
+
+private:
+  struct Queue {
+    std::mutex mutex;
+    std::deque<Job> jobs;
+  };
+
+  void stopWorkers();
+  void enqueue(Job job, JobCounter *dependency);
+  void schedule(Job job);
+  void run(Job &job);
+  void finish(JobCounter *counter);
+  [[nodiscard]] std::optional<Job> findJob(std::size_t queue);
+  void workerLoop(std::stop_token const &token, std::size_t queue);
+
+  std::thread::id m_mainThread{std::this_thread::get_id()};
+
+  // Queue 0 is shared by the threads that are not workers
+  std::vector<std::unique_ptr<Queue>> m_queues;
+  // Jobs in all queues. Idle workers wait for it to change
+  std::atomic<std::size_t> m_queued{};
+  std::vector<std::jthread> m_workers;
+
+  std::mutex m_mainThreadMutex;
+  std::vector<Job> m_mainThreadJobs;
+};
+
+#endif
@@ -0,0 +1,707 @@
+/**
+ * @file abcgMesh.cpp
+ * @brief Definition of abcg::Mesh members.
+ *
+ * This file is part of ABCg (https://github.com/hbatagelo/abcg).
+ *
+ * @copyright (c) 2021--2022 Harlen Batagelo. All rights reserved.
+ * This project is released under the MIT License.
+ */
+
+#include "abcgMesh.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <unordered_map>
+
+#if defined(WIN32)
+#if !defined(WIN32_LEAN_AND_MEAN)
+#define WIN32_LEAN_AND_MEAN
+#endif
+#if !defined(NOMINMAX)
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "abcgException.hpp"
+
+namespace {
+
+// Header of the binary cache file. The vertex data follows immediately after
+// the header, followed by the quantized vertex data (if any), the table of
+// levels of detail and the index data.
+struct CacheHeader {
+  std::array<char, 4> magic{'A', 'B', 'C', 'M'};
+  std::uint32_t version{3};
+  std::uint64_t sourceSize{};
+  std::int64_t sourceTime{};
+  std::uint32_t vertexCount{};
+  std::uint32_t indexCount{};
+  std::uint32_t indexType{};
+  std::uint32_t flags{};
+  glm::vec3 boundsMin{};
+  glm::vec3 boundsMax{};
+  glm::vec2 texCoordMin{};
+  glm::vec2 texCoordExtent{};
+  float acmrBefore{};
+  float acmrAfter{};
+  std::uint32_t lodCount{};
+  std::uint32_t requestedLODCount{};
+  float lodReduction{};
+  std::uint32_t reserved{};
+};
+
+// Bits of CacheHeader::flags. Options that change the content of the cache
+// must match the requested ones.
+enum CacheFlags : std::uint32_t {
+  Optimized = 1U << 0U,
+  Quantized = 1U << 1U,
+  GeneratedNormals = 1U << 2U,
+  ForcedUInt32Indices = 1U << 3U
+};
+
+// Size of the simulated post-transform vertex cache
+constexpr std::size_t vertexCacheSize{16};
+
+static_assert(sizeof(CacheHeader) % alignof(abcg::Vertex) == 0);
+static_assert(sizeof(abcg::Vertex) % alignof(abcg::QuantizedVertex) == 0);
+static_assert(sizeof(abcg::QuantizedVertex) % alignof(abcg::MeshLOD) == 0);
+static_assert(sizeof(abcg::MeshLOD) % alignof(std::uint32_t) == 0);
+static_assert(std::is_trivially_copyable_v<CacheHeader>);
+static_assert(std::is_trivially_copyable_v<abcg::Vertex>);
+static_assert(std::is_trivially_copyable_v<abcg::QuantizedVertex>);
+static_assert(std::is_trivially_copyable_v<abcg::MeshLOD>);
+
+[[nodiscard]] std::uint32_t cacheFlags(abcg::MeshCreateInfo const &createInfo) {
+  std::uint32_t flags{};
+  if (createInfo.optimize)
+    flags |= CacheFlags::Optimized;
+  if (createInfo.quantize)
+    flags |= CacheFlags::Quantized;
+  if (createInfo.generateNormals)
+    flags |= CacheFlags::GeneratedNormals;
+  if (createInfo.forceUInt32Indices)
+    flags |= CacheFlags::ForcedUInt32Indices;
+  return flags;
+}
+
+[[nodiscard]] std::size_t indexTypeSize(abcg::IndexType indexType) {
+  return indexType == abcg::IndexType::UInt16 ? sizeof(std::uint16_t)
+                                              : sizeof(std::uint32_t);
+}
+
+// Returns the size and modification time used to validate the cache
+[[nodiscard]] std::pair<std::uint64_t, std::int64_t>
+sourceStamp(std::string_view sourcePath) {
+  std::error_code errorCode;
+  std::filesystem::path const path{sourcePath};
+  auto const size{std::filesystem::file_size(path, errorCode)};
+  if (errorCode)
+    return {};
+  auto const time{std::filesystem::last_write_time(path, errorCode)};
+  if (errorCode)
+    return {};
+  return {size, gsl::narrow_cast<std::int64_t>(
+                    time.time_since_epoch().count())};
+}
+
+} // namespace
+
+/**
+ * @brief Read-only memory mapping of a file.
+ *
+ * The mapping is empty if the file could not be opened or mapped.
+ */
+class abcg::Mesh::MappedFile {
+public:
+  explicit MappedFile(std::string const &path) {
+#if defined(WIN32)
+    m_file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                         OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (m_file == INVALID_HANDLE_VALUE)
+      return;
+    LARGE_INTEGER size{};
+    if (GetFileSizeEx(m_file, &size) == 0 || size.QuadPart == 0)
+      return;
+    m_mapping =
+        CreateFileMappingA(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (m_mapping == nullptr)
+      return;
+    m_data = MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0);
+    if (m_data != nullptr) {
+      m_size = gsl::narrow<std::size_t>(size.QuadPart);
+    }
+#else
+    m_fd = open(path.c_str(), O_RDONLY);
+    if (m_fd < 0)
+      return;
+    struct stat status {};
+    if (fstat(m_fd, &status) != 0 || status.st_size <= 0)
+      return;
+    auto const size{gsl::narrow<std::size_t>(status.st_size)};
+    if (auto *data{mmap(nullptr, size, PROT_READ, MAP_PRIVATE, m_fd, 0)};
+        data != MAP_FAILED) {
+      m_data = data;
+      m_size = size;
+    }
+#endif
+  }
+
+  MappedFile(MappedFile const &) = delete;
+  MappedFile(MappedFile &&) = delete;
+  MappedFile &operator=(MappedFile const &) = delete;
+  MappedFile &operator=(MappedFile &&) = delete;
+
+  ~MappedFile() {
+#if defined(WIN32)
+    if (m_data != nullptr)
+      UnmapViewOfFile(m_data);
+    if (m_mapping != nullptr)
+      CloseHandle(m_mapping);
+    if (m_file != INVALID_HANDLE_VALUE)
+      CloseHandle(m_file);
+#else
+    if (m_data != nullptr)
+      munmap(m_data, m_size);
+    if (m_fd >= 0)
+      close(m_fd);
+#endif
+  }
+
+  [[nodiscard]] std::span<std::byte const> data() const noexcept {
+    return {static_cast<std::byte const *>(m_data), m_size};
+  }
+
+private:
+#if defined(WIN32)
+  HANDLE m_file{INVALID_HANDLE_VALUE};
+  HANDLE m_mapping{};
+#else
+  int m_fd{-1};
+#endif
+  void *m_data{};
+  std::size_t m_size{};
+};
+
+/**
+ * @brief Constructs an empty mesh.
+ */
+abcg::Mesh::Mesh() = default;
+
+/**
+ * @brief Default move constructor.
+ */
+abcg::Mesh::Mesh(Mesh &&) noexcept = default;
+
+/**
+ * @brief Default move assignment.
+ */
+abcg::Mesh &abcg::Mesh::operator=(Mesh &&) noexcept = default;
+
+/**
+ * @brief Destructor. Releases the mapping of the cache file, if any.
+ */
+abcg::Mesh::~Mesh() = default;
+
+/**
+ * @brief Loads a mesh from a Wavefront OBJ file or from its binary cache.
+ *
+ * If abcg::MeshCreateInfo::useCache is `true` and the cache file exists and
+ * matches the size and modification time of the OBJ file, the cache is
+ * memory-mapped. Otherwise, the OBJ file is parsed, its vertices are
+ * deduplicated and optionally optimized, simplified into levels of detail and
+ * quantized, and the cache file is (re)written.
+ *
+ * @param createInfo Configuration settings.
+ *
+ * @throw abcg::RuntimeError if the OBJ file could not be parsed.
+ */
+void abcg::Mesh::load(MeshCreateInfo const &createInfo) {
+  clear();
+
+  std::string const cachePath{createInfo.cachePath.empty()
+                                  ? std::string{createInfo.path} + ".abcgmesh"
+                                  : std::string{createInfo.cachePath}};
+
+  if (createInfo.useCache && loadCache(cachePath, createInfo))
+    return;
+
+  auto indices{loadObj(createInfo)};
+
+  auto const acmr{computeACMR(indices, m_vertices.size(), vertexCacheSize)};
+  m_optimizationReport = {.acmrBefore = acmr, .acmrAfter = acmr};
+  if (createInfo.optimize) {
+    optimize(indices);
+  }
+
+  generateLODs(indices, createInfo);
+
+  if (createInfo.quantize) {
+    quantize();
+  }
+
+  setIndices(indices, createInfo.forceUInt32Indices);
+
+  if (createInfo.useCache) {
+    writeCache(cachePath, createInfo);
+  }
+}
+
+/**
+ * @brief Releases the mesh data.
+ */
+void abcg::Mesh::clear() {
+  m_vertexSpan = {};
+  m_quantizedVertexSpan = {};
+  m_indexSpan = {};
+  m_lodSpan = {};
+  m_mappedFile.reset();
+  m_vertices.clear();
+  m_quantizedVertices.clear();
+  m_indices.clear();
+  m_lods.clear();
+  m_indexType = IndexType::UInt32;
+  m_boundsMin = {};
+  m_boundsMax = {};
+  m_texCoordMin = {};
+  m_texCoordExtent = {};
+  m_optimizationReport = {};
+}
+
+/**
+ * @brief Returns the size of each index of the index buffer.
+ *
+ * @return Size in bytes (2 or 4).
+ */
+std::size_t abcg::Mesh::getIndexSize() const noexcept {
+  return indexTypeSize(m_indexType);
+}
+
+/**
+ * @brief Returns the number of indices of the index buffer.
+ *
+ * @return Number of indices of all levels of detail. This is three times the
+ * number of triangles of the full-detail mesh if abcg::MeshCreateInfo::lodCount
+ * is 1.
+ */
+std::size_t abcg::Mesh::getIndexCount() const noexcept {
+  return m_indexSpan.size() / getIndexSize();
+}
+
+/**
+ * @brief Returns an index of the index buffer, widened to 32 bits.
+ *
+ * @param position Position of the index in the index buffer.
+ *
+ * @return Vertex index.
+ */
+std::uint32_t abcg::Mesh::getIndex(std::size_t position) const {
+  if (m_indexType == IndexType::UInt16) {
+    std::uint16_t index{};
+    std::memcpy(&index, m_indexSpan.subspan(position * sizeof(index)).data(),
+                sizeof(index));
+    return index;
+  }
+  std::uint32_t index{};
+  std::memcpy(&index, m_indexSpan.subspan(position * sizeof(index)).data(),
+              sizeof(index));
+  return index;
+}
+
+/**
+ * @brief Selects a level of detail from the size of its error on screen.
+ *
+ * The geometric error of each level of detail is projected at the distance of
+ * the point of the bounding sphere of the mesh closest to the camera. The
+ * coarsest level whose projected error does not exceed the given number of
+ * pixels is selected. As a result, the number of triangles drawn decreases as
+ * the mesh gets smaller on the screen.
+ *
+ * When the mesh is rotated with abcg::TrackBall, the model matrix is
+ * typically the rotation matrix of the trackball, e.g.:
+ * @code
+ * auto const modelMatrix{glm::mat4_cast(m_trackBall.getRotation())};
+ * auto const lod{m_mesh.getLODs()[m_mesh.selectLOD(m_viewMatrix * modelMatrix,
+ *                                                  m_projMatrix,
+ *                                                  m_viewportSize)]};
+ * @endcode
+ *
+ * @param modelViewMatrix Model-view matrix of the mesh.
+ * @param projMatrix Perspective or orthographic projection matrix.
+ * @param viewportSize Size of the viewport, in pixels.
+ * @param pixelError Maximum acceptable error, in pixels.
+ *
+ * @return Index of the selected level in abcg::Mesh::getLODs.
+ */
+std::size_t abcg::Mesh::selectLOD(glm::mat4 const &modelViewMatrix,
+                                  glm::mat4 const &projMatrix,
+                                  glm::ivec2 const &viewportSize,
+                                  float pixelError) const {
+  if (m_lodSpan.size() < 2)
+    return 0;
+
+  // Largest scale factor of the model-view matrix
+  auto const scale{std::max({glm::length(glm::vec3{modelViewMatrix[0]}),
+                             glm::length(glm::vec3{modelViewMatrix[1]}),
+                             glm::length(glm::vec3{modelViewMatrix[2]})})};
+
+  // Pixels per object-space unit
+  auto pixelsPerUnit{scale * projMatrix[1][1] *
+                     gsl::narrow<float>(viewportSize.y) * 0.5f};
+  auto const isPerspective{projMatrix[3][3] == 0.0f};
+  if (isPerspective) {
+    auto const center{(m_boundsMin + m_boundsMax) * 0.5f};
+    auto const radius{glm::length(m_boundsMax - m_boundsMin) * 0.5f * scale};
+    auto const viewCenter{modelViewMatrix * glm::vec4{center, 1.0f}};
+    auto const distance{-viewCenter.z - radius};
+    // The camera is inside the bounding sphere
+    if (distance <= 0.0f)
+      return 0;
+    pixelsPerUnit /= distance;
+  }
+
+  std::size_t selected{};
+  for (auto const index : iter::range<std::size_t>(1, m_lodSpan.size())) {
+    if (m_lodSpan[index].error * pixelsPerUnit > pixelError)
+      break;
+    selected = index;
+  }
+  return selected;
+}
+
+bool abcg::Mesh::loadCache(std::string const &cachePath,
+                           MeshCreateInfo const &createInfo) {
+  auto mappedFile{std::make_unique<MappedFile>(cachePath)};
+  auto const data{mappedFile->data()};
+  if (data.size() < sizeof(CacheHeader))
+    return false;
+
+  CacheHeader header{};
+  std::memcpy(&header, data.data(), sizeof(header));
+
+  if (header.magic != CacheHeader{}.magic ||
+      header.version != CacheHeader{}.version ||
+      header.flags != cacheFlags(createInfo) ||
+      header.requestedLODCount != createInfo.lodCount ||
+      header.lodReduction != createInfo.lodReduction || header.lodCount == 0)
+    return false;
+
+  // An OBJ file that no longer exists does not invalidate the cache
+  if (auto const [size, time]{sourceStamp(createInfo.path)};
+      size != 0 && (size != header.sourceSize || time != header.sourceTime))
+    return false;
+
+  if (header.indexType > static_cast<std::uint32_t>(IndexType::UInt32))
+    return false;
+  auto const indexType{static_cast<IndexType>(header.indexType)};
+
+  auto const quantizedCount{
+      (header.flags & CacheFlags::Quantized) != 0U ? header.vertexCount : 0U};
+  auto const vertexBytes{header.vertexCount * sizeof(Vertex)};
+  auto const quantizedBytes{quantizedCount * sizeof(QuantizedVertex)};
+  auto const lodBytes{header.lodCount * sizeof(MeshLOD)};
+  auto const indexBytes{header.indexCount * indexTypeSize(indexType)};
+  if (data.size() != sizeof(CacheHeader) + vertexBytes + quantizedBytes +
+                         lodBytes + indexBytes)
+    return false;
+
+  // The mapping is page-aligned and the header and array sizes are multiples
+  // of the alignment of the next array, so everything can be accessed in place
+  auto const vertexData{data.subspan(sizeof(CacheHeader))};
+  auto const quantizedData{vertexData.subspan(vertexBytes)};
+  auto const lodData{quantizedData.subspan(quantizedBytes)};
+  m_lodSpan = {reinterpret_cast<MeshLOD const *>(lodData.data()),
+               header.lodCount};
+  for (auto const &lod : m_lodSpan) {
+    if (std::uint64_t{lod.firstIndex} + lod.indexCount > header.indexCount) {
+      m_lodSpan = {};
+      return false;
+    }
+  }
+  m_vertexSpan = {reinterpret_cast<Vertex const *>(vertexData.data()),
+                  header.vertexCount};
+  m_quantizedVertexSpan = {
+      reinterpret_cast<QuantizedVertex const *>(quantizedData.data()),
+      quantizedCount};
+  m_indexSpan = lodData.subspan(lodBytes, indexBytes);
+  m_indexType = indexType;
+  m_boundsMin = header.boundsMin;
+  m_boundsMax = header.boundsMax;
+  m_texCoordMin = header.texCoordMin;
+  m_texCoordExtent = header.texCoordExtent;
+  m_optimizationReport = {.acmrBefore = header.acmrBefore,
+                          .acmrAfter = header.acmrAfter};
+  m_mappedFile = std::move(mappedFile);
+
+  return true;
+}
+
+void abcg::Mesh::writeCache(std::string const &cachePath,
+                            MeshCreateInfo const &createInfo) const {
+  CacheHeader header{};
+  std::tie(header.sourceSize, header.sourceTime) =
+      sourceStamp(createInfo.path);
+  header.vertexCount = gsl::narrow<std::uint32_t>(m_vertexSpan.size());
+  header.indexCount = gsl::narrow<std::uint32_t>(getIndexCount());
+  header.indexType = static_cast<std::uint32_t>(m_indexType);
+  header.flags = cacheFlags(createInfo);
+  header.boundsMin = m_boundsMin;
+  header.boundsMax = m_boundsMax;
+  header.texCoordMin = m_texCoordMin;
+  header.texCoordExtent = m_texCoordExtent;
+  header.acmrBefore = m_optimizationReport.acmrBefore;
+  header.acmrAfter = m_optimizationReport.acmrAfter;
+  header.lodCount = gsl::narrow<std::uint32_t>(m_lodSpan.size());
+  header.requestedLODCount = gsl::narrow<std::uint32_t>(createInfo.lodCount);
+  header.lodReduction = createInfo.lodReduction;
+
+  // Write to a temporary file first so that an interrupted write never leaves
+  // a truncated cache behind
+  auto const temporaryPath{cachePath + ".tmp"};
+  {
+    std::ofstream stream(temporaryPath, std::ios::binary | std::ios::trunc);
+    if (!stream) {
+      fmt::print("Warning: cannot write mesh cache {}\n", cachePath);
+      return;
+    }
+    auto const vertexBytes{std::as_bytes(m_vertexSpan)};
+    auto const quantizedBytes{std::as_bytes(m_quantizedVertexSpan)};
+    auto const lodBytes{std::as_bytes(m_lodSpan)};
+    stream.write(reinterpret_cast<char const *>(&header), sizeof(header));
+    stream.write(reinterpret_cast<char const *>(vertexBytes.data()),
+                 gsl::narrow<std::streamsize>(vertexBytes.size()));
+    stream.write(reinterpret_cast<char const *>(quantizedBytes.data()),
+                 gsl::narrow<std::streamsize>(quantizedBytes.size()));
+    stream.write(reinterpret_cast<char const *>(lodBytes.data()),
+                 gsl::narrow<std::streamsize>(lodBytes.size()));
+    stream.write(reinterpret_cast<char const *>(m_indexSpan.data()),
+                 gsl::narrow<std::streamsize>(m_indexSpan.size()));
+    if (!stream) {
+      fmt::print("Warning: cannot write mesh cache {}\n", cachePath);
+      return;
+    }
+  }
+
+  std::error_code errorCode;
+  std::filesystem::rename(temporaryPath, cachePath, errorCode);
+  if (errorCode) {
+    std::filesystem::remove(temporaryPath, errorCode);
+    fmt::print("Warning: cannot write mesh cache {}\n", cachePath);
+  }
+}
+
+std::vector<std::uint32_t>
+abcg::Mesh::loadObj(MeshCreateInfo const &createInfo) {
+  tinyobj::ObjReaderConfig readerConfig;
+  readerConfig.triangulate = true;
+  readerConfig.mtl_search_path =
+      std::filesystem::path{createInfo.path}.parent_path().string();
+
+  tinyobj::ObjReader reader;
+  if (!reader.ParseFromFile(std::string{createInfo.path}, readerConfig)) {
+    if (!reader.Error().empty()) {
+      throw abcg::RuntimeError(fmt::format("Failed to load model {} ({})",
+                                           createInfo.path, reader.Error()));
+    }
+    throw abcg::RuntimeError(
+        fmt::format("Failed to load model {}", createInfo.path));
+  }
+
+  if (!reader.Warning().empty()) {
+    fmt::print("Warning: {}\n", reader.Warning());
+  }
+
+  auto const &attrib{reader.GetAttrib()};
+  auto const &shapes{reader.GetShapes()};
+
+  std::size_t totalIndices{};
+  for (auto const &shape : shapes) {
+    totalIndices += shape.mesh.indices.size();
+  }
+
+  std::vector<std::uint32_t> indices;
+  indices.reserve(totalIndices);
+  m_vertices.reserve(totalIndices / 2);
+
+  // Map of unique vertices to their positions in the vertex buffer
+  std::unordered_map<Vertex, std::uint32_t> hashToIndex;
+  hashToIndex.reserve(totalIndices / 2);
+
+  auto hasNormals{true};
+  for (auto const &shape : shapes) {
+    for (auto const &index : shape.mesh.indices) {
+      auto const startIndex{3 * gsl::narrow<std::size_t>(index.vertex_index)};
+      Vertex vertex{};
+      vertex.position = {attrib.vertices.at(startIndex + 0),
+                         attrib.vertices.at(startIndex + 1),
+                         attrib.vertices.at(startIndex + 2)};
+
+      if (index.normal_index >= 0) {
+        auto const normalIndex{3 *
+                               gsl::narrow<std::size_t>(index.normal_index)};
+        vertex.normal = {attrib.normals.at(normalIndex + 0),
+                         attrib.normals.at(normalIndex + 1),
+                         attrib.normals.at(normalIndex + 2)};
+      } else {
+        hasNormals = false;
+      }
+
+      if (index.texcoord_index >= 0) {
+        auto const texCoordIndex{
+            2 * gsl::narrow<std::size_t>(index.texcoord_index)};
+        vertex.texCoord = {attrib.texcoords.at(texCoordIndex + 0),
+                           attrib.texcoords.at(texCoordIndex + 1)};
+      }
+
+      auto const [iter, inserted]{hashToIndex.try_emplace(
+          vertex, gsl::narrow<std::uint32_t>(m_vertices.size()))};
+      if (inserted) {
+        m_vertices.push_back(vertex);
+      }
+      indices.push_back(iter->second);
+    }
+  }
+
+  // Smooth normals from the area-weighted average of the face normals
+  if (!hasNormals && createInfo.generateNormals) {
+    for (auto &vertex : m_vertices) {
+      vertex.normal = glm::vec3(0.0f);
+    }
+    for (auto const offset : iter::range<std::size_t>(0, indices.size(), 3)) {
+      auto &a{m_vertices.at(indices.at(offset + 0))};
+      auto &b{m_vertices.at(indices.at(offset + 1))};
+      auto &c{m_vertices.at(indices.at(offset + 2))};
+      auto const faceNormal{
+          glm::cross(b.position - a.position, c.position - b.position)};
+      a.normal += faceNormal;
+      b.normal += faceNormal;
+      c.normal += faceNormal;
+    }
+    for (auto &vertex : m_vertices) {
+      if (glm::length2(vertex.normal) > 0.0f) {
+        vertex.normal = glm::normalize(vertex.normal);
+      }
+    }
+  }
+
+  // Bounding box
+  if (!m_vertices.empty()) {
+    m_boundsMin = glm::vec3(std::numeric_limits<float>::max());
+    m_boundsMax = glm::vec3(std::numeric_limits<float>::lowest());
+    for (auto const &vertex : m_vertices) {
+      m_boundsMin = glm::min(m_boundsMin, vertex.position);
+      m_boundsMax = glm::max(m_boundsMax, vertex.position);
+    }
+  }
+
+  m_vertexSpan = m_vertices;
+
+  return indices;
+}
+
+// Runs the vertex cache, overdraw and vertex fetch optimizations, in this
+// order
+void abcg::Mesh::optimize(std::vector<std::uint32_t> &indices) {
+  auto const clusters{
+      optimizeVertexCache(indices, m_vertices.size(), vertexCacheSize)};
+  optimizeOverdraw(indices, m_vertices, clusters);
+  optimizeVertexFetch(indices, m_vertices);
+  m_vertexSpan = m_vertices;
+
+  m_optimizationReport.acmrAfter =
+      computeACMR(indices, m_vertices.size(), vertexCacheSize);
+}
+
+// Appends the indices of the simplified levels of detail to the indices of
+// the full-detail mesh. Each level is simplified from the full-detail mesh so
+// that its error is measured with respect to the original surface.
+void abcg::Mesh::generateLODs(std::vector<std::uint32_t> &indices,
+                              MeshCreateInfo const &createInfo) {
+  std::vector<std::uint32_t> const fullDetail(indices);
+  m_lods.clear();
+  m_lods.push_back({.firstIndex = 0,
+                    .indexCount = gsl::narrow<std::uint32_t>(indices.size()),
+                    .error = 0.0f});
+
+  auto triangleCount{gsl::narrow<float>(fullDetail.size() / 3)};
+  while (m_lods.size() < createInfo.lodCount) {
+    triangleCount *= createInfo.lodReduction;
+    auto const targetIndexCount{
+        gsl::narrow_cast<std::size_t>(triangleCount) * 3};
+    auto error{0.0f};
+    auto lodIndices{
+        simplifyMesh(fullDetail, m_vertices, targetIndexCount, &error)};
+
+    // Stop if the mesh cannot be simplified much further
+    auto const previousCount{gsl::narrow<float>(m_lods.back().indexCount)};
+    if (lodIndices.empty() ||
+        gsl::narrow<float>(lodIndices.size()) >
+            previousCount * (1.0f + createInfo.lodReduction) * 0.5f)
+      break;
+
+    if (createInfo.optimize) {
+      [[maybe_unused]] auto const clusters{optimizeVertexCache(
+          lodIndices, m_vertices.size(), vertexCacheSize)};
+    }
+
+    m_lods.push_back(
+        {.firstIndex = gsl::narrow<std::uint32_t>(indices.size()),
+         .indexCount = gsl::narrow<std::uint32_t>(lodIndices.size()),
+         .error = std::max(error, m_lods.back().error)});
+    indices.insert(indices.end(), lodIndices.begin(), lodIndices.end());
+  }
+
+  m_lodSpan = m_lods;
+}
+
+void abcg::Mesh::quantize() {
+  if (!m_vertices.empty()) {
+    auto texCoordMax{glm::vec2(std::numeric_limits<float>::lowest())};
+    m_texCoordMin = glm::vec2(std::numeric_limits<float>::max());
+    for (auto const &vertex : m_vertices) {
+      m_texCoordMin = glm::min(m_texCoordMin, vertex.texCoord);
+      texCoordMax = glm::max(texCoordMax, vertex.texCoord);
+    }
+    m_texCoordExtent = texCoordMax - m_texCoordMin;
+  }
+
+  m_quantizedVertices.clear();
+  m_quantizedVertices.reserve(m_vertices.size());
+  for (auto const &vertex : m_vertices) {
+    m_quantizedVertices.push_back(
+        quantizeVertex(vertex, m_texCoordMin, m_texCoordExtent));
+  }
+  m_quantizedVertexSpan = m_quantizedVertices;
+}
+
+void abcg::Mesh::setIndices(std::vector<std::uint32_t> const &indices,
+                            bool forceUInt32Indices) {
+  // Use 16-bit indices if possible. 0xFFFF is left out as it is the fixed
+  // primitive restart index.
+  if (!forceUInt32Indices &&
+      m_vertices.size() < std::numeric_limits<std::uint16_t>::max()) {
+    m_indexType = IndexType::UInt16;
+    m_indices.resize(indices.size() * sizeof(std::uint16_t));
+    for (auto &&[position, index] : iter::enumerate(indices)) {
+      auto const shortIndex{gsl::narrow_cast<std::uint16_t>(index)};
+      std::memcpy(&m_indices.at(position * sizeof(shortIndex)), &shortIndex,
+                  sizeof(shortIndex));
+    }
+  } else {
+    m_indexType = IndexType::UInt32;
+    m_indices.resize(indices.size() * sizeof(std::uint32_t));
+    std::memcpy(m_indices.data(), indices.data(), m_indices.size());
+  }
+
+  m_indexSpan = m_indices;
+}
@@ -0,0 +1,338 @@
+/**
+ * @file abcgMesh.hpp
+ * @brief Header file of abcg::Mesh.
+ *
+ * Declaration of abcg::Mesh and related structures.
+ *
+ * This file is part of ABCg (https://github.com/hbatagelo/abcg).
+ *
+ * @copyright (c) 2021--2022 Harlen Batagelo. All rights reserved.
+ * This project is released under the MIT License.
+ */
+
+#ifndef ABCG_MESH_HPP_
+#define ABCG_MESH_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string_view>
+#include <vector>
+
+#include "abcgExternal.hpp"
+#include "abcgMeshOptimizer.hpp"
+#include "abcgUtil.hpp"
+
+namespace abcg {
+struct Vertex;
+struct MeshCreateInfo;
+struct MeshLOD;
+struct MeshOptimizationReport;
+enum class IndexType;
+class Mesh;
+} // namespace abcg
+
+/**
+ * @brief Vertex attributes of a mesh loaded with abcg::Mesh.
+ */
+struct abcg::Vertex {
+  /** @brief Vertex position. */
+  glm::vec3 position{};
+  /** @brief Vertex normal. */
+  glm::vec3 normal{};
+  /** @brief Texture coordinates. */
+  glm::vec2 texCoord{};
+
+  /**
+   * @brief Equality operator.
+   *
+   * Used for vertex deduplication.
+   */
+  friend bool operator==(Vertex const &, Vertex const &) = default;
+};
+
+/**
+ * @brief Hash function for abcg::Vertex.
+ */
+template <> struct std::hash<abcg::Vertex> {
+  /**
+   * @brief Returns the hash of a vertex.
+   *
+   * @param vertex Vertex to be hashed.
+   *
+   * @return Hash value combining all vertex attributes.
+   */
+  std::size_t operator()(abcg::Vertex const &vertex) const noexcept {
+    return abcg::hashCombine(vertex.position, vertex.normal, vertex.texCoord);
+  }
+};
+
+/**
+ * @brief Enumeration of index types used in the index buffer of a mesh.
+ */
+enum class abcg::IndexType {
+  /** @brief 16-bit unsigned integer indices. */
+  UInt16,
+  /** @brief 32-bit unsigned integer indices. */
+  UInt32
+};
+
+/**
+ * @brief Configuration settings for loading a mesh with abcg::Mesh::load.
+ */
+struct abcg::MeshCreateInfo {
+  /** @brief Path to the Wavefront OBJ file. */
+  std::string_view path{};
+  /** @brief Whether to read from and write to a binary cache file. */
+  bool useCache{true};
+  /** @brief Path to the binary cache file.
+   *
+   * If empty, the cache file is the path to the OBJ file appended with
+   * `.abcgmesh`.
+   */
+  std::string_view cachePath{};
+  /** @brief Whether to compute smooth vertex normals when the OBJ file does
+   * not contain normals. */
+  bool generateNormals{true};
+  /** @brief Whether to always use 32-bit indices, even if the number of unique
+   * vertices fits in 16 bits. */
+  bool forceUInt32Indices{false};
+  /** @brief Whether to reorder triangles and vertices for vertex cache
+   * efficiency, reduced overdraw and vertex fetch locality.
+   *
+   * @sa abcg::optimizeVertexCache, abcg::optimizeOverdraw and
+   * abcg::optimizeVertexFetch.
+   */
+  bool optimize{true};
+  /** @brief Whether to also generate compressed vertex attributes.
+   *
+   * @sa abcg::QuantizedVertex.
+   */
+  bool quantize{false};
+  /** @brief Number of levels of detail, including the full-detail mesh.
+   *
+   * Levels after the first are generated by abcg::simplifyMesh. Generation
+   * stops early if a level cannot be simplified further.
+   */
+  std::size_t lodCount{1};
+  /** @brief Ratio between the number of triangles of a level of detail and
+   * the number of triangles of the previous level. */
+  float lodReduction{0.5f};
+};
+
+/**
+ * @brief Range of the index buffer of a mesh that draws one level of detail.
+ *
+ * All levels of detail share the vertex buffer of the mesh.
+ */
+struct abcg::MeshLOD {
+  /** @brief Position of the first index in the index buffer. */
+  std::uint32_t firstIndex{};
+  /** @brief Number of indices. */
+  std::uint32_t indexCount{};
+  /** @brief Maximum geometric error, in object-space units, with respect to
+   * the full-detail mesh. */
+  float error{};
+};
+
+/**
+ * @brief Post-transform vertex cache efficiency of a mesh before and after
+ * optimization.
+ *
+ * @sa abcg::computeACMR.
+ */
+struct abcg::MeshOptimizationReport {
+  /** @brief Average cache miss ratio of the triangle order of the OBJ file. */
+  float acmrBefore{};
+  /** @brief Average cache miss ratio after optimization. */
+  float acmrAfter{};
+};
+
+/**
+ * @brief Represents an indexed triangle mesh loaded from a Wavefront OBJ file.
+ *
+ * Vertices are deduplicated on load and the index buffer uses 16-bit indices
+ * whenever the number of unique vertices allows it.
+ *
+ * By default, triangles and vertices are also reordered for the
+ * post-transform vertex cache, overdraw and vertex fetch (see
+ * abcg::MeshCreateInfo::optimize).
+ *
+ * Optionally, simplified levels of detail are generated and appended to the
+ * index buffer (see abcg::MeshCreateInfo::lodCount). Use
+ * abcg::Mesh::selectLOD to choose the level to draw and abcg::Mesh::getLODs to
+ * get its range of indices.
+ *
+ * The result is written to a binary cache file next to the OBJ file. On later
+ * loads, if the cache is up to date with the OBJ file, the cache is
+ * memory-mapped and the vertex and index data are accessed directly from the
+ * mapping, without parsing or copying.
+ *
+ * @remark Objects of this type cannot be copied or copy-constructed.
+ */
+class abcg::Mesh {
+public:
+  Mesh();
+  Mesh(Mesh const &) = delete;
+  Mesh(Mesh &&) noexcept;
+  Mesh &operator=(Mesh const &) = delete;
+  Mesh &operator=(Mesh &&) noexcept;
+  ~Mesh();
+
+  void load(MeshCreateInfo const &createInfo);
+  void clear();
+
+  /**
+   * @brief Returns the unique vertices of the mesh.
+   *
+   * @return Span of vertices.
+   */
+  [[nodiscard]] std::span<Vertex const> getVertices() const noexcept {
+    return m_vertexSpan;
+  }
+
+  /**
+   * @brief Returns the raw data of the index buffer.
+   *
+   * @return Span of bytes of the index buffer. The size of each index is given
+   * by abcg::Mesh::getIndexSize.
+   */
+  [[nodiscard]] std::span<std::byte const> getIndexData() const noexcept {
+    return m_indexSpan;
+  }
+
+  /**
+   * @brief Returns the type of the indices of the index buffer.
+   *
+   * @return abcg::IndexType::UInt16 or abcg::IndexType::UInt32.
+   */
+  [[nodiscard]] IndexType getIndexType() const noexcept { return m_indexType; }
+
+  /**
+   * @brief Returns the compressed vertices of the mesh.
+   *
+   * @return Span of compressed vertices, in the same order as
+   * abcg::Mesh::getVertices, or an empty span if the mesh was loaded with
+   * abcg::MeshCreateInfo::quantize set to `false`.
+   */
+  [[nodiscard]] std::span<QuantizedVertex const>
+  getQuantizedVertices() const noexcept {
+    return m_quantizedVertexSpan;
+  }
+
+  /**
+   * @brief Returns the minimum texture coordinates of the mesh.
+   *
+   * @return Offset used for decoding abcg::QuantizedVertex::texCoord.
+   */
+  [[nodiscard]] glm::vec2 const &getTexCoordMin() const noexcept {
+    return m_texCoordMin;
+  }
+
+  /**
+   * @brief Returns the extent of the texture coordinates of the mesh.
+   *
+   * @return Scale used for decoding abcg::QuantizedVertex::texCoord.
+   */
+  [[nodiscard]] glm::vec2 const &getTexCoordExtent() const noexcept {
+    return m_texCoordExtent;
+  }
+
+  /**
+   * @brief Returns the vertex cache efficiency before and after optimization.
+   *
+   * @return Optimization report. Both values are equal if the mesh was not
+   * optimized.
+   */
+  [[nodiscard]] MeshOptimizationReport const &
+  getOptimizationReport() const noexcept {
+    return m_optimizationReport;
+  }
+
+  /**
+   * @brief Returns the levels of detail of the mesh.
+   *
+   * @return Span of levels of detail, from the full-detail mesh to the
+   * coarsest level. The span is empty only if no mesh is loaded.
+   */
+  [[nodiscard]] std::span<MeshLOD const> getLODs() const noexcept {
+    return m_lodSpan;
+  }
+
+  [[nodiscard]] std::size_t selectLOD(glm::mat4 const &modelViewMatrix,
+                                      glm::mat4 const &projMatrix,
+                                      glm::ivec2 const &viewportSize,
+                                      float pixelError = 1.0f) const;
+
+  [[nodiscard]] std::size_t getIndexSize() const noexcept;
+  [[nodiscard]] std::size_t getIndexCount() const noexcept;
+  [[nodiscard]] std::uint32_t getIndex(std::size_t position) const;
+
+  /**
+   * @brief Returns the minimum corner of the axis-aligned bounding box.
+   *
+   * @return Minimum coordinates of the vertex positions.
+   */
+  [[nodiscard]] glm::vec3 const &getBoundsMin() const noexcept {
+    return m_boundsMin;
+  }
+
+  /**
+   * @brief Returns the maximum corner of the axis-aligned bounding box.
+   *
+   * @return Maximum coordinates of the vertex positions.
+   */
+  [[nodiscard]] glm::vec3 const &getBoundsMax() const noexcept {
+    return m_boundsMax;
+  }
+
+  /**
+   * @brief Returns whether the mesh was loaded from the binary cache.
+   *
+   * @return `true` if the data is mapped from the cache file; `false` if the
+   * data was parsed from the OBJ file.
+   */
+  [[nodiscard]] bool isFromCache() const noexcept {
+    return m_mappedFile != nullptr;
+  }
+
+private:
+  class MappedFile;
+
+  [[nodiscard]] bool loadCache(std::string const &cachePath,
+                               MeshCreateInfo const &createInfo);
+  void writeCache(std::string const &cachePath,
+                  MeshCreateInfo const &createInfo) const;
+  [[nodiscard]] std::vector<std::uint32_t>
+  loadObj(MeshCreateInfo const &createInfo);
+  void optimize(std::vector<std::uint32_t> &indices);
+  void generateLODs(std::vector<std::uint32_t> &indices,
+                    MeshCreateInfo const &createInfo);
+  void quantize();
+  void setIndices(std::vector<std::uint32_t> const &indices,
+                  bool forceUInt32Indices);
+
+  // Owned data, used when the mesh is parsed from the OBJ file
+  std::vector<Vertex> m_vertices;
+  std::vector<QuantizedVertex> m_quantizedVertices;
+  std::vector<std::byte> m_indices;
+  std::vector<MeshLOD> m_lods;
+
+  // Data mapped from the cache file
+  std::unique_ptr<MappedFile> m_mappedFile;
+
+  std::span<Vertex const> m_vertexSpan;
+  std::span<QuantizedVertex const> m_quantizedVertexSpan;
+  std::span<std::byte const> m_indexSpan;
+  std::span<MeshLOD const> m_lodSpan;
+  IndexType m_indexType{IndexType::UInt32};
+
+  glm::vec3 m_boundsMin{};
+  glm::vec3 m_boundsMax{};
+  glm::vec2 m_texCoordMin{};
+  glm::vec2 m_texCoordExtent{};
+  MeshOptimizationReport m_optimizationReport{};
+};
+
+#endif
@@ -0,0 +1,645 @@
+/**
+ * @file abcgMeshOptimizer.cpp
+ * @brief Definition of mesh optimization and quantization functions.
+ *
+ * This file is part of ABCg (https://github.com/hbatagelo/abcg).
+ *
+ * @copyright (c) 2021--2022 Harlen Batagelo. All rights reserved.
+ * This project is released under the MIT License.
+ */
+
+#include "abcgMeshOptimizer.hpp"
+
+#include <algorithm>
+#include <iterator>
+#include <limits>
+#include <numeric>
+
+#include <glm/gtc/packing.hpp>
+
+#include "abcgMesh.hpp"
+
+/**
+ * @brief Reorders triangles to improve the post-transform vertex cache hit
+ * rate.
+ *
+ * This implements the Tipsify algorithm (Sander, Nehab and Barczak, "Fast
+ * Triangle Reordering for Vertex Locality and Reduced Overdraw", 2007), which
+ * runs in linear time and does not depend on the exact cache replacement
+ * policy.
+ *
+ * @param indices Triangle list indices, reordered in place.
+ * @param vertexCount Number of vertices referenced by the indices.
+ * @param cacheSize Size of the target vertex cache.
+ *
+ * @return Offsets (in triangles) of the clusters of triangles emitted between
+ * two non-local jumps of the algorithm. These can be passed to
+ * abcg::optimizeOverdraw.
+ */
+std::vector<std::size_t> abcg::optimizeVertexCache(
+    std::span<std::uint32_t> indices, std::size_t vertexCount,
+    std::size_t cacheSize) {
+  auto const triangleCount{indices.size() / 3};
+  if (triangleCount == 0 || vertexCount == 0)
+    return {};
+
+  std::vector<std::uint32_t> const input(indices.begin(), indices.end());
+
+  // Number of triangles not yet emitted for each vertex
+  std::vector<std::uint32_t> liveCount(vertexCount);
+  for (auto const index : input) {
+    ++liveCount.at(index);
+  }
+
+  // Vertex-triangle adjacency in compressed sparse row format
+  std::vector<std::size_t> adjacencyOffset(vertexCount + 1);
+  for (auto const vertex : iter::range(vertexCount)) {
+    adjacencyOffset.at(vertex + 1) =
+        adjacencyOffset.at(vertex) + liveCount.at(vertex);
+  }
+  std::vector<std::uint32_t> adjacency(input.size());
+  {
+    auto fill{adjacencyOffset};
+    for (auto const position : iter::range(input.size())) {
+      adjacency.at(fill.at(input.at(position))++) =
+          gsl::narrow<std::uint32_t>(position / 3);
+    }
+  }
+
+  auto const cacheSizeSigned{gsl::narrow<std::int64_t>(cacheSize)};
+  std::vector<std::int64_t> cacheTime(vertexCount);
+  std::vector<bool> emitted(triangleCount);
+  std::vector<std::uint32_t> deadEnd;
+  deadEnd.reserve(input.size());
+  std::vector<std::uint32_t> candidates;
+  std::vector<std::uint32_t> output;
+  output.reserve(input.size());
+
+  std::vector<std::size_t> clusters{0};
+  auto timeStamp{cacheSizeSigned + 1};
+  std::size_t cursor{};
+  std::int64_t fanning{0};
+
+  while (fanning >= 0) {
+    auto const vertex{gsl::narrow<std::size_t>(fanning)};
+
+    // Emit all live triangles of the fanning vertex
+    candidates.clear();
+    for (auto const adjacencyIndex : iter::range(
+             adjacencyOffset.at(vertex), adjacencyOffset.at(vertex + 1))) {
+      auto const triangle{adjacency.at(adjacencyIndex)};
+      if (emitted.at(triangle))
+        continue;
+      for (auto const corner : iter::range<std::size_t>(3)) {
+        auto const index{input.at(triangle * 3 + corner)};
+        output.push_back(index);
+        deadEnd.push_back(index);
+        candidates.push_back(index);
+        --liveCount.at(index);
+        if (timeStamp - cacheTime.at(index) > cacheSizeSigned) {
+          cacheTime.at(index) = timeStamp++;
+        }
+      }
+      emitted.at(triangle) = true;
+    }
+
+    // Choose the candidate that will still be in the cache after its
+    // remaining triangles are emitted and that entered the cache the earliest
+    std::int64_t next{-1};
+    std::int64_t bestPriority{-1};
+    for (auto const candidate : candidates) {
+      if (liveCount.at(candidate) == 0)
+        continue;
+      std::int64_t priority{};
+      if (timeStamp - cacheTime.at(candidate) +
+              2 * std::int64_t{liveCount.at(candidate)} <=
+          cacheSizeSigned) {
+        priority = timeStamp - cacheTime.at(candidate);
+      }
+      if (priority > bestPriority) {
+        bestPriority = priority;
+        next = candidate;
+      }
+    }
+
+    // Dead end: backtrack through the recently emitted vertices, or else
+    // continue from the next vertex in input order. This starts a new cluster.
+    if (next == -1) {
+      while (!deadEnd.empty()) {
+        auto const candidate{deadEnd.back()};
+        deadEnd.pop_back();
+        if (liveCount.at(candidate) > 0) {
+          next = candidate;
+          break;
+        }
+      }
+      while (next == -1 && cursor < vertexCount) {
+        if (liveCount.at(cursor) > 0) {
+          next = gsl::narrow<std::int64_t>(cursor);
+        }
+        ++cursor;
+      }
+      if (next != -1 && output.size() / 3 != clusters.back()) {
+        clusters.push_back(output.size() / 3);
+      }
+    }
+
+    fanning = next;
+  }
+
+  std::copy(output.begin(), output.end(), indices.begin());
+
+  return clusters;
+}
+
+/**
+ * @brief Reorders clusters of triangles to reduce overdraw.
+ *
+ * Clusters are sorted in decreasing order of a view-independent occlusion
+ * potential: the dot product between the cluster's average normal and the
+ * vector from the mesh centroid to the cluster centroid. Clusters on the
+ * outside of the mesh, facing away from the center, are drawn first so that
+ * they tend to occlude the others. The order of triangles inside each
+ * cluster is preserved, and so is most of the vertex cache efficiency.
+ *
+ * @param indices Triangle list indices, reordered in place.
+ * @param vertices Vertices referenced by the indices.
+ * @param clusters Offsets (in triangles) of the clusters, as returned by
+ * abcg::optimizeVertexCache.
+ */
+void abcg::optimizeOverdraw(std::span<std::uint32_t> indices,
+                            std::span<Vertex const> vertices,
+                            std::span<std::size_t const> clusters) {
+  auto const triangleCount{indices.size() / 3};
+  if (clusters.size() < 2 || vertices.empty())
+    return;
+
+  glm::vec3 meshCentroid{};
+  for (auto const &vertex : vertices) {
+    meshCentroid += vertex.position;
+  }
+  meshCentroid /= gsl::narrow<float>(vertices.size());
+
+  struct Cluster {
+    std::size_t begin{};
+    std::size_t end{};
+    float sortKey{};
+  };
+
+  std::vector<Cluster> sortedClusters;
+  sortedClusters.reserve(clusters.size());
+  for (auto const clusterIndex : iter::range(clusters.size())) {
+    Cluster cluster{.begin = clusters[clusterIndex],
+                    .end = clusterIndex + 1 < clusters.size()
+                               ? clusters[clusterIndex + 1]
+                               : triangleCount};
+
+    // Area-weighted centroid and normal
+    glm::vec3 centroid{};
+    glm::vec3 normal{};
+    auto area{0.0f};
+    for (auto const triangle : iter::range(cluster.begin, cluster.end)) {
+      auto const &a{vertices[indices[triangle * 3 + 0]].position};
+      auto const &b{vertices[indices[triangle * 3 + 1]].position};
+      auto const &c{vertices[indices[triangle * 3 + 2]].position};
+      auto const faceNormal{glm::cross(b - a, c - a)};
+      auto const faceArea{glm::length(faceNormal)};
+      centroid += (a + b + c) / 3.0f * faceArea;
+      normal += faceNormal;
+      area += faceArea;
+    }
+    if (area > 0.0f && glm::length2(normal) > 0.0f) {
+      centroid /= area;
+      cluster.sortKey =
+          glm::dot(centroid - meshCentroid, glm::normalize(normal));
+    }
+    sortedClusters.push_back(cluster);
+  }
+
+  std::stable_sort(sortedClusters.begin(), sortedClusters.end(),
+                   [](Cluster const &lhs, Cluster const &rhs) {
+                     return lhs.sortKey > rhs.sortKey;
+                   });
+
+  std::vector<std::uint32_t> output;
+  output.reserve(indices.size());
+  for (auto const &cluster : sortedClusters) {
+    auto const first{std::next(indices.begin(),
+                               gsl::narrow<std::ptrdiff_t>(cluster.begin * 3))};
+    auto const last{std::next(indices.begin(),
+                              gsl::narrow<std::ptrdiff_t>(cluster.end * 3))};
+    output.insert(output.end(), first, last);
+  }
+  std::copy(output.begin(), output.end(), indices.begin());
+}
+
+/**
+ * @brief Reorders vertices in the order they are first referenced by the
+ * indices, to improve the locality of vertex fetches.
+ *
+ * Vertices that are not referenced are removed.
+ *
+ * @param indices Triangle list indices, remapped in place.
+ * @param vertices Vertices, reordered in place.
+ */
+void abcg::optimizeVertexFetch(std::span<std::uint32_t> indices,
+                               std::vector<Vertex> &vertices) {
+  constexpr auto unused{std::numeric_limits<std::uint32_t>::max()};
+  std::vector<std::uint32_t> remap(vertices.size(), unused);
+  std::vector<Vertex> reordered;
+  reordered.reserve(vertices.size());
+
+  for (auto &index : indices) {
+    if (remap.at(index) == unused) {
+      remap.at(index) = gsl::narrow<std::uint32_t>(reordered.size());
+      reordered.push_back(vertices.at(index));
+    }
+    index = remap.at(index);
+  }
+
+  vertices = std::move(reordered);
+}
+
+/**
+ * @brief Computes the average cache miss ratio (ACMR) of a triangle list.
+ *
+ * The ACMR is the number of vertex shader invocations per triangle, simulated
+ * with a FIFO post-transform cache. It ranges from 3 (no reuse) to about 0.5
+ * for regular grids.
+ *
+ * @param indices Triangle list indices.
+ * @param vertexCount Number of vertices referenced by the indices.
+ * @param cacheSize Size of the simulated FIFO cache.
+ *
+ * @return Average number of cache misses per triangle.
+ */
+float abcg::computeACMR(std::span<std::uint32_t const> indices,
+                        std::size_t vertexCount, std::size_t cacheSize) {
+  auto const triangleCount{indices.size() / 3};
+  if (triangleCount == 0)
+    return 0.0f;
+
+  // A vertex is in the cache if it was inserted less than cacheSize
+  // insertions ago
+  auto const cacheSizeSigned{gsl::narrow<std::int64_t>(cacheSize)};
+  std::vector<std::int64_t> insertionTime(vertexCount, -cacheSizeSigned - 1);
+  std::int64_t time{};
+  std::size_t misses{};
+  for (auto const index : indices) {
+    if (time - insertionTime.at(index) > cacheSizeSigned - 1) {
+      insertionTime.at(index) = time++;
+      ++misses;
+    }
+  }
+
+  return gsl::narrow_cast<float>(misses) /
+         gsl::narrow_cast<float>(triangleCount);
+}
+
+/**
+ * @brief Encodes a unit vector with the octahedral mapping.
+ *
+ * @param normal Normal vector. It does not need to be normalized.
+ *
+ * @return Encoded vector as two signed normalized 16-bit integers.
+ */
+std::array<std::int16_t, 2> abcg::encodeOctahedral(glm::vec3 const &normal) {
+  auto const sum{std::abs(normal.x) + std::abs(normal.y) + std::abs(normal.z)};
+  if (sum <= 0.0f)
+    return {};
+
+  auto const projected{normal / sum};
+  glm::vec2 encoded{projected.x, projected.y};
+  if (projected.z < 0.0f) {
+    encoded = (1.0f - glm::abs(glm::vec2{projected.y, projected.x})) *
+              glm::vec2{projected.x >= 0.0f ? 1.0f : -1.0f,
+                        projected.y >= 0.0f ? 1.0f : -1.0f};
+  }
+
+  auto const toSnorm16{[](float value) {
+    return gsl::narrow_cast<std::int16_t>(
+        std::round(glm::clamp(value, -1.0f, 1.0f) * 32767.0f));
+  }};
+  return {toSnorm16(encoded.x), toSnorm16(encoded.y)};
+}
+
+/**
+ * @brief Decodes a unit vector encoded with abcg::encodeOctahedral.
+ *
+ * @param encoded Encoded vector.
+ *
+ * @return Normalized vector.
+ */
+glm::vec3 abcg::decodeOctahedral(std::array<std::int16_t, 2> const &encoded) {
+  glm::vec2 const value{
+      glm::max(gsl::narrow_cast<float>(encoded[0]) / 32767.0f, -1.0f),
+      glm::max(gsl::narrow_cast<float>(encoded[1]) / 32767.0f, -1.0f)};
+  glm::vec3 normal{value, 1.0f - std::abs(value.x) - std::abs(value.y)};
+  auto const fold{std::max(-normal.z, 0.0f)};
+  normal.x += normal.x >= 0.0f ? -fold : fold;
+  normal.y += normal.y >= 0.0f ? -fold : fold;
+  return glm::length2(normal) > 0.0f ? glm::normalize(normal) : normal;
+}
+
+/**
+ * @brief Compresses the attributes of a vertex.
+ *
+ * @param vertex Vertex to be compressed.
+ * @param texCoordMin Minimum texture coordinates of the mesh.
+ * @param texCoordExtent Extent of the texture coordinates of the mesh.
+ *
+ * @return Compressed vertex.
+ *
+ * @sa abcg::QuantizedVertex.
+ */
+abcg::QuantizedVertex abcg::quantizeVertex(Vertex const &vertex,
+                                           glm::vec2 const &texCoordMin,
+                                           glm::vec2 const &texCoordExtent) {
+  QuantizedVertex quantized{};
+  quantized.position = {glm::packHalf1x16(vertex.position.x),
+                        glm::packHalf1x16(vertex.position.y),
+                        glm::packHalf1x16(vertex.position.z), 0};
+  quantized.normal = encodeOctahedral(vertex.normal);
+
+  auto const toUnorm16{[](float value, float min, float extent) {
+    auto const normalized{extent > 0.0f ? (value - min) / extent : 0.0f};
+    return gsl::narrow_cast<std::uint16_t>(
+        std::round(glm::clamp(normalized, 0.0f, 1.0f) * 65535.0f));
+  }};
+  quantized.texCoord = {
+      toUnorm16(vertex.texCoord.x, texCoordMin.x, texCoordExtent.x),
+      toUnorm16(vertex.texCoord.y, texCoordMin.y, texCoordExtent.y)};
+
+  return quantized;
+}
+
+namespace {
+
+// Error quadric of Garland and Heckbert, stored as the upper triangle of a
+// symmetric 4x4 matrix
+struct Quadric {
+  double a2{}, ab{}, ac{}, ad{}, b2{}, bc{}, bd{}, c2{}, cd{}, d2{};
+
+  void addPlane(glm::dvec3 const &normal, double distance) {
+    a2 += normal.x * normal.x;
+    ab += normal.x * normal.y;
+    ac += normal.x * normal.z;
+    ad += normal.x * distance;
+    b2 += normal.y * normal.y;
+    bc += normal.y * normal.z;
+    bd += normal.y * distance;
+    c2 += normal.z * normal.z;
+    cd += normal.z * distance;
+    d2 += distance * distance;
+  }
+
+  Quadric &operator+=(Quadric const &other) {
+    a2 += other.a2;
+    ab += other.ab;
+    ac += other.ac;
+    ad += other.ad;
+    b2 += other.b2;
+    bc += other.bc;
+    bd += other.bd;
+    c2 += other.c2;
+    cd += other.cd;
+    d2 += other.d2;
+    return *this;
+  }
+
+  // Sum of squared distances from the point to the accumulated planes
+  [[nodiscard]] double evaluate(glm::dvec3 const &point) const {
+    auto const x{point.x};
+    auto const y{point.y};
+    auto const z{point.z};
+    return a2 * x * x + 2 * ab * x * y + 2 * ac * x * z + 2 * ad * x +
+           b2 * y * y + 2 * bc * y * z + 2 * bd * y + c2 * z * z +
+           2 * cd * z + d2;
+  }
+};
+
+struct Collapse {
+  double cost{};
+  std::uint32_t from{};
+  std::uint32_t to{};
+};
+
+[[nodiscard]] std::uint64_t edgeKey(std::uint32_t first, std::uint32_t second) {
+  return (std::uint64_t{std::min(first, second)} << 32U) |
+         std::uint64_t{std::max(first, second)};
+}
+
+} // namespace
+
+/**
+ * @brief Simplifies a triangle mesh by quadric error edge collapse.
+ *
+ * Each collapse merges a vertex into one of its neighbors (half-edge
+ * collapse), so the simplified mesh references a subset of the original
+ * vertices and can share the same vertex buffer. Collapses are chosen in
+ * order of increasing quadric error (Garland and Heckbert, "Surface
+ * Simplification Using Quadric Error Metrics", 1997).
+ *
+ * Vertices on borders, attribute seams and non-manifold edges are kept in
+ * place. Collapses that would flip the orientation of a triangle are
+ * rejected.
+ *
+ * @param indices Triangle list indices.
+ * @param vertices Vertices referenced by the indices.
+ * @param targetIndexCount Desired number of indices. The result can have more
+ * indices if the mesh cannot be simplified further.
+ * @param error If not null, receives the maximum geometric error, in
+ * object-space units, of the collapses performed.
+ *
+ * @return Indices of the simplified mesh.
+ */
+std::vector<std::uint32_t>
+abcg::simplifyMesh(std::span<std::uint32_t const> indices,
+                   std::span<Vertex const> vertices,
+                   std::size_t targetIndexCount, float *error) {
+  std::vector<std::uint32_t> result(indices.begin(), indices.end());
+  auto maxCost{0.0};
+
+  auto const position{[&](std::uint32_t index) {
+    return glm::dvec3{vertices[index].position};
+  }};
+
+  // Plane quadrics of the original triangles
+  std::vector<Quadric> quadrics(vertices.size());
+  for (auto const offset : iter::range<std::size_t>(0, result.size(), 3)) {
+    auto const a{position(result[offset + 0])};
+    auto const b{position(result[offset + 1])};
+    auto const c{position(result[offset + 2])};
+    auto const normal{glm::cross(b - a, c - a)};
+    if (glm::length2(normal) <= 0.0)
+      continue;
+    auto const unitNormal{glm::normalize(normal)};
+    Quadric quadric{};
+    quadric.addPlane(unitNormal, -glm::dot(unitNormal, a));
+    for (auto const corner : iter::range<std::size_t>(3)) {
+      quadrics.at(result[offset + corner]) += quadric;
+    }
+  }
+
+  std::vector<std::uint64_t> edges;
+  std::vector<bool> locked(vertices.size());
+  std::vector<bool> touched(vertices.size());
+  std::vector<std::uint32_t> remap(vertices.size());
+  std::vector<std::size_t> adjacencyOffset(vertices.size() + 1);
+  std::vector<std::uint32_t> adjacency;
+  std::vector<Collapse> collapses;
+
+  while (result.size() > targetIndexCount) {
+    auto const triangleCount{result.size() / 3};
+
+    // Lock the endpoints of edges that are not shared by exactly two
+    // triangles: borders, attribute seams and non-manifold edges
+    edges.clear();
+    for (auto const offset : iter::range<std::size_t>(0, result.size(), 3)) {
+      for (auto const corner : iter::range<std::size_t>(3)) {
+        edges.push_back(edgeKey(result[offset + corner],
+                                result[offset + (corner + 1) % 3]));
+      }
+    }
+    std::sort(edges.begin(), edges.end());
+    std::fill(locked.begin(), locked.end(), false);
+    for (std::size_t begin{}; begin < edges.size();) {
+      auto end{begin + 1};
+      while (end < edges.size() && edges[end] == edges[begin]) {
+        ++end;
+      }
+      if (end - begin != 2) {
+        locked.at(edges[begin] >> 32U) = true;
+        locked.at(edges[begin] & 0xFFFFFFFFU) = true;
+      }
+      begin = end;
+    }
+
+    // Vertex-triangle adjacency
+    std::fill(adjacencyOffset.begin(), adjacencyOffset.end(), 0);
+    for (auto const index : result) {
+      ++adjacencyOffset.at(index + 1);
+    }
+    for (auto const vertex : iter::range(vertices.size())) {
+      adjacencyOffset.at(vertex + 1) += adjacencyOffset.at(vertex);
+    }
+    adjacency.resize(result.size());
+    {
+      auto fill{adjacencyOffset};
+      for (auto const offset : iter::range(result.size())) {
+        adjacency.at(fill.at(result[offset])++) =
+            gsl::narrow<std::uint32_t>(offset / 3);
+      }
+    }
+
+    // Candidate collapses sorted by cost
+    collapses.clear();
+    for (auto const offset : iter::range<std::size_t>(0, result.size(), 3)) {
+      for (auto const corner : iter::range<std::size_t>(3)) {
+        auto const from{result[offset + corner]};
+        auto const to{result[offset + (corner + 1) % 3]};
+        for (auto const &[source, target] : {std::pair{from, to},
+                                            std::pair{to, from}}) {
+          if (locked.at(source))
+            continue;
+          auto quadric{quadrics.at(source)};
+          quadric += quadrics.at(target);
+          collapses.push_back({.cost = std::max(
+                                   quadric.evaluate(position(target)), 0.0),
+                               .from = source,
+                               .to = target});
+        }
+      }
+    }
+    std::sort(collapses.begin(), collapses.end(),
+              [](Collapse const &lhs, Collapse const &rhs) {
+                return lhs.cost < rhs.cost;
+              });
+
+    // Greedily apply the cheapest collapses. Vertices around a collapsed
+    // vertex are not collapsed again in the same pass so that the
+    // orientation tests remain valid.
+    std::fill(touched.begin(), touched.end(), false);
+    std::iota(remap.begin(), remap.end(), 0U);
+    auto const trianglesToRemove{triangleCount - targetIndexCount / 3};
+    std::size_t removedTriangles{};
+
+    for (auto const &collapse : collapses) {
+      if (removedTriangles >= trianglesToRemove)
+        break;
+      if (touched.at(collapse.from) || touched.at(collapse.to))
+        continue;
+
+      auto const newPosition{position(collapse.to)};
+      auto valid{true};
+      std::size_t degenerate{};
+      for (auto const adjacencyIndex :
+           iter::range(adjacencyOffset.at(collapse.from),
+                       adjacencyOffset.at(collapse.from + 1))) {
+        auto const triangle{adjacency.at(adjacencyIndex)};
+        std::array<std::uint32_t, 3> const corners{result[triangle * 3 + 0],
+                                                   result[triangle * 3 + 1],
+                                                   result[triangle * 3 + 2]};
+        if (std::find(corners.begin(), corners.end(), collapse.to) !=
+            corners.end()) {
+          ++degenerate;
+          continue;
+        }
+        std::array<glm::dvec3, 3> before{};
+        std::array<glm::dvec3, 3> after{};
+        for (auto const corner : iter::range<std::size_t>(3)) {
+          before.at(corner) = position(corners.at(corner));
+          after.at(corner) = corners.at(corner) == collapse.from
+                                 ? newPosition
+                                 : before.at(corner);
+        }
+        auto const normalBefore{
+            glm::cross(before[1] - before[0], before[2] - before[0])};
+        auto const normalAfter{
+            glm::cross(after[1] - after[0], after[2] - after[0])};
+        if (glm::dot(normalBefore, normalAfter) <= 0.0) {
+          valid = false;
+          break;
+        }
+      }
+      if (!valid)
+        continue;
+
+      remap.at(collapse.from) = collapse.to;
+      quadrics.at(collapse.to) += quadrics.at(collapse.from);
+      for (auto const adjacencyIndex :
+           iter::range(adjacencyOffset.at(collapse.from),
+                       adjacencyOffset.at(collapse.from + 1))) {
+        auto const triangle{adjacency.at(adjacencyIndex)};
+        for (auto const corner : iter::range<std::size_t>(3)) {
+          touched.at(result[triangle * 3 + corner]) = true;
+        }
+      }
+      removedTriangles += degenerate;
+      maxCost = std::max(maxCost, collapse.cost);
+    }
+
+    if (removedTriangles == 0)
+      break;
+
+    // Apply the collapses and remove degenerate triangles
+    std::size_t size{};
+    for (auto const offset : iter::range<std::size_t>(0, result.size(), 3)) {
+      auto const a{remap.at(result[offset + 0])};
+      auto const b{remap.at(result[offset + 1])};
+      auto const c{remap.at(result[offset + 2])};
+      if (a == b || b == c || c == a)
+        continue;
+      result[size++] = a;
+      result[size++] = b;
+      result[size++] = c;
+    }
+    result.resize(size);
+  }
+
+  if (error != nullptr) {
+    *error = gsl::narrow_cast<float>(std::sqrt(maxCost));
+  }
+
+  return result;
+}
@@ -0,0 +1,81 @@
+/**
+ * @file abcgMeshOptimizer.hpp
+ * @brief Declaration of mesh optimization and quantization functions.
+ *
+ * This file is part of ABCg (https://github.com/hbatagelo/abcg).
+ *
+ * @copyright (c) 2021--2022 Harlen Batagelo. All rights reserved.
+ * This project is released under the MIT License.
+ */
+
+#ifndef ABCG_MESH_OPTIMIZER_HPP_
+#define ABCG_MESH_OPTIMIZER_HPP_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "abcgExternal.hpp"
+
+namespace abcg {
+struct Vertex;
+struct QuantizedVertex;
+
+[[nodiscard]] std::vector<std::size_t>
+optimizeVertexCache(std::span<std::uint32_t> indices, std::size_t vertexCount,
+                    std::size_t cacheSize = 16);
+void optimizeOverdraw(std::span<std::uint32_t> indices,
+                      std::span<Vertex const> vertices,
+                      std::span<std::size_t const> clusters);
+void optimizeVertexFetch(std::span<std::uint32_t> indices,
+                         std::vector<Vertex> &vertices);
+[[nodiscard]] float computeACMR(std::span<std::uint32_t const> indices,
+                                std::size_t vertexCount,
+                                std::size_t cacheSize = 16);
+[[nodiscard]] std::vector<std::uint32_t>
+simplifyMesh(std::span<std::uint32_t const> indices,
+             std::span<Vertex const> vertices, std::size_t targetIndexCount,
+             float *error = nullptr);
+
+[[nodiscard]] std::array<std::int16_t, 2>
+encodeOctahedral(glm::vec3 const &normal);
+[[nodiscard]] glm::vec3
+decodeOctahedral(std::array<std::int16_t, 2> const &encoded);
+[[nodiscard]] QuantizedVertex quantizeVertex(Vertex const &vertex,
+                                             glm::vec2 const &texCoordMin,
+                                             glm::vec2 const &texCoordExtent);
+} // namespace abcg
+
+/**
+ * @brief Compressed vertex attributes of a mesh loaded with abcg::Mesh.
+ *
+ * This uses 16 bytes per vertex instead of the 32 bytes of abcg::Vertex:
+ *
+ * - `position`: half-float x, y, z (fourth component is zero), to be read with
+ * `GL_HALF_FLOAT` / `vk::Format::eR16G16B16A16Sfloat`;
+ * - `normal`: octahedral encoding as two signed normalized 16-bit integers, to
+ * be read with `GL_SHORT` normalized / `vk::Format::eR16G16Snorm` and decoded
+ * in the shader as
+ * @code
+ * vec3 n = vec3(e.xy, 1.0 - abs(e.x) - abs(e.y));
+ * float t = max(-n.z, 0.0);
+ * n.xy += vec2(n.x >= 0.0 ? -t : t, n.y >= 0.0 ? -t : t);
+ * n = normalize(n);
+ * @endcode
+ * - `texCoord`: unsigned normalized 16-bit integers relative to the texture
+ * coordinate range of the mesh (abcg::Mesh::getTexCoordMin and
+ * abcg::Mesh::getTexCoordExtent), to be read with `GL_UNSIGNED_SHORT`
+ * normalized / `vk::Format::eR16G16Unorm`.
+ */
+struct abcg::QuantizedVertex {
+  /** @brief Half-float position, padded to four components. */
+  std::array<std::uint16_t, 4> position{};
+  /** @brief Octahedral-encoded normal. */
+  std::array<std::int16_t, 2> normal{};
+  /** @brief Normalized texture coordinates. */
+  std::array<std::uint16_t, 2> texCoord{};
+};
+
+#endif
@@ -0,0 +1,479 @@
+/**
+ * @file abcgMetrics.cpp
+ * @brief Definition of abcg::MetricsPublisher and abcg::MetricsReader
+ * members.
+ *
+ * This file is part of ABCg (https://github.com/hbatagelo/abcg).
+ *
+ * @copyright (c) 2021--2022 Harlen Batagelo. All rights reserved.
+ * This project is released under the MIT License.
+ */
+
+#include "abcgMetrics.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <charconv>
+#include <cstring>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+#include <cppitertools/itertools.hpp>
+#include <fmt/core.h>
+#include <gsl/gsl>
+
+#if !defined(WIN32) && !defined(__EMSCRIPTEN__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "abcgException.hpp"
+
+namespace {
+
+// "ABCGMET1", stored last by the publisher once the ring is initialized
+constexpr std::uint64_t metricsMagic{0x3154454d47434241};
+constexpr std::size_t counterNameSize{32};
+
+using SampleWords = std::array<std::uint64_t, sizeof(abcg::MetricsSample) /
+                                                  sizeof(std::uint64_t)>;
+static_assert(std::is_trivially_copyable_v<abcg::MetricsSample>);
+static_assert(sizeof(abcg::MetricsSample) == sizeof(SampleWords));
+static_assert(std::atomic<std::uint64_t>::is_always_lock_free);
+
+// Layout of the shared memory: the header, followed by the slots of the ring
+struct SharedHeader {
+  std::atomic<std::uint64_t> magic;
+  std::uint64_t capacity;
+  std::int64_t process;
+  std::atomic<std::uint64_t> published;
+  // Names are written before the count is incremented
+  std::atomic<std::uint64_t> counterCount;
+  std::array<std::array<char, counterNameSize>,
+             abcg::MetricsSample::maxCounters>
+      counterNames;
+};
+
+// Sequence lock: odd while the sample is being written, 2 * (index + 1) once
+// the sample of the given index is complete
+struct SharedSlot {
+  std::atomic<std::uint64_t> sequence;
+  SampleWords words;
+};
+
+constexpr std::size_t slotsOffset{(sizeof(SharedHeader) + 63) / 64 * 64};
+
+std::size_t getMappingSize(std::size_t capacity) {
+  return slotsOffset + capacity * sizeof(SharedSlot);
+}
+
+// NOLINTBEGIN(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+SharedHeader &getHeader(void *mapping) {
+  return *static_cast<SharedHeader *>(mapping);
+}
+
+SharedHeader const &getHeader(void const *mapping) {
+  return *static_cast<SharedHeader const *>(mapping);
+}
+
+SharedSlot *getSlots(void *mapping) {
+  return std::launder(reinterpret_cast<SharedSlot *>( // NOLINT
+      static_cast<std::byte *>(mapping) + slotsOffset));
+}
+
+SharedSlot const *getSlots(void const *mapping) {
+  return std::launder(reinterpret_cast<SharedSlot const *>( // NOLINT
+      static_cast<std::byte const *>(mapping) + slotsOffset));
+}
+// NOLINTEND(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+
+} // namespace
+
+/**
+ * @brief Move constructor. The shared memory, if open, is transferred.
+ *
+ * @param other Publisher to be moved from. It is left closed.
+ */
+abcg::MetricsPublisher::MetricsPublisher(MetricsPublisher &&other) noexcept {
+  *this = std::move(other);
+}
+
+/**
+ * @brief Move assignment. The shared memory, if open, is transferred.
+ *
+ * @param other Publisher to be moved from. It is left closed.
+ *
+ * @return Reference to this publisher.
+ */
+abcg::MetricsPublisher &
+abcg::MetricsPublisher::operator=(MetricsPublisher &&other) noexcept {
+  if (this != &other) {
+    close();
+    m_name = std::move(other.m_name);
+    m_mapping = std::exchange(other.m_mapping, nullptr);
+    m_mappingSize = std::exchange(other.m_mappingSize, 0);
+    m_published = other.m_published;
+    m_counterNames = std::move(other.m_counterNames);
+    m_counters = other.m_counters;
+    m_statmFile = std::exchange(other.m_statmFile, -1);
+    m_residentMemoryAge = other.m_residentMemoryAge;
+    m_residentMemory = other.m_residentMemory;
+  }
+  return *this;
+}
+
+/**
+ * @brief Destructor. Closes the shared memory, if open.
+ */
+abcg::MetricsPublisher::~MetricsPublisher() { close(); }
+
+/**
+ * @brief Creates the shared memory and starts publishing.
+ *
+ * @param name Name of the POSIX shared memory object, e.g. `/myapp`.
+ * @param capacity Number of samples kept in the ring.
+ *
+ * @throw abcg::RuntimeError if the shared memory could not be created, or if
+ * shared memory is not supported on the platform.
+ */
+void abcg::MetricsPublisher::open(std::string const &name,
+                                  std::size_t capacity) {
+  close();
+
+#if defined(WIN32) || defined(__EMSCRIPTEN__)
+  throw abcg::RuntimeError(
+      fmt::format("Failed to create {}: shared memory metrics are not "
+                  "supported on this platform",
+                  name));
+#else
+  capacity = std::max<std::size_t>(capacity, 1);
+  auto const size{getMappingSize(capacity)};
+
+  auto const file{
+      shm_open(name.c_str(), O_CREAT | O_RDWR | O_TRUNC, S_IRUSR | S_IWUSR)};
+  if (file < 0) {
+    throw abcg::RuntimeError(
+        fmt::format("Failed to create shared memory {}", name));
+  }
+  void *mapping{MAP_FAILED};
+  if (ftruncate(file, gsl::narrow<off_t>(size)) == 0) {
+    mapping = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, file, 0);
+  }
+  ::close(file);
+  if (mapping == MAP_FAILED) {
+    shm_unlink(name.c_str());
+    throw abcg::RuntimeError(
+        fmt::format("Failed to map shared memory {}", name));
+  }
+
+  m_name = name;
+  m_mapping = mapping;
+  m_mappingSize = size;
+  m_published = 0;
+
+  auto &header{*new (mapping) SharedHeader{}};
+  header.capacity = capacity;
+  header.process = getpid();
+  std::uninitialized_value_construct_n(getSlots(mapping), capacity);
+  for (auto const counter : iter::range(m_counterNames.size())) {
+    writeCounterName(counter);
+  }
+
+  m_statmFile = ::open("/proc/self/statm", O_RDONLY);
+  m_residentMemory = readResidentMemory();
+  m_residentMemoryAge.restart();
+
+  header.magic.store(metricsMagic, std::memory_order_release);
+#endif
+}
+
+/**
+ * @brief Stops publishing and removes the shared memory object.
+ *
+ * Readers that already mapped the ring can still read the last samples.
+ */
+void abcg::MetricsPublisher::close() {
+  if (m_mapping == nullptr)
+    return;
+
+#if !defined(WIN32) && !defined(__EMSCRIPTEN__)
+  munmap(m_mapping, m_mappingSize);
+  shm_unlink(m_name.c_str());
+  if (m_statmFile >= 0) {
+    ::close(m_statmFile);
+  }
+#endif
+  m_statmFile = -1;
+  m_mapping = nullptr;
+  m_mappingSize = 0;
+  m_name.clear();
+}
+
+/**
+ * @brief Registers an application counter.
+ *
+ * Counters can be registered before or after the shared memory is open.
+ * Registering a name twice returns the same counter.
+ *
+ * @param name Name of the counter. Names are truncated to 31 characters.
+ *
+ * @return Index of the counter, to be passed to
+ * abcg::MetricsPublisher::setCounter.
+ *
+ * @throw abcg::RuntimeError if abcg::MetricsSample::maxCounters counters are
+ * already registered.
+ */
+std::size_t abcg::MetricsPublisher::registerCounter(std::string_view name) {
+  if (auto const found{std::ranges::find(m_counterNames, name)};
+      found != m_counterNames.end()) {
+    return gsl::narrow<std::size_t>(
+        std::distance(m_counterNames.begin(), found));
+  }
+
+  if (m_counterNames.size() == MetricsSample::maxCounters) {
+    throw abcg::RuntimeError(
+        fmt::format("Failed to register metrics counter {}: at most {} "
+                    "counters are supported",
+                    name, MetricsSample::maxCounters));
+  }
+
+  m_counterNames.emplace_back(name);
+  auto const counter{m_counterNames.size() - 1};
+  if (isOpen()) {
+    writeCounterName(counter);
+  }
+  return counter;
+}
+
+/**
+ * @brief Sets the value of an application counter.
+ *
+ * The value is published with the next sample and the following ones, until
+ * it is set again.
+ *
+ * @param counter Index returned by abcg::MetricsPublisher::registerCounter.
+ * @param value New value.
+ */
+void abcg::MetricsPublisher::setCounter(std::size_t counter, double value) {
+  Expects(counter < m_counterNames.size());
+  m_counters.at(counter) = value;
+}
+
+/**
+ * @brief Writes a sample to the next slot of the ring.
+ *
+ * This does nothing if the shared memory is not open. Otherwise, it takes a
+ * few stores and never blocks.
+ *
+ * @param sample Metrics of the frame. The resident memory and the counters
+ * are filled in by the publisher.
+ */
+void abcg::MetricsPublisher::publish(MetricsSample sample) {
+  if (!isOpen())
+    return;
+
+  if (m_residentMemoryAge.elapsed() >= 1.0) {
+    m_residentMemory = readResidentMemory();
+    m_residentMemoryAge.restart();
+  }
+  sample.residentMemory = m_residentMemory;
+  sample.counters = m_counters;
+
+  auto &header{getHeader(m_mapping)};
+  // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+  auto &slot{getSlots(m_mapping)[m_published % header.capacity]};
+
+  slot.sequence.store(m_published * 2 + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  auto const words{std::bit_cast<SampleWords>(sample)};
+  for (auto &&[target, word] : iter::zip(slot.words, words)) {
+    std::atomic_ref{target}.store(word, std::memory_order_relaxed);
+  }
+  slot.sequence.store(m_published * 2 + 2, std::memory_order_release);
+
+  ++m_published;
+  header.published.store(m_published, std::memory_order_release);
+}
+
+void abcg::MetricsPublisher::writeCounterName(std::size_t counter) {
+  auto &header{getHeader(m_mapping)};
+  auto &target{header.counterNames.at(counter)};
+  auto const &name{m_counterNames.at(counter)};
+  target.fill('\0');
+  std::copy_n(name.begin(), std::min(name.size(), target.size() - 1),
+              target.begin());
+  header.counterCount.store(counter + 1, std::memory_order_release);
+}
+
+// Resident set size from /proc/self/statm, or zero if unavailable
+std::uint64_t abcg::MetricsPublisher::readResidentMemory() {
+#if defined(WIN32) || defined(__EMSCRIPTEN__)
+  return 0;
+#else
+  if (m_statmFile < 0)
+    return 0;
+
+  // Total program size and resident set size, in pages
+  std::array<char, 128> buffer{};
+  auto const size{pread(m_statmFile, buffer.data(), buffer.size() - 1, 0)};
+  if (size <= 0)
+    return 0;
+  std::string_view const statm{buffer.data(), gsl::narrow<std::size_t>(size)};
+  auto const separator{statm.find(' ')};
+  if (separator == std::string_view::npos)
+    return 0;
+
+  std::uint64_t pages{};
+  // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+  std::from_chars(statm.data() + separator + 1, statm.data() + statm.size(),
+                  pages);
+  return pages * gsl::narrow<std::uint64_t>(sysconf(_SC_PAGESIZE));
+#endif
+}
+
+/**
+ * @brief Destructor. Unmaps the shared memory, if mapped.
+ */
+abcg::MetricsReader::~MetricsReader() { close(); }
+
+/**
+ * @brief Maps the ring of a publisher.
+ *
+ * @param name Name of the shared memory object given to
+ * abcg::MetricsPublisher::open.
+ *
+ * @throw abcg::RuntimeError if the shared memory could not be opened or does
+ * not contain a metrics ring.
+ */
+void abcg::MetricsReader::open(std::string const &name) {
+  close();
+
+#if defined(WIN32) || defined(__EMSCRIPTEN__)
+  throw abcg::RuntimeError(
+      fmt::format("Failed to open {}: shared memory metrics are not "
+                  "supported on this platform",
+                  name));
+#else
+  auto const file{shm_open(name.c_str(), O_RDONLY, 0)};
+  if (file < 0) {
+    throw abcg::RuntimeError(
+        fmt::format("Failed to open shared memory {}", name));
+  }
+  struct stat status {};
+  void *mapping{MAP_FAILED};
+  if (fstat(file, &status) == 0 &&
+      gsl::narrow<std::size_t>(status.st_size) >= getMappingSize(1)) {
+    m_mappingSize = gsl::narrow<std::size_t>(status.st_size);
+    mapping = mmap(nullptr, m_mappingSize, PROT_READ, MAP_SHARED, file, 0);
+  }
+  ::close(file);
+  if (mapping == MAP_FAILED) {
+    throw abcg::RuntimeError(
+        fmt::format("Failed to map shared memory {}", name));
+  }
+  m_mapping = mapping;
+
+  auto const &header{getHeader(m_mapping)};
+  if (header.magic.load(std::memory_order_acquire) != metricsMagic ||
+      getMappingSize(header.capacity) > m_mappingSize) {
+    close();
+    throw abcg::RuntimeError(
+        fmt::format("Shared memory {} is not a metrics ring", name));
+  }
+#endif
+}
+
+/**
+ * @brief Unmaps the ring.
+ */
+void abcg::MetricsReader::close() {
+  if (m_mapping == nullptr)
+    return;
+
+#if !defined(WIN32) && !defined(__EMSCRIPTEN__)
+  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-const-cast)
+  munmap(const_cast<void *>(m_mapping), m_mappingSize);
+#endif
+  m_mapping = nullptr;
+  m_mappingSize = 0;
+}
+
+/**
+ * @brief Returns the number of samples published so far.
+ *
+ * @return Index of the next sample to be published.
+ */
+std::uint64_t abcg::MetricsReader::getPublishedCount() const noexcept {
+  return getHeader(m_mapping).published.load(std::memory_order_acquire);
+}
+
+/**
+ * @brief Returns the number of samples kept in the ring.
+ *
+ * @return Capacity of the ring. Only the last `capacity` samples can be read.
+ */
+std::size_t abcg::MetricsReader::getCapacity() const noexcept {
+  return gsl::narrow_cast<std::size_t>(getHeader(m_mapping).capacity);
+}
+
+/**
+ * @brief Returns the process ID of the publisher.
+ *
+ * @return Process ID.
+ */
+std::int64_t abcg::MetricsReader::getPublisherProcess() const noexcept {
+  return getHeader(m_mapping).process;
+}
+
+/**
+ * @brief Returns the names of the counters registered so far.
+ *
+ * @return Names, in the order of the values of abcg::MetricsSample::counters.
+ */
+std::vector<std::string> abcg::MetricsReader::getCounterNames() const {
+  auto const &header{getHeader(m_mapping)};
+  auto const count{header.counterCount.load(std::memory_order_acquire)};
+  std::vector<std::string> names;
+  for (auto const counter : iter::range(count)) {
+    auto const &name{header.counterNames.at(counter)};
+    names.emplace_back(name.data(), strnlen(name.data(), name.size()));
+  }
+  return names;
+}
+
+/**
+ * @brief Reads a sample.
+ *
+ * @param index Index of the sample, smaller than
+ * abcg::MetricsReader::getPublishedCount.
+ *
+ * @return The sample, or `std::nullopt` if it was not published yet or was
+ * overwritten by a newer sample.
+ */
+std::optional<abcg::MetricsSample>
+abcg::MetricsReader::read(std::uint64_t index) const {
+  auto const &header{getHeader(m_mapping)};
+  // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+  auto const &slot{getSlots(m_mapping)[index % header.capacity]};
+
+  auto const sequence{index * 2 + 2};
+  if (slot.sequence.load(std::memory_order_acquire) != sequence)
+    return std::nullopt;
+
+  SampleWords words{};
+  for (auto &&[word, source] : iter::zip(words, slot.words)) {
+    // The mapping is read-only, but loads do not write
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-const-cast)
+    word = std::atomic_ref{const_cast<std::uint64_t &>(source)}.load(
+        std::memory_order_relaxed);
+  }
+  std::atomic_thread_fence(std::memory_order_acquire);
+  if (slot.sequence.load(std::memory_order_relaxed) != sequence)
+    return std::nullopt;
+
+  return std::bit_cast<MetricsSample>(words);
+}
@@ -0,0 +1,153 @@
+/**
+ * @file abcgMetrics.hpp
+ * @brief Header file of abcg::MetricsPublisher and abcg::MetricsReader.
+ *
+ * Declaration of the shared-memory metrics ring and of its samples.
+ *
+ * This file is part of ABCg (https://github.com/hbatagelo/abcg).
+ *
+ * @copyright (c) 2021--2022 Harlen Batagelo. All rights reserved.
+ * This project is released under the MIT License.
+ */
+
+#ifndef ABCG_METRICS_HPP_
+#define ABCG_METRICS_HPP_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "abcgTimer.hpp"
+
+namespace abcg {
+struct MetricsSample;
+class MetricsPublisher;
+class MetricsReader;
+} // namespace abcg
+
+/**
+ * @brief Metrics of a frame published by abcg::MetricsPublisher.
+ *
+ * Times are in milliseconds unless stated otherwise.
+ */
+struct abcg::MetricsSample {
+  /** @brief Maximum number of application counters. */
+  static constexpr std::size_t maxCounters{16};
+
+  /** @brief Frame number, starting at zero. */
+  std::uint64_t frame{};
+  /** @brief Time since the window was created, in seconds. */
+  double time{};
+  /** @brief CPU time spent painting the frame. */
+  double cpuTime{};
+  /** @brief Time since the previous frame started. */
+  double frameInterval{};
+  /** @brief GPU time of the paint pass, or zero if not measured. */
+  double gpuPaint{};
+  /** @brief GPU time of the UI pass, or zero if not measured. */
+  double gpuUI{};
+  /** @brief GPU time of the buffer swap, or zero if not measured. */
+  double gpuSwap{};
+  /** @brief Number of objects in the visible sets of the frame. */
+  std::uint64_t visible{};
+  /** @brief Number of objects culled in the frame. */
+  std::uint64_t culled{};
+  /** @brief Resident memory of the process, in bytes, sampled every second.
+   * Zero if unknown. */
+  std::uint64_t residentMemory{};
+  /** @brief Values of the counters registered with
+   * abcg::MetricsPublisher::registerCounter. */
+  std::array<double, maxCounters> counters{};
+};
+
+/**
+ * @brief Publishes the metrics of each frame to a ring buffer in shared
+ * memory.
+ *
+ * Other processes can follow the ring with abcg::MetricsReader (e.g., with
+ * the `abcgmetrics` command-line tool) without the application doing any
+ * socket or file I/O on the render thread. Publishing is enabled by
+ * launching the application with `--metrics <name>`:
+ * @code
+ * ./app --metrics /myapp &
+ * abcgmetrics /myapp --json
+ * @endcode
+ *
+ * Each slot of the ring is guarded by a sequence number, so that a slow
+ * reader detects slots overwritten while it reads them, and the publisher
+ * never waits for readers. Shared memory is only supported on POSIX systems
+ * other than WebAssembly.
+ */
+class abcg::MetricsPublisher {
+public:
+  MetricsPublisher() = default;
+  MetricsPublisher(MetricsPublisher const &) = delete;
+  MetricsPublisher(MetricsPublisher &&other) noexcept;
+  MetricsPublisher &operator=(MetricsPublisher const &) = delete;
+  MetricsPublisher &operator=(MetricsPublisher &&other) noexcept;
+  ~MetricsPublisher();
+
+  void open(std::string const &name, std::size_t capacity = 1024);
+  void close();
+
+  std::size_t registerCounter(std::string_view name);
+  void setCounter(std::size_t counter, double value);
+  void publish(MetricsSample sample);
+
+  /**
+   * @brief Whether the shared memory is open.
+   *
+   * @return `true` if samples are published.
+   */
+  [[nodiscard]] bool isOpen() const noexcept { return m_mapping != nullptr; }
+
+private:
+  void writeCounterName(std::size_t counter);
+  [[nodiscard]] std::uint64_t readResidentMemory();
+
+  std::string m_name;
+  void *m_mapping{};
+  std::size_t m_mappingSize{};
+  std::uint64_t m_published{};
+
+  std::vector<std::string> m_counterNames;
+  std::array<double, MetricsSample::maxCounters> m_counters{};
+
+  // Resident memory is read from procfs at most once per second
+  int m_statmFile{-1};
+  Timer m_residentMemoryAge;
+  std::uint64_t m_residentMemory{};
+};
+
+/**
+ * @brief Reads the metrics published by an abcg::MetricsPublisher of
+ * another process.
+ */
+class abcg::MetricsReader {
+public:
+  MetricsReader() = default;
+  MetricsReader(MetricsReader const &) = delete;
+  MetricsReader(MetricsReader &&) = delete;
+  MetricsReader &operator=(MetricsReader const &) = delete;
+  MetricsReader &operator=(MetricsReader &&) = delete;
+  ~MetricsReader();
+
+  void open(std::string const &name);
+  void close();
+
+  [[nodiscard]] std::uint64_t getPublishedCount() const noexcept;
+  [[nodiscard]] std::size_t getCapacity() const noexcept;
+  [[nodiscard]] std::int64_t getPublisherProcess() const noexcept;
+  [[nodiscard]] std::vector<std::string> getCounterNames() const;
+  [[nodiscard]] std::optional<MetricsSample> read(std::uint64_t index) const;
+
+private:
+  void const *m_mapping{};
+  std::size_t m_mappingSize{};
+};
+
+#endif
@@ -14,8 +14,15 @@
 #define ABCG_OPENGL_HPP_
 
 #include "abcg.hpp"
+#include "abcgOpenGLHandle.hpp"
+#include "abcgOpenGLGPUTimer.hpp"
 #include "abcgOpenGLImage.hpp"
+#include "abcgOpenGLIndirectDraw.hpp"
+#include "abcgOpenGLParticleSystem.hpp"
+#include "abcgOpenGLProgram.hpp"
+#include "abcgOpenGLRenderQueue.hpp"
 #include "abcgOpenGLShader.hpp"
+#include "abcgOpenGLUniformBuffer.hpp"
 #include "abcgOpenGLWindow.hpp"
 
 #endif
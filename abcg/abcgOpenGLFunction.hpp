@@ -1430,6 +1430,48 @@ inline void glGetInternalformativ(
          count, params);
 }
 
+#if !defined(__EMSCRIPTEN__)
+
+// OpenGL ES 3.1 function definitions
+inline void glDrawArraysIndirect(
+    GLenum mode, void const *indirect,
+    source_location const &sourceLocation = source_location::current()) {
+  callGL(sourceLocation, ::glDrawArraysIndirect, mode, indirect);
+}
+inline void glDrawElementsIndirect(
+    GLenum mode, GLenum type, void const *indirect,
+    source_location const &sourceLocation = source_location::current()) {
+  callGL(sourceLocation, ::glDrawElementsIndirect, mode, type, indirect);
+}
+
+// OpenGL 4.3+ function definitions
+inline void glMultiDrawArraysIndirect(
+    GLenum mode, void const *indirect, GLsizei drawcount, GLsizei stride,
+    source_location const &sourceLocation = source_location::current()) {
+  callGL(sourceLocation, ::glMultiDrawArraysIndirect, mode, indirect,
+         drawcount, stride);
+}
+inline void glMultiDrawElementsIndirect(
+    GLenum mode, GLenum type, void const *indirect, GLsizei drawcount,
+    GLsizei stride,
+    source_location const &sourceLocation = source_location::current()) {
+  callGL(sourceLocation, ::glMultiDrawElementsIndirect, mode, type, indirect,
+         drawcount, stride);
+}
+
+// OpenGL 3.3+ function definitions
+inline void glQueryCounter(
+    GLuint id, GLenum target,
+    source_location const &sourceLocation = source_location::current()) {
+  callGL(sourceLocation, ::glQueryCounter, id, target);
+}
+inline void glGetQueryObjectui64v(
+    GLuint id, GLenum pname, GLuint64 *params,
+    source_location const &sourceLocation = source_location::current()) {
+  callGL(sourceLocation, ::glGetQueryObjectui64v, id, pname, params);
+}
+#endif
+
 #if !defined(NDEBUG) && !defined(__EMSCRIPTEN__) && !defined(__APPLE__)
 
 // OpenGL 3.0+ function definitions
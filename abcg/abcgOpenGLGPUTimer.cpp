@@ -0,0 +1,201 @@
+/**
+ * @file abcgOpenGLGPUTimer.cpp
+ * @brief Definition of abcg::OpenGLGPUTimer members.
+ *
+ * This file is part of ABCg (https://github.com/hbatagelo/abcg).
+ *
+ * @copyright (c) 2021--2022 Harlen Batagelo. All rights reserved.
+ * This project is released under the MIT License.
+ */
+
+#include "abcgOpenGLGPUTimer.hpp"
+
+#include <algorithm>
+#include <string_view>
+
+#include <cppitertools/itertools.hpp>
+#include <gsl/gsl>
+
+#if defined(__EMSCRIPTEN__)
+#include <GLES2/gl2ext.h>
+#endif
+
+#include "abcgOpenGLFunction.hpp"
+
+namespace {
+
+// Whether the current context supports timer queries
+[[nodiscard]] bool queryTimerSupport() {
+#if defined(__EMSCRIPTEN__)
+  return emscripten_webgl_enable_extension(
+             emscripten_webgl_get_current_context(),
+             "EXT_disjoint_timer_query_webgl2") == EM_TRUE;
+#else
+  auto const *version{
+      reinterpret_cast<char const *>(abcg::glGetString(GL_VERSION))};
+  if (version == nullptr || std::string_view{version}.starts_with("OpenGL ES"))
+    return false;
+  GLint major{};
+  GLint minor{};
+  abcg::glGetIntegerv(GL_MAJOR_VERSION, &major);
+  abcg::glGetIntegerv(GL_MINOR_VERSION, &minor);
+  return major > 3 || (major == 3 && minor >= 3) ||
+         glewIsSupported("GL_ARB_timer_query");
+#endif
+}
+
+} // namespace
+
+/**
+ * @brief Creates the query objects.
+ *
+ * This must be called while the OpenGL context is current.
+ *
+ * @param scopeCount Number of scopes measured per frame.
+ * @param latency Number of frames between measuring a scope and reading its
+ * result.
+ */
+void abcg::OpenGLGPUTimer::create(std::size_t scopeCount,
+                                  std::size_t latency) {
+  destroy();
+
+  m_supported = queryTimerSupport();
+  m_scopeCount = scopeCount;
+  m_latency = std::max<std::size_t>(latency, 1);
+  m_times.assign(scopeCount, 0.0);
+  if (!m_supported)
+    return;
+
+  m_queries.resize(m_latency * m_scopeCount * 2);
+  abcg::glGenQueries(gsl::narrow<GLsizei>(m_queries.size()), m_queries.data());
+  m_issued.assign(m_latency * m_scopeCount, false);
+}
+
+/**
+ * @brief Deletes the query objects.
+ *
+ * This must be called while the OpenGL context is current.
+ */
+void abcg::OpenGLGPUTimer::destroy() {
+  if (!m_queries.empty()) {
+    abcg::glDeleteQueries(gsl::narrow<GLsizei>(m_queries.size()),
+                          m_queries.data());
+  }
+  m_queries.clear();
+  m_issued.clear();
+  m_times.clear();
+  m_supported = false;
+  m_frame = 0;
+}
+
+/**
+ * @brief Starts a new frame.
+ *
+ * This reads the results of the frame measured `latency` frames before, if
+ * they are available, and reuses its queries.
+ */
+void abcg::OpenGLGPUTimer::beginFrame() {
+  if (!m_supported)
+    return;
+
+  ++m_frame;
+  if (m_frame > m_latency) {
+    readBack(m_frame - m_latency);
+  }
+  for (auto const scope : iter::range(m_scopeCount)) {
+    m_issued.at(queryIndex(m_frame, scope, 0) / 2) = false;
+  }
+}
+
+/**
+ * @brief Starts measuring a scope of the current frame.
+ *
+ * @param scope Scope index.
+ */
+void abcg::OpenGLGPUTimer::begin(std::size_t scope) {
+  if (!m_supported || m_frame == 0)
+    return;
+
+  auto const index{queryIndex(m_frame, scope, 0)};
+#if defined(__EMSCRIPTEN__)
+  abcg::glBeginQuery(GL_TIME_ELAPSED_EXT, m_queries.at(index));
+#else
+  abcg::glQueryCounter(m_queries.at(index), GL_TIMESTAMP);
+#endif
+  m_issued.at(index / 2) = true;
+}
+
+/**
+ * @brief Stops measuring a scope of the current frame.
+ *
+ * @param scope Scope index.
+ */
+void abcg::OpenGLGPUTimer::end(std::size_t scope) {
+  if (!m_supported || m_frame == 0)
+    return;
+
+#if defined(__EMSCRIPTEN__)
+  abcg::glEndQuery(GL_TIME_ELAPSED_EXT);
+#else
+  abcg::glQueryCounter(m_queries.at(queryIndex(m_frame, scope, 1)),
+                       GL_TIMESTAMP);
+#endif
+}
+
+/**
+ * @brief Returns the last measured GPU time of a scope.
+ *
+ * @param scope Scope index.
+ *
+ * @return Time in milliseconds, measured `latency` or more frames before.
+ */
+double abcg::OpenGLGPUTimer::getTime(std::size_t scope) const {
+  return m_times.at(scope);
+}
+
+// Index of the start (0) or end (1) query of a scope in a frame in flight
+std::size_t abcg::OpenGLGPUTimer::queryIndex(std::uint64_t frame,
+                                             std::size_t scope,
+                                             std::size_t which) const noexcept {
+  auto const slot{gsl::narrow_cast<std::size_t>(frame % m_latency)};
+  return (slot * m_scopeCount + scope) * 2 + which;
+}
+
+// Reads the scopes of a frame whose results are available, without waiting
+void abcg::OpenGLGPUTimer::readBack(std::uint64_t frame) {
+#if defined(__EMSCRIPTEN__)
+  GLint disjoint{};
+  abcg::glGetIntegerv(GL_GPU_DISJOINT_EXT, &disjoint);
+#endif
+
+  for (auto const scope : iter::range(m_scopeCount)) {
+    auto const first{queryIndex(frame, scope, 0)};
+    if (!m_issued.at(first / 2))
+      continue;
+
+#if defined(__EMSCRIPTEN__)
+    auto const last{first};
+#else
+    auto const last{first + 1};
+#endif
+    GLuint available{};
+    abcg::glGetQueryObjectuiv(m_queries.at(last), GL_QUERY_RESULT_AVAILABLE,
+                              &available);
+    if (available != GL_TRUE)
+      continue;
+
+#if defined(__EMSCRIPTEN__)
+    GLuint elapsed{};
+    abcg::glGetQueryObjectuiv(m_queries.at(first), GL_QUERY_RESULT, &elapsed);
+    if (disjoint == 0) {
+      m_times.at(scope) = elapsed / 1.0e6;
+    }
+#else
+    GLuint64 begin{};
+    GLuint64 end{};
+    abcg::glGetQueryObjectui64v(m_queries.at(first), GL_QUERY_RESULT, &begin);
+    abcg::glGetQueryObjectui64v(m_queries.at(last), GL_QUERY_RESULT, &end);
+    m_times.at(scope) = gsl::narrow_cast<double>(end - begin) / 1.0e6;
+#endif
+  }
+}
@@ -0,0 +1,92 @@
+/**
+ * @file abcgOpenGLGPUTimer.hpp
+ * @brief Header file of abcg::OpenGLGPUTimer.
+ *
+ * Declaration of abcg::OpenGLGPUTimer.
+ *
+ * This file is part of ABCg (https://github.com/hbatagelo/abcg).
+ *
+ * @copyright (c) 2021--2022 Harlen Batagelo. All rights reserved.
+ * This project is released under the MIT License.
+ */
+
+#ifndef ABCG_OPENGL_GPU_TIMER_HPP_
+#define ABCG_OPENGL_GPU_TIMER_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "abcgOpenGLExternal.hpp"
+
+namespace abcg {
+class OpenGLGPUTimer;
+} // namespace abcg
+
+/**
+ * @brief Measures the GPU time of scopes of a frame with timer queries.
+ *
+ * Each scope is identified by an index in [0, scopeCount). Results are read
+ * back `latency` frames later, only if they are already available, so the
+ * CPU never waits for the GPU:
+ * @code
+ * m_timer.create(2);
+ * // Each frame:
+ * m_timer.beginFrame();
+ * m_timer.begin(0);
+ * // Draw calls...
+ * m_timer.end(0);
+ * auto const milliseconds{m_timer.getTime(0)};
+ * @endcode
+ *
+ * On desktop OpenGL (3.3+ or `ARB_timer_query`), scopes are measured with
+ * pairs of `GL_TIMESTAMP` queries written by `glQueryCounter`, so they can
+ * be nested. On WebGL 2, they are measured with `GL_TIME_ELAPSED_EXT`
+ * queries of the `EXT_disjoint_timer_query_webgl2` extension, so scopes must
+ * not be nested nor overlap, and results of frames in which the GPU was
+ * disjoint (e.g., after a power state change) are dropped. Without timer
+ * query support, all functions do nothing and the times are zero.
+ */
+class abcg::OpenGLGPUTimer {
+public:
+  OpenGLGPUTimer() = default;
+  OpenGLGPUTimer(OpenGLGPUTimer const &) = delete;
+  OpenGLGPUTimer &operator=(OpenGLGPUTimer const &) = delete;
+  ~OpenGLGPUTimer() = default;
+
+  void create(std::size_t scopeCount, std::size_t latency = 3);
+  void destroy();
+
+  void beginFrame();
+  void begin(std::size_t scope);
+  void end(std::size_t scope);
+
+  [[nodiscard]] double getTime(std::size_t scope) const;
+
+  /**
+   * @brief Whether the context supports timer queries.
+   *
+   * @return `true` if scopes are measured.
+   */
+  [[nodiscard]] bool isSupported() const noexcept { return m_supported; }
+
+private:
+  [[nodiscard]] std::size_t queryIndex(std::uint64_t frame, std::size_t scope,
+                                       std::size_t which) const noexcept;
+  void readBack(std::uint64_t frame);
+
+  bool m_supported{};
+  std::size_t m_scopeCount{};
+  std::size_t m_latency{};
+
+  // Two queries per scope and frame in flight. WebGL only uses the first
+  std::vector<GLuint> m_queries;
+  // Whether each scope of each frame in flight was measured
+  std::vector<bool> m_issued;
+  // Last results, in milliseconds
+  std::vector<double> m_times;
+
+  std::uint64_t m_frame{};
+};
+
+#endif
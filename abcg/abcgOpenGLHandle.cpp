@@ -0,0 +1,99 @@
+/**
+ * @file abcgOpenGLHandle.cpp
+ * @brief Definition of abcg::OpenGLObjectPool members.
+ *
+ * This file is part of ABCg (https://github.com/hbatagelo/abcg).
+ *
+ * @copyright (c) 2021--2022 Harlen Batagelo. All rights reserved.
+ * This project is released under the MIT License.
+ */
+
+#include "abcgOpenGLHandle.hpp"
+
+#include <gsl/gsl>
+
+#include "abcgException.hpp"
+#include "abcgOpenGLFunction.hpp"
+
+/**
+ * @brief Returns the pool of the OpenGL context.
+ *
+ * @return Reference to the pool.
+ */
+abcg::OpenGLObjectPool &abcg::OpenGLObjectPool::getInstance() {
+  static OpenGLObjectPool pool;
+  return pool;
+}
+
+/**
+ * @brief Takes a name from the free list, or creates a new one if the list is
+ * empty.
+ *
+ * @param type Object type.
+ *
+ * @return Object name.
+ *
+ * @throw abcg::RuntimeError if the object could not be created.
+ */
+GLuint abcg::OpenGLObjectPool::acquire(OpenGLObjectType type) {
+  if (auto &freeNames{m_freeNames.at(static_cast<std::size_t>(type))};
+      !freeNames.empty()) {
+    auto const name{freeNames.back()};
+    freeNames.pop_back();
+    ++m_statistics.reuses;
+    return name;
+  }
+
+  GLuint name{};
+  switch (type) {
+  case OpenGLObjectType::Buffer:
+    abcg::glGenBuffers(1, &name);
+    break;
+  case OpenGLObjectType::VertexArray:
+    abcg::glGenVertexArrays(1, &name);
+    break;
+  }
+  if (name == 0) {
+    throw abcg::RuntimeError("Failed to create OpenGL object");
+  }
+  ++m_statistics.allocations;
+  return name;
+}
+
+/**
+ * @brief Returns a name to the free list.
+ *
+ * @param type Object type.
+ * @param name Object name previously returned by
+ * abcg::OpenGLObjectPool::acquire.
+ */
+void abcg::OpenGLObjectPool::release(OpenGLObjectType type, GLuint name) {
+  if (name == 0)
+    return;
+  m_freeNames.at(static_cast<std::size_t>(type)).push_back(name);
+}
+
+/**
+ * @brief Deletes all names of the free lists.
+ *
+ * This must be called while the OpenGL context is current.
+ */
+void abcg::OpenGLObjectPool::clear() {
+  auto &buffers{
+      m_freeNames.at(static_cast<std::size_t>(OpenGLObjectType::Buffer))};
+  if (!buffers.empty()) {
+    abcg::glDeleteBuffers(gsl::narrow<GLsizei>(buffers.size()),
+                          buffers.data());
+    m_statistics.deletions += buffers.size();
+    buffers.clear();
+  }
+
+  auto &vertexArrays{
+      m_freeNames.at(static_cast<std::size_t>(OpenGLObjectType::VertexArray))};
+  if (!vertexArrays.empty()) {
+    abcg::glDeleteVertexArrays(gsl::narrow<GLsizei>(vertexArrays.size()),
+                               vertexArrays.data());
+    m_statistics.deletions += vertexArrays.size();
+    vertexArrays.clear();
+  }
+}
@@ -0,0 +1,180 @@
+/**
+ * @file abcgOpenGLHandle.hpp
+ * @brief Header file of abcg::OpenGLHandle and abcg::OpenGLObjectPool.
+ *
+ * Declaration of RAII wrappers of OpenGL object names and of the pool that
+ * recycles them.
+ *
+ * This file is part of ABCg (https://github.com/hbatagelo/abcg).
+ *
+ * @copyright (c) 2021--2022 Harlen Batagelo. All rights reserved.
+ * This project is released under the MIT License.
+ */
+
+#ifndef ABCG_OPENGL_HANDLE_HPP_
+#define ABCG_OPENGL_HANDLE_HPP_
+
+#include <array>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#include "abcgOpenGLExternal.hpp"
+
+namespace abcg {
+enum class OpenGLObjectType;
+struct OpenGLObjectPoolStatistics;
+class OpenGLObjectPool;
+template <OpenGLObjectType Type> class OpenGLHandle;
+} // namespace abcg
+
+/**
+ * @brief Types of OpenGL objects that can be recycled by
+ * abcg::OpenGLObjectPool.
+ */
+enum class abcg::OpenGLObjectType {
+  /** @brief Buffer object (`glGenBuffers`). */
+  Buffer,
+  /** @brief Vertex array object (`glGenVertexArrays`). */
+  VertexArray
+};
+
+/**
+ * @brief Counters of abcg::OpenGLObjectPool.
+ */
+struct abcg::OpenGLObjectPoolStatistics {
+  /** @brief Number of names created with `glGen*`. */
+  std::size_t allocations{};
+  /** @brief Number of names taken from the pool instead of being created. */
+  std::size_t reuses{};
+  /** @brief Number of names deleted by abcg::OpenGLObjectPool::clear. */
+  std::size_t deletions{};
+};
+
+/**
+ * @brief Pool of OpenGL object names of the current context.
+ *
+ * Names released by abcg::OpenGLHandle are kept in a free list instead of
+ * being deleted, and are handed out again by the next acquisition of the same
+ * type. Thus, objects that are recreated often (e.g., when restarting a game)
+ * do not call `glGen*` and `glDelete*` after the first time.
+ *
+ * Recycled objects keep their state: a buffer keeps its data store, and a
+ * vertex array keeps its attribute setup. They must be set up again after
+ * being acquired.
+ *
+ * abcg::OpenGLWindow deletes all pooled names after
+ * abcg::OpenGLWindow::onDestroy, while the context is still current.
+ */
+class abcg::OpenGLObjectPool {
+public:
+  [[nodiscard]] static OpenGLObjectPool &getInstance();
+
+  [[nodiscard]] GLuint acquire(OpenGLObjectType type);
+  void release(OpenGLObjectType type, GLuint name);
+  void clear();
+
+  /**
+   * @brief Returns the number of names available for reuse.
+   *
+   * @param type Object type.
+   *
+   * @return Number of names in the free list of the type.
+   */
+  [[nodiscard]] std::size_t available(OpenGLObjectType type) const {
+    return m_freeNames.at(static_cast<std::size_t>(type)).size();
+  }
+
+  /**
+   * @brief Returns the counters of the pool.
+   *
+   * @return Reference to the statistics.
+   */
+  [[nodiscard]] OpenGLObjectPoolStatistics const &
+  getStatistics() const noexcept {
+    return m_statistics;
+  }
+
+private:
+  std::array<std::vector<GLuint>, 2> m_freeNames{};
+  OpenGLObjectPoolStatistics m_statistics{};
+};
+
+/**
+ * @brief Move-only owner of an OpenGL object name.
+ *
+ * The name is acquired from abcg::OpenGLObjectPool and returned to it when the
+ * handle is reset or destroyed:
+ * @code
+ * m_VBO = abcg::OpenGLBuffer::acquire();
+ * abcg::glBindBuffer(GL_ARRAY_BUFFER, m_VBO.get());
+ * // ...
+ * m_VBO.reset(); // Or let the handle go out of scope
+ * @endcode
+ *
+ * Handles must be reset while the OpenGL context is current, e.g., in
+ * abcg::OpenGLWindow::onDestroy.
+ *
+ * @tparam Type Object type.
+ */
+template <abcg::OpenGLObjectType Type> class abcg::OpenGLHandle {
+public:
+  OpenGLHandle() = default;
+  OpenGLHandle(OpenGLHandle const &) = delete;
+  OpenGLHandle &operator=(OpenGLHandle const &) = delete;
+  OpenGLHandle(OpenGLHandle &&other) noexcept
+      : m_name{std::exchange(other.m_name, 0)} {}
+  OpenGLHandle &operator=(OpenGLHandle &&other) noexcept {
+    if (this != &other) {
+      reset();
+      m_name = std::exchange(other.m_name, 0);
+    }
+    return *this;
+  }
+  ~OpenGLHandle() { reset(); }
+
+  /**
+   * @brief Acquires a name from the pool.
+   *
+   * @return Handle that owns the name.
+   */
+  [[nodiscard]] static OpenGLHandle acquire() {
+    return OpenGLHandle{OpenGLObjectPool::getInstance().acquire(Type)};
+  }
+
+  /**
+   * @brief Returns the name to the pool, if any.
+   */
+  void reset() {
+    if (m_name != 0) {
+      OpenGLObjectPool::getInstance().release(Type, m_name);
+      m_name = 0;
+    }
+  }
+
+  /**
+   * @brief Returns the object name.
+   *
+   * @return Object name, or 0 if the handle is empty.
+   */
+  [[nodiscard]] GLuint get() const noexcept { return m_name; }
+
+  /**
+   * @brief Whether the handle owns a name.
+   */
+  explicit operator bool() const noexcept { return m_name != 0; }
+
+private:
+  explicit OpenGLHandle(GLuint name) noexcept : m_name{name} {}
+
+  GLuint m_name{};
+};
+
+namespace abcg {
+/** @brief Pooled buffer object. */
+using OpenGLBuffer = OpenGLHandle<OpenGLObjectType::Buffer>;
+/** @brief Pooled vertex array object. */
+using OpenGLVertexArray = OpenGLHandle<OpenGLObjectType::VertexArray>;
+} // namespace abcg
+
+#endif
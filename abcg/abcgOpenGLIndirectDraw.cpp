@@ -0,0 +1,340 @@
+/**
+ * @file abcgOpenGLIndirectDraw.cpp
+ * @brief Definition of abcg::OpenGLIndirectDrawBuilder members.
+ *
+ * This file is part of ABCg (https://github.com/hbatagelo/abcg).
+ *
+ * @copyright (c) 2021--2022 Harlen Batagelo. All rights reserved.
+ * This project is released under the MIT License.
+ */
+
+#include "abcgOpenGLIndirectDraw.hpp"
+
+#include <cstring>
+#include <string_view>
+
+#include <cppitertools/itertools.hpp>
+#include <gsl/gsl>
+
+#include "abcgException.hpp"
+#include "abcgOpenGLFunction.hpp"
+#include "abcgOpenGLUniformBuffer.hpp"
+
+namespace {
+
+// Whether the current context supports glMultiDrawElementsIndirect with
+// shader storage buffers, i.e., whether it is a desktop OpenGL 4.3+ context
+[[nodiscard]] bool queryMultiDrawSupport() {
+#if defined(__EMSCRIPTEN__)
+  return false;
+#else
+  auto const *version{
+      reinterpret_cast<char const *>(abcg::glGetString(GL_VERSION))};
+  if (version == nullptr || std::string_view{version}.starts_with("OpenGL ES"))
+    return false;
+  GLint major{};
+  GLint minor{};
+  abcg::glGetIntegerv(GL_MAJOR_VERSION, &major);
+  abcg::glGetIntegerv(GL_MINOR_VERSION, &minor);
+  return major > 4 || (major == 4 && minor >= 3);
+#endif
+}
+
+// Offset in bytes as a pointer argument of buffer-backed OpenGL functions
+[[nodiscard]] void const *bufferOffset(std::size_t offset) {
+  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast,performance-no-int-to-ptr)
+  return reinterpret_cast<void const *>(offset);
+}
+
+} // namespace
+
+/**
+ * @brief Creates the buffers and the vertex array object.
+ *
+ * This must be called after the OpenGL context is created, e.g., in
+ * abcg::OpenGLWindow::onCreate.
+ *
+ * @param createInfo Configuration settings.
+ */
+void abcg::OpenGLIndirectDrawBuilder::create(
+    OpenGLIndirectDrawCreateInfo const &createInfo) {
+  destroy();
+
+  m_createInfo = createInfo;
+  m_multiDrawSupported = queryMultiDrawSupport();
+
+  // Ranges of uniform buffers must start at multiples of the offset alignment
+  m_uniformStride = getUniformBufferStride(createInfo.drawDataSize);
+
+  abcg::glGenVertexArrays(1, &m_VAO);
+  abcg::glGenBuffers(1, &m_VBO);
+  abcg::glGenBuffers(1, &m_EBO);
+  abcg::glGenBuffers(1, &m_drawIDBuffer);
+  abcg::glGenBuffers(1, &m_commandBuffer);
+  abcg::glGenBuffers(1, &m_drawDataBuffer);
+
+  abcg::glBindVertexArray(m_VAO);
+
+  abcg::glBindBuffer(GL_ARRAY_BUFFER, m_VBO);
+  abcg::glEnableVertexAttribArray(0);
+  abcg::glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex),
+                              bufferOffset(offsetof(Vertex, position)));
+  abcg::glEnableVertexAttribArray(1);
+  abcg::glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex),
+                              bufferOffset(offsetof(Vertex, normal)));
+  abcg::glEnableVertexAttribArray(2);
+  abcg::glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex),
+                              bufferOffset(offsetof(Vertex, texCoord)));
+
+  // In the multi-draw path, the draw index is an instanced attribute read at
+  // the base instance of each command. In the fallback path, it is a constant
+  // attribute value set before each draw.
+  if (m_multiDrawSupported) {
+    abcg::glBindBuffer(GL_ARRAY_BUFFER, m_drawIDBuffer);
+    abcg::glEnableVertexAttribArray(createInfo.drawIDLocation);
+    abcg::glVertexAttribIPointer(createInfo.drawIDLocation, 1,
+                                 GL_UNSIGNED_INT, 0, nullptr);
+    abcg::glVertexAttribDivisor(createInfo.drawIDLocation, 1);
+  }
+
+  abcg::glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_EBO);
+
+  abcg::glBindVertexArray(0);
+  abcg::glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+/**
+ * @brief Releases the OpenGL resources and clears the meshes and draws.
+ */
+void abcg::OpenGLIndirectDrawBuilder::destroy() {
+  if (m_VAO != 0) {
+    abcg::glDeleteBuffers(1, &m_drawDataBuffer);
+    abcg::glDeleteBuffers(1, &m_commandBuffer);
+    abcg::glDeleteBuffers(1, &m_drawIDBuffer);
+    abcg::glDeleteBuffers(1, &m_EBO);
+    abcg::glDeleteBuffers(1, &m_VBO);
+    abcg::glDeleteVertexArrays(1, &m_VAO);
+  }
+  m_VAO = m_VBO = m_EBO = 0;
+  m_drawIDBuffer = m_commandBuffer = m_drawDataBuffer = 0;
+
+  m_vertices.clear();
+  m_indices.clear();
+  m_meshes.clear();
+  clearDraws();
+}
+
+/**
+ * @brief Appends a mesh to the shared vertex and index buffers.
+ *
+ * The mesh is only available for drawing after
+ * abcg::OpenGLIndirectDrawBuilder::uploadMeshes is called.
+ *
+ * @param vertices Vertices of the mesh.
+ * @param indices Triangle list indices of the mesh.
+ *
+ * @return Mesh index to be used in abcg::OpenGLIndirectDrawBuilder::addDraw.
+ */
+std::uint32_t abcg::OpenGLIndirectDrawBuilder::addMesh(
+    std::span<Vertex const> vertices, std::span<std::uint32_t const> indices) {
+  auto const baseVertex{gsl::narrow<std::uint32_t>(m_vertices.size())};
+  m_meshes.push_back({.firstIndex = gsl::narrow<GLuint>(m_indices.size()),
+                      .indexCount = gsl::narrow<GLuint>(indices.size())});
+
+  m_vertices.insert(m_vertices.end(), vertices.begin(), vertices.end());
+  m_indices.reserve(m_indices.size() + indices.size());
+  for (auto const index : indices) {
+    m_indices.push_back(baseVertex + index);
+  }
+
+  return gsl::narrow<std::uint32_t>(m_meshes.size() - 1);
+}
+
+/**
+ * @brief Appends all levels of detail of an abcg::Mesh to the shared vertex
+ * and index buffers.
+ *
+ * The vertices are appended once, and each level of detail gets its own range
+ * of indices into them. Level `lod` (e.g., the one returned by
+ * abcg::Mesh::selectLOD) is drawn with the returned index plus `lod`.
+ *
+ * @param mesh Loaded mesh.
+ *
+ * @return Mesh index of the full-detail level, to be used in
+ * abcg::OpenGLIndirectDrawBuilder::addDraw.
+ */
+std::uint32_t abcg::OpenGLIndirectDrawBuilder::addMesh(Mesh const &mesh) {
+  auto const baseVertex{gsl::narrow<std::uint32_t>(m_vertices.size())};
+  auto const vertices{mesh.getVertices()};
+  m_vertices.insert(m_vertices.end(), vertices.begin(), vertices.end());
+
+  auto const lods{mesh.getLODs()};
+  std::size_t indexCount{};
+  for (auto const &lod : lods) {
+    indexCount += lod.indexCount;
+  }
+  m_indices.reserve(m_indices.size() + indexCount);
+
+  auto const firstMesh{gsl::narrow<std::uint32_t>(m_meshes.size())};
+  for (auto const &lod : lods) {
+    m_meshes.push_back({.firstIndex = gsl::narrow<GLuint>(m_indices.size()),
+                        .indexCount = lod.indexCount});
+    for (auto const position : iter::range(lod.indexCount)) {
+      m_indices.push_back(baseVertex +
+                          mesh.getIndex(lod.firstIndex + position));
+    }
+  }
+  return firstMesh;
+}
+
+/**
+ * @brief Uploads the shared vertex and index buffers.
+ *
+ * Call this after adding the meshes. The CPU copy of the geometry is kept so
+ * that more meshes can be added and uploaded later.
+ */
+void abcg::OpenGLIndirectDrawBuilder::uploadMeshes() {
+  abcg::glBindBuffer(GL_ARRAY_BUFFER, m_VBO);
+  abcg::glBufferData(
+      GL_ARRAY_BUFFER,
+      gsl::narrow<GLsizeiptr>(m_vertices.size() * sizeof(Vertex)),
+      m_vertices.data(), GL_STATIC_DRAW);
+  abcg::glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+  // The element array buffer binding is part of the vertex array state
+  abcg::glBindVertexArray(m_VAO);
+  abcg::glBufferData(
+      GL_ELEMENT_ARRAY_BUFFER,
+      gsl::narrow<GLsizeiptr>(m_indices.size() * sizeof(std::uint32_t)),
+      m_indices.data(), GL_STATIC_DRAW);
+  abcg::glBindVertexArray(0);
+}
+
+/**
+ * @brief Removes all draws. Call this at the beginning of each frame.
+ */
+void abcg::OpenGLIndirectDrawBuilder::clearDraws() {
+  m_commands.clear();
+  m_drawData.clear();
+  m_drawIDs.clear();
+}
+
+/**
+ * @brief Adds a draw of a mesh.
+ *
+ * @param mesh Mesh index returned by
+ * abcg::OpenGLIndirectDrawBuilder::addMesh.
+ * @param drawData Per-draw data. Its size must be equal to
+ * abcg::OpenGLIndirectDrawCreateInfo::drawDataSize.
+ * @param instanceCount Number of instances.
+ *
+ * @throw abcg::RuntimeError if the size of the per-draw data is not valid.
+ */
+void abcg::OpenGLIndirectDrawBuilder::addDraw(
+    std::uint32_t mesh, std::span<std::byte const> drawData,
+    GLuint instanceCount) {
+  if (drawData.size() != m_createInfo.drawDataSize) {
+    throw abcg::RuntimeError("Invalid size of per-draw data");
+  }
+
+  auto const &range{m_meshes.at(mesh)};
+  auto const drawIndex{gsl::narrow<GLuint>(m_commands.size())};
+
+  m_commands.push_back(
+      {.count = range.indexCount,
+       .instanceCount = instanceCount,
+       .firstIndex = range.firstIndex,
+       .baseVertex = 0,
+       .baseInstance = gsl::narrow<GLuint>(m_drawIDs.size())});
+
+  // Each instance of the draw reads the same draw index
+  m_drawIDs.insert(m_drawIDs.end(), instanceCount, drawIndex);
+
+  auto const stride{m_multiDrawSupported ? m_createInfo.drawDataSize
+                                         : m_uniformStride};
+  auto const offset{m_drawData.size()};
+  m_drawData.resize(offset + stride);
+  std::memcpy(&m_drawData.at(offset), drawData.data(), drawData.size());
+}
+
+/**
+ * @brief Draws all draws added since the last call to
+ * abcg::OpenGLIndirectDrawBuilder::clearDraws.
+ *
+ * The program must be in use. The vertex array object and the buffer of
+ * per-draw data are bound during the call.
+ */
+void abcg::OpenGLIndirectDrawBuilder::draw() {
+  if (m_commands.empty())
+    return;
+
+  if (!m_multiDrawSupported) {
+    drawFallback();
+    return;
+  }
+
+#if !defined(__EMSCRIPTEN__)
+  // Orphan and refill the per-frame buffers
+  abcg::glBindBuffer(GL_ARRAY_BUFFER, m_drawIDBuffer);
+  abcg::glBufferData(GL_ARRAY_BUFFER,
+                     gsl::narrow<GLsizeiptr>(m_drawIDs.size() * sizeof(GLuint)),
+                     m_drawIDs.data(), GL_STREAM_DRAW);
+  abcg::glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+  abcg::glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_drawDataBuffer);
+  abcg::glBufferData(GL_SHADER_STORAGE_BUFFER,
+                     gsl::narrow<GLsizeiptr>(m_drawData.size()),
+                     m_drawData.data(), GL_STREAM_DRAW);
+  abcg::glBindBufferBase(GL_SHADER_STORAGE_BUFFER,
+                         m_createInfo.drawDataBinding, m_drawDataBuffer);
+
+  abcg::glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_commandBuffer);
+  abcg::glBufferData(
+      GL_DRAW_INDIRECT_BUFFER,
+      gsl::narrow<GLsizeiptr>(m_commands.size() *
+                              sizeof(OpenGLDrawElementsIndirectCommand)),
+      m_commands.data(), GL_STREAM_DRAW);
+
+  abcg::glBindVertexArray(m_VAO);
+  abcg::glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, nullptr,
+                                    gsl::narrow<GLsizei>(m_commands.size()),
+                                    0);
+  abcg::glBindVertexArray(0);
+
+  abcg::glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+  abcg::glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+#endif
+}
+
+// One draw call per command, with the per-draw data bound as a range of a
+// uniform buffer
+void abcg::OpenGLIndirectDrawBuilder::drawFallback() {
+  abcg::glBindBuffer(GL_UNIFORM_BUFFER, m_drawDataBuffer);
+  abcg::glBufferData(GL_UNIFORM_BUFFER,
+                     gsl::narrow<GLsizeiptr>(m_drawData.size()),
+                     m_drawData.data(), GL_STREAM_DRAW);
+
+  abcg::glBindVertexArray(m_VAO);
+  for (auto &&[drawIndex, command] : iter::enumerate(m_commands)) {
+    abcg::glBindBufferRange(
+        GL_UNIFORM_BUFFER, m_createInfo.drawDataBinding, m_drawDataBuffer,
+        gsl::narrow<GLintptr>(drawIndex * m_uniformStride),
+        gsl::narrow<GLsizeiptr>(m_createInfo.drawDataSize));
+    abcg::glVertexAttribI4ui(m_createInfo.drawIDLocation,
+                             gsl::narrow<GLuint>(drawIndex), 0, 0, 0);
+
+    auto const *indices{
+        bufferOffset(command.firstIndex * sizeof(std::uint32_t))};
+    auto const count{gsl::narrow<GLsizei>(command.count)};
+    if (command.instanceCount == 1) {
+      abcg::glDrawElements(GL_TRIANGLES, count, GL_UNSIGNED_INT, indices);
+    } else {
+      abcg::glDrawElementsInstanced(
+          GL_TRIANGLES, count, GL_UNSIGNED_INT, indices,
+          gsl::narrow<GLsizei>(command.instanceCount));
+    }
+  }
+  abcg::glBindVertexArray(0);
+
+  abcg::glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
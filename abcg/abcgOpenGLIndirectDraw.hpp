@@ -0,0 +1,193 @@
+/**
+ * @file abcgOpenGLIndirectDraw.hpp
+ * @brief Header file of abcg::OpenGLIndirectDrawBuilder.
+ *
+ * Declaration of abcg::OpenGLIndirectDrawBuilder and related structures.
+ *
+ * This file is part of ABCg (https://github.com/hbatagelo/abcg).
+ *
+ * @copyright (c) 2021--2022 Harlen Batagelo. All rights reserved.
+ * This project is released under the MIT License.
+ */
+
+#ifndef ABCG_OPENGL_INDIRECT_DRAW_HPP_
+#define ABCG_OPENGL_INDIRECT_DRAW_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+#include "abcgMesh.hpp"
+#include "abcgOpenGLExternal.hpp"
+
+namespace abcg {
+struct OpenGLIndirectDrawCreateInfo;
+struct OpenGLDrawElementsIndirectCommand;
+class OpenGLIndirectDrawBuilder;
+} // namespace abcg
+
+/**
+ * @brief Configuration settings of abcg::OpenGLIndirectDrawBuilder.
+ */
+struct abcg::OpenGLIndirectDrawCreateInfo {
+  /** @brief Size in bytes of the per-draw data (e.g., a model matrix and a
+   * color). It must match the size of the structure declared in the shader. */
+  std::size_t drawDataSize{};
+  /** @brief Binding point of the shader storage block (multi-draw path) or
+   * uniform block (fallback path) that holds the per-draw data. */
+  GLuint drawDataBinding{0};
+  /** @brief Location of the `uint` vertex attribute that receives the index of
+   * the draw. */
+  GLuint drawIDLocation{3};
+};
+
+/**
+ * @brief Layout of the commands read by `glMultiDrawElementsIndirect`.
+ */
+struct abcg::OpenGLDrawElementsIndirectCommand {
+  /** @brief Number of indices. */
+  GLuint count{};
+  /** @brief Number of instances. */
+  GLuint instanceCount{};
+  /** @brief Position of the first index in the shared index buffer. */
+  GLuint firstIndex{};
+  /** @brief Value added to the indices. This is always zero as the indices
+   * of the shared index buffer are already offset to the shared vertex
+   * buffer. */
+  GLint baseVertex{};
+  /** @brief First element read from instanced vertex attributes. */
+  GLuint baseInstance{};
+};
+
+/**
+ * @brief Builds and submits batches of indexed draws of many meshes.
+ *
+ * Meshes are packed into a single vertex buffer and a single index buffer
+ * bound to one vertex array object. Vertices use the layout of abcg::Vertex,
+ * with the position, normal and texture coordinates at attribute locations 0,
+ * 1 and 2.
+ *
+ * Each frame, the draws of the visible set are added with their per-draw data
+ * and submitted with abcg::OpenGLIndirectDrawBuilder::draw:
+ *
+ * - On OpenGL 4.3 or later, the draw commands are uploaded to a
+ * `GL_DRAW_INDIRECT_BUFFER` and the per-draw data to a shader storage buffer,
+ * and everything is drawn with a single call to `glMultiDrawElementsIndirect`.
+ * The CPU cost of the submission does not depend on the number of draws.
+ * - On OpenGL ES, WebGL and older desktop contexts, the draws are issued in a
+ * loop, and the per-draw data of each draw is bound as a range of a uniform
+ * buffer.
+ *
+ * In both paths, the vertex attribute at
+ * abcg::OpenGLIndirectDrawCreateInfo::drawIDLocation receives the index of the
+ * draw. In the multi-draw path, the shader reads the per-draw data as follows:
+ * @code
+ * layout(location = 3) in uint inDrawID;
+ * struct DrawData { mat4 modelMatrix; vec4 color; };
+ * layout(std430, binding = 0) readonly buffer DrawDataBuffer {
+ *   DrawData drawData[];
+ * };
+ * // ... drawData[inDrawID].modelMatrix ...
+ * @endcode
+ * In the fallback path, the same data is declared as a uniform block bound to
+ * abcg::OpenGLIndirectDrawCreateInfo::drawDataBinding:
+ * @code
+ * layout(std140) uniform DrawData { mat4 modelMatrix; vec4 color; } drawData;
+ * @endcode
+ * Use abcg::OpenGLIndirectDrawBuilder::isMultiDrawSupported to choose the
+ * shader.
+ */
+class abcg::OpenGLIndirectDrawBuilder {
+public:
+  void create(OpenGLIndirectDrawCreateInfo const &createInfo);
+  void destroy();
+
+  [[nodiscard]] std::uint32_t addMesh(std::span<Vertex const> vertices,
+                                      std::span<std::uint32_t const> indices);
+  [[nodiscard]] std::uint32_t addMesh(Mesh const &mesh);
+  void uploadMeshes();
+
+  void clearDraws();
+  void addDraw(std::uint32_t mesh, std::span<std::byte const> drawData,
+               GLuint instanceCount = 1);
+
+  /**
+   * @brief Adds a draw of a mesh.
+   *
+   * @tparam T Type of the per-draw data. Its size must be equal to
+   * abcg::OpenGLIndirectDrawCreateInfo::drawDataSize.
+   *
+   * @param mesh Mesh index returned by
+   * abcg::OpenGLIndirectDrawBuilder::addMesh.
+   * @param drawData Per-draw data.
+   * @param instanceCount Number of instances.
+   */
+  template <typename T>
+  void addDraw(std::uint32_t mesh, T const &drawData,
+               GLuint instanceCount = 1) {
+    static_assert(std::is_trivially_copyable_v<T>);
+    addDraw(mesh, std::as_bytes(std::span{&drawData, 1}), instanceCount);
+  }
+
+  void draw();
+
+  /**
+   * @brief Returns whether draws are submitted with a single multi-draw call.
+   *
+   * @return `true` if the context supports `glMultiDrawElementsIndirect` and
+   * shader storage buffers; `false` if the fallback path is used.
+   */
+  [[nodiscard]] bool isMultiDrawSupported() const noexcept {
+    return m_multiDrawSupported;
+  }
+
+  /**
+   * @brief Returns the number of draws added since the last call to
+   * abcg::OpenGLIndirectDrawBuilder::clearDraws.
+   *
+   * @return Number of draws.
+   */
+  [[nodiscard]] std::size_t getDrawCount() const noexcept {
+    return m_commands.size();
+  }
+
+  /**
+   * @brief Returns the vertex array object of the shared buffers.
+   *
+   * @return Vertex array object.
+   */
+  [[nodiscard]] GLuint getVertexArray() const noexcept { return m_VAO; }
+
+private:
+  struct MeshRange {
+    GLuint firstIndex{};
+    GLuint indexCount{};
+  };
+
+  void drawFallback();
+
+  OpenGLIndirectDrawCreateInfo m_createInfo{};
+  bool m_multiDrawSupported{};
+  std::size_t m_uniformStride{};
+
+  // Shared geometry
+  std::vector<Vertex> m_vertices;
+  std::vector<std::uint32_t> m_indices;
+  std::vector<MeshRange> m_meshes;
+
+  // Draws of the current frame
+  std::vector<OpenGLDrawElementsIndirectCommand> m_commands;
+  std::vector<std::byte> m_drawData;
+  std::vector<GLuint> m_drawIDs;
+
+  GLuint m_VAO{};
+  GLuint m_VBO{};
+  GLuint m_EBO{};
+  GLuint m_drawIDBuffer{};
+  GLuint m_commandBuffer{};
+  GLuint m_drawDataBuffer{};
+};
+
+#endif
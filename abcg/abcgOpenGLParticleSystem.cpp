@@ -0,0 +1,553 @@
+/**
+ * @file abcgOpenGLParticleSystem.cpp
+ * @brief Definition of abcg::OpenGLParticleSystem members.
+ *
+ * This file is part of ABCg (https://github.com/hbatagelo/abcg).
+ *
+ * @copyright (c) 2021--2022 Harlen Batagelo. All rights reserved.
+ * This project is released under the MIT License.
+ */
+
+#include "abcgOpenGLParticleSystem.hpp"
+
+#include <algorithm>
+#include <cstddef>
+
+#include <cppitertools/itertools.hpp>
+#include <glm/geometric.hpp>
+#include <gsl/gsl>
+
+#include "abcgOpenGLFunction.hpp"
+#include "abcgOpenGLShader.hpp"
+#include "abcgTimer.hpp"
+
+namespace {
+
+// Integrates live particles and copies dead ones through unchanged
+char const *const updateVertexShader{R"glsl(#version 300 es
+
+layout(location = 0) in vec4 inPositionAge;
+layout(location = 1) in vec4 inVelocityLifetime;
+layout(location = 2) in vec4 inColor;
+layout(location = 3) in float inSize;
+
+uniform float deltaTime;
+uniform float damping;
+uniform vec3 acceleration;
+
+out vec4 outPositionAge;
+out vec4 outVelocityLifetime;
+out vec4 outColor;
+out float outSize;
+
+void main() {
+  outPositionAge = inPositionAge;
+  outVelocityLifetime = inVelocityLifetime;
+  outColor = inColor;
+  outSize = inSize;
+
+  if (inPositionAge.w < inVelocityLifetime.w) {
+    vec3 velocity = inVelocityLifetime.xyz * damping + acceleration * deltaTime;
+    outPositionAge = vec4(inPositionAge.xyz + velocity * deltaTime,
+                          inPositionAge.w + deltaTime);
+    outVelocityLifetime.xyz = velocity;
+  }
+}
+)glsl"};
+
+// Required to link the update program in OpenGL ES; never executed
+char const *const updateFragmentShader{R"glsl(#version 300 es
+
+precision mediump float;
+
+out vec4 outColor;
+
+void main() { outColor = vec4(0); }
+)glsl"};
+
+char const *const renderVertexShader{R"glsl(#version 300 es
+
+layout(location = 0) in vec4 inPositionAge;
+layout(location = 1) in vec4 inVelocityLifetime;
+layout(location = 2) in vec4 inColor;
+layout(location = 3) in float inSize;
+
+uniform mat4 viewProjection;
+
+out vec4 fragColor;
+
+void main() {
+  if (inPositionAge.w >= inVelocityLifetime.w) {
+    // Dead particle: move it outside the clip volume
+    gl_Position = vec4(2, 2, 2, 1);
+    gl_PointSize = 0.0;
+    fragColor = vec4(0);
+    return;
+  }
+
+  float t = inPositionAge.w / inVelocityLifetime.w;
+  gl_Position = viewProjection * vec4(inPositionAge.xyz, 1);
+  gl_PointSize = inSize;
+  fragColor = vec4(inColor.rgb, inColor.a * (1.0 - t));
+}
+)glsl"};
+
+char const *const renderFragmentShader{R"glsl(#version 300 es
+
+precision mediump float;
+
+in vec4 fragColor;
+
+out vec4 outColor;
+
+void main() {
+  float distance = length(gl_PointCoord - vec2(0.5)) * 2.0;
+  if (distance > 1.0) discard;
+  outColor = vec4(fragColor.rgb, fragColor.a * (1.0 - distance * distance));
+}
+)glsl"};
+
+// Offset in bytes as a pointer argument of buffer-backed OpenGL functions
+[[nodiscard]] void const *bufferOffset(std::size_t offset) {
+  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast,performance-no-int-to-ptr)
+  return reinterpret_cast<void const *>(offset);
+}
+
+template <typename T>
+void moveElement(std::vector<T> &elements, std::size_t from, std::size_t to) {
+  elements[to] = elements[from];
+}
+
+// Links a program whose vertex shader outputs are captured with transform
+// feedback. The varyings must be set before linking, which is why
+// abcg::createOpenGLProgram cannot be used
+[[nodiscard]] GLuint
+createTransformFeedbackProgram(std::vector<char const *> const &varyings) {
+  auto const shaders{abcg::triggerOpenGLShaderCompile(
+      {{.source = updateVertexShader, .stage = abcg::ShaderStage::Vertex},
+       {.source = updateFragmentShader,
+        .stage = abcg::ShaderStage::Fragment}})};
+  (void)abcg::checkOpenGLShaderCompile(shaders);
+
+  auto const program{abcg::glCreateProgram()};
+  for (auto const &shader : shaders) {
+    abcg::glAttachShader(program, shader.shader);
+  }
+  abcg::glTransformFeedbackVaryings(program,
+                                    gsl::narrow<GLsizei>(varyings.size()),
+                                    varyings.data(), GL_INTERLEAVED_ATTRIBS);
+  abcg::glLinkProgram(program);
+  for (auto const &shader : shaders) {
+    abcg::glDetachShader(program, shader.shader);
+    abcg::glDeleteShader(shader.shader);
+  }
+  (void)abcg::checkOpenGLShaderLink(program);
+
+  return program;
+}
+
+} // namespace
+
+/**
+ * @brief Creates the buffers and programs of the particle system.
+ *
+ * @param createInfo Creation info structure.
+ *
+ * @throw abcg::RuntimeError if the programs could not be built.
+ *
+ * @remark `GL_PROGRAM_POINT_SIZE` must be enabled on desktop OpenGL for the
+ * point size to take effect.
+ */
+void abcg::OpenGLParticleSystem::create(
+    OpenGLParticleSystemCreateInfo const &createInfo) {
+  // Must match the stride of the interleaved transform feedback varyings
+  static_assert(sizeof(Particle) == 13 * sizeof(float));
+
+  destroy();
+
+  m_createInfo = createInfo;
+  m_randomEngine.seed(createInfo.seed);
+
+  m_renderProgram = abcg::createOpenGLProgram(
+      {{.source = renderVertexShader, .stage = ShaderStage::Vertex},
+       {.source = renderFragmentShader, .stage = ShaderStage::Fragment}});
+
+  auto const capacity{createInfo.capacity};
+  auto const bufferSize{gsl::narrow<GLsizeiptr>(capacity * sizeof(Particle))};
+
+  if (createInfo.backend == ParticleBackend::CPU) {
+    for (auto *array :
+         {&m_arrays.positionX, &m_arrays.positionY, &m_arrays.positionZ,
+          &m_arrays.velocityX, &m_arrays.velocityY, &m_arrays.velocityZ,
+          &m_arrays.age, &m_arrays.lifetime, &m_arrays.size}) {
+      array->resize(capacity);
+    }
+    m_arrays.color.resize(capacity);
+    m_staging.resize(capacity);
+
+    m_streamBuffer = OpenGLBuffer::acquire();
+    abcg::glBindBuffer(GL_ARRAY_BUFFER, m_streamBuffer.get());
+    abcg::glBufferData(GL_ARRAY_BUFFER, bufferSize, nullptr, GL_STREAM_DRAW);
+    abcg::glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    setupVertexArray(m_streamVAO, m_streamBuffer);
+    return;
+  }
+
+  m_updateProgram = OpenGLProgram{createTransformFeedbackProgram(
+      {"outPositionAge", "outVelocityLifetime", "outColor", "outSize"})};
+
+  // Zeroed particles have age equal to lifetime, i.e., they are dead
+  std::vector<Particle> const particles(capacity);
+  for (auto &&[buffer, vertexArray] : iter::zip(m_buffers, m_VAOs)) {
+    buffer = OpenGLBuffer::acquire();
+    abcg::glBindBuffer(GL_ARRAY_BUFFER, buffer.get());
+    abcg::glBufferData(GL_ARRAY_BUFFER, bufferSize, particles.data(),
+                       GL_DYNAMIC_COPY);
+    abcg::glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    setupVertexArray(vertexArray, buffer);
+  }
+
+#if !defined(__EMSCRIPTEN__)
+  abcg::glGenQueries(gsl::narrow<GLsizei>(m_queries.size()), m_queries.data());
+#endif
+}
+
+/**
+ * @brief Releases the buffers and programs of the particle system.
+ */
+void abcg::OpenGLParticleSystem::destroy() {
+  if (m_renderProgram != 0) {
+    abcg::glDeleteProgram(m_renderProgram);
+    m_renderProgram = {};
+  }
+  if (m_updateProgram != 0) {
+    abcg::glDeleteProgram(m_updateProgram);
+    m_updateProgram = {};
+  }
+  if (m_queries.front() != 0) {
+    abcg::glDeleteQueries(gsl::narrow<GLsizei>(m_queries.size()),
+                          m_queries.data());
+    m_queries.fill(0);
+  }
+
+  m_streamVAO.reset();
+  m_streamBuffer.reset();
+  for (auto &&[buffer, vertexArray] : iter::zip(m_buffers, m_VAOs)) {
+    vertexArray.reset();
+    buffer.reset();
+  }
+
+  m_arrays = {};
+  m_staging.clear();
+  m_pending.clear();
+  m_batches.clear();
+  m_liveCount = 0;
+  m_batchCount = 0;
+  m_source = 0;
+  m_ringCursor = 0;
+  m_queryFrame = 0;
+  m_time = 0;
+  m_simulationTime = 0;
+}
+
+/**
+ * @brief Emits a burst of particles.
+ *
+ * With the CPU backend, particles that do not fit in the remaining capacity
+ * are dropped. With the GPU backend, they replace the oldest particles.
+ *
+ * @param emitInfo Description of the burst.
+ */
+void abcg::OpenGLParticleSystem::emit(ParticleEmitInfo const &emitInfo) {
+  auto const capacity{m_createInfo.capacity};
+
+  if (m_createInfo.backend == ParticleBackend::CPU) {
+    auto const count{std::min(emitInfo.count, capacity - m_liveCount)};
+    for ([[maybe_unused]] auto const unused : iter::range(count)) {
+      auto const particle{makeParticle(emitInfo)};
+      auto const index{m_liveCount++};
+      m_arrays.positionX[index] = particle.positionAge.x;
+      m_arrays.positionY[index] = particle.positionAge.y;
+      m_arrays.positionZ[index] = particle.positionAge.z;
+      m_arrays.velocityX[index] = particle.velocityLifetime.x;
+      m_arrays.velocityY[index] = particle.velocityLifetime.y;
+      m_arrays.velocityZ[index] = particle.velocityLifetime.z;
+      m_arrays.age[index] = 0.0f;
+      m_arrays.lifetime[index] = particle.velocityLifetime.w;
+      m_arrays.size[index] = particle.size;
+      m_arrays.color[index] = particle.color;
+    }
+    return;
+  }
+
+  auto const count{std::min(emitInfo.count, capacity)};
+  for ([[maybe_unused]] auto const unused : iter::range(count)) {
+    m_pending.push_back(makeParticle(emitInfo));
+  }
+  m_batches.emplace_back(m_time + emitInfo.lifetime, count);
+  m_batchCount += count;
+}
+
+/**
+ * @brief Advances the simulation.
+ *
+ * @param deltaTime Time step in seconds.
+ */
+void abcg::OpenGLParticleSystem::update(float deltaTime) {
+  if (m_createInfo.backend == ParticleBackend::CPU) {
+    updateCPU(deltaTime);
+  } else {
+    updateGPU(deltaTime);
+  }
+}
+
+/**
+ * @brief Draws the live particles as point sprites with additive blending.
+ *
+ * @param viewProjection Transform from world space to clip space.
+ */
+void abcg::OpenGLParticleSystem::render(
+    glm::mat4 const &viewProjection) const {
+  auto const cpu{m_createInfo.backend == ParticleBackend::CPU};
+  auto const count{cpu ? m_liveCount : m_createInfo.capacity};
+  if (count == 0 || m_renderProgram == 0)
+    return;
+
+  abcg::glUseProgram(m_renderProgram);
+  abcg::glUniformMatrix4fv(
+      m_renderProgram.getUniformLocation("viewProjection"), 1, GL_FALSE,
+      &viewProjection[0][0]);
+
+  abcg::glEnable(GL_BLEND);
+  abcg::glBlendFunc(GL_SRC_ALPHA, GL_ONE);
+
+  abcg::glBindVertexArray(cpu ? m_streamVAO.get() : m_VAOs.at(m_source).get());
+  abcg::glDrawArrays(GL_POINTS, 0, gsl::narrow<GLsizei>(count));
+  abcg::glBindVertexArray(0);
+
+  abcg::glDisable(GL_BLEND);
+  abcg::glUseProgram(0);
+}
+
+/**
+ * @brief Returns the number of live particles.
+ *
+ * @return Exact number of live particles with the CPU backend, or an estimate
+ * based on the lifetime of emitted bursts with the GPU backend.
+ */
+std::size_t abcg::OpenGLParticleSystem::getLiveCount() const noexcept {
+  if (m_createInfo.backend == ParticleBackend::CPU)
+    return m_liveCount;
+  return std::min(m_batchCount, m_createInfo.capacity);
+}
+
+void abcg::OpenGLParticleSystem::setupVertexArray(
+    OpenGLVertexArray &vertexArray, OpenGLBuffer const &buffer) const {
+  vertexArray = OpenGLVertexArray::acquire();
+  abcg::glBindVertexArray(vertexArray.get());
+  abcg::glBindBuffer(GL_ARRAY_BUFFER, buffer.get());
+
+  auto const stride{gsl::narrow<GLsizei>(sizeof(Particle))};
+  abcg::glEnableVertexAttribArray(0);
+  abcg::glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, stride,
+                              bufferOffset(offsetof(Particle, positionAge)));
+  abcg::glEnableVertexAttribArray(1);
+  abcg::glVertexAttribPointer(
+      1, 4, GL_FLOAT, GL_FALSE, stride,
+      bufferOffset(offsetof(Particle, velocityLifetime)));
+  abcg::glEnableVertexAttribArray(2);
+  abcg::glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, stride,
+                              bufferOffset(offsetof(Particle, color)));
+  abcg::glEnableVertexAttribArray(3);
+  abcg::glVertexAttribPointer(3, 1, GL_FLOAT, GL_FALSE, stride,
+                              bufferOffset(offsetof(Particle, size)));
+
+  abcg::glBindBuffer(GL_ARRAY_BUFFER, 0);
+  abcg::glBindVertexArray(0);
+}
+
+abcg::OpenGLParticleSystem::Particle
+abcg::OpenGLParticleSystem::makeParticle(ParticleEmitInfo const &emitInfo) {
+  // Random velocity inside a sphere of radius speedVariation
+  std::uniform_real_distribution randomUnit{-1.0f, 1.0f};
+  glm::vec3 offset{};
+  do {
+    offset = {randomUnit(m_randomEngine), randomUnit(m_randomEngine),
+              randomUnit(m_randomEngine)};
+  } while (glm::dot(offset, offset) > 1.0f);
+
+  return {.positionAge = glm::vec4{emitInfo.position, 0.0f},
+          .velocityLifetime = glm::vec4{emitInfo.velocity +
+                                            offset * emitInfo.speedVariation,
+                                        emitInfo.lifetime},
+          .color = emitInfo.color,
+          .size = emitInfo.size};
+}
+
+void abcg::OpenGLParticleSystem::updateCPU(float deltaTime) {
+  abcg::Timer timer;
+
+  auto const count{m_liveCount};
+  auto const damping{std::max(0.0f, 1.0f - m_createInfo.drag * deltaTime)};
+  auto const deltaVelocity{m_createInfo.acceleration * deltaTime};
+
+  // Branch-free loops over contiguous arrays, so that each one is compiled to
+  // SIMD instructions
+  auto *positionX{m_arrays.positionX.data()};
+  auto *positionY{m_arrays.positionY.data()};
+  auto *positionZ{m_arrays.positionZ.data()};
+  auto *velocityX{m_arrays.velocityX.data()};
+  auto *velocityY{m_arrays.velocityY.data()};
+  auto *velocityZ{m_arrays.velocityZ.data()};
+  auto *age{m_arrays.age.data()};
+  // NOLINTBEGIN(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+  for (std::size_t index{}; index < count; ++index) {
+    velocityX[index] = velocityX[index] * damping + deltaVelocity.x;
+    velocityY[index] = velocityY[index] * damping + deltaVelocity.y;
+    velocityZ[index] = velocityZ[index] * damping + deltaVelocity.z;
+  }
+  for (std::size_t index{}; index < count; ++index) {
+    positionX[index] += velocityX[index] * deltaTime;
+    positionY[index] += velocityY[index] * deltaTime;
+    positionZ[index] += velocityZ[index] * deltaTime;
+    age[index] += deltaTime;
+  }
+  // NOLINTEND(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+
+  // Remove dead particles by moving the last live particle into their slot
+  std::size_t index{};
+  while (index < m_liveCount) {
+    if (m_arrays.age[index] < m_arrays.lifetime[index]) {
+      ++index;
+      continue;
+    }
+    auto const last{--m_liveCount};
+    for (auto *array :
+         {&m_arrays.positionX, &m_arrays.positionY, &m_arrays.positionZ,
+          &m_arrays.velocityX, &m_arrays.velocityY, &m_arrays.velocityZ,
+          &m_arrays.age, &m_arrays.lifetime, &m_arrays.size}) {
+      moveElement(*array, last, index);
+    }
+    moveElement(m_arrays.color, last, index);
+  }
+
+  // Pack into the vertex layout and stream to the GPU. The buffer is orphaned
+  // so that the driver does not wait for the previous draw
+  for (auto const live : iter::range(m_liveCount)) {
+    m_staging[live] = {
+        .positionAge = {m_arrays.positionX[live], m_arrays.positionY[live],
+                        m_arrays.positionZ[live], m_arrays.age[live]},
+        .velocityLifetime = {m_arrays.velocityX[live],
+                             m_arrays.velocityY[live],
+                             m_arrays.velocityZ[live],
+                             m_arrays.lifetime[live]},
+        .color = m_arrays.color[live],
+        .size = m_arrays.size[live]};
+  }
+
+  abcg::glBindBuffer(GL_ARRAY_BUFFER, m_streamBuffer.get());
+  abcg::glBufferData(
+      GL_ARRAY_BUFFER,
+      gsl::narrow<GLsizeiptr>(m_createInfo.capacity * sizeof(Particle)),
+      nullptr, GL_STREAM_DRAW);
+  if (m_liveCount > 0) {
+    abcg::glBufferSubData(
+        GL_ARRAY_BUFFER, 0,
+        gsl::narrow<GLsizeiptr>(m_liveCount * sizeof(Particle)),
+        m_staging.data());
+  }
+  abcg::glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+  m_simulationTime = timer.elapsed() * 1000.0;
+}
+
+void abcg::OpenGLParticleSystem::updateGPU(float deltaTime) {
+#if defined(__EMSCRIPTEN__)
+  abcg::Timer timer;
+#endif
+
+  // Forget bursts that have expired
+  m_time += deltaTime;
+  std::erase_if(m_batches, [this](auto const &batch) {
+    if (batch.first > m_time)
+      return false;
+    m_batchCount -= batch.second;
+    return true;
+  });
+
+  readGPUTime();
+
+  // Write emitted particles to the ring of the source buffer
+  auto const capacity{m_createInfo.capacity};
+  auto const &source{m_buffers.at(m_source)};
+  abcg::glBindBuffer(GL_ARRAY_BUFFER, source.get());
+  std::size_t written{};
+  while (written < m_pending.size()) {
+    auto const count{
+        std::min(m_pending.size() - written, capacity - m_ringCursor)};
+    abcg::glBufferSubData(
+        GL_ARRAY_BUFFER,
+        gsl::narrow<GLintptr>(m_ringCursor * sizeof(Particle)),
+        gsl::narrow<GLsizeiptr>(count * sizeof(Particle)),
+        &m_pending.at(written));
+    written += count;
+    m_ringCursor = (m_ringCursor + count) % capacity;
+  }
+  abcg::glBindBuffer(GL_ARRAY_BUFFER, 0);
+  m_pending.clear();
+
+#if !defined(__EMSCRIPTEN__)
+  abcg::glBeginQuery(GL_TIME_ELAPSED,
+                     m_queries.at(m_queryFrame % m_queries.size()));
+#endif
+
+  abcg::glUseProgram(m_updateProgram);
+  abcg::glUniform1f(m_updateProgram.getUniformLocation("deltaTime"),
+                    deltaTime);
+  abcg::glUniform1f(
+      m_updateProgram.getUniformLocation("damping"),
+      std::max(0.0f, 1.0f - m_createInfo.drag * deltaTime));
+  abcg::glUniform3fv(m_updateProgram.getUniformLocation("acceleration"), 1,
+                     &m_createInfo.acceleration.x);
+
+  // Capture the integrated particles into the other buffer
+  auto const destination{1 - m_source};
+  abcg::glEnable(GL_RASTERIZER_DISCARD);
+  abcg::glBindVertexArray(m_VAOs.at(m_source).get());
+  abcg::glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0,
+                         m_buffers.at(destination).get());
+  abcg::glBeginTransformFeedback(GL_POINTS);
+  abcg::glDrawArrays(GL_POINTS, 0, gsl::narrow<GLsizei>(capacity));
+  abcg::glEndTransformFeedback();
+  abcg::glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, 0);
+  abcg::glBindVertexArray(0);
+  abcg::glDisable(GL_RASTERIZER_DISCARD);
+  abcg::glUseProgram(0);
+
+  m_source = destination;
+
+#if !defined(__EMSCRIPTEN__)
+  abcg::glEndQuery(GL_TIME_ELAPSED);
+  ++m_queryFrame;
+#else
+  m_simulationTime = timer.elapsed() * 1000.0;
+#endif
+}
+
+// Reads the oldest timer query without waiting for it
+void abcg::OpenGLParticleSystem::readGPUTime() {
+#if !defined(__EMSCRIPTEN__)
+  if (m_queryFrame < m_queries.size())
+    return;
+  auto const query{m_queries.at(m_queryFrame % m_queries.size())};
+  GLuint available{};
+  abcg::glGetQueryObjectuiv(query, GL_QUERY_RESULT_AVAILABLE, &available);
+  if (available == GL_TRUE) {
+    GLuint nanoseconds{};
+    abcg::glGetQueryObjectuiv(query, GL_QUERY_RESULT, &nanoseconds);
+    m_simulationTime = nanoseconds / 1.0e6;
+  }
+#endif
+}
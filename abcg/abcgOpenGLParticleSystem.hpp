@@ -0,0 +1,208 @@
+/**
+ * @file abcgOpenGLParticleSystem.hpp
+ * @brief Header file of abcg::OpenGLParticleSystem.
+ *
+ * Declaration of abcg::OpenGLParticleSystem and related structures.
+ *
+ * This file is part of ABCg (https://github.com/hbatagelo/abcg).
+ *
+ * @copyright (c) 2021--2022 Harlen Batagelo. All rights reserved.
+ * This project is released under the MIT License.
+ */
+
+#ifndef ABCG_OPENGL_PARTICLE_SYSTEM_HPP_
+#define ABCG_OPENGL_PARTICLE_SYSTEM_HPP_
+
+#include <array>
+#include <cstddef>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include <glm/mat4x4.hpp>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+
+#include "abcgOpenGLExternal.hpp"
+#include "abcgOpenGLHandle.hpp"
+#include "abcgOpenGLProgram.hpp"
+
+namespace abcg {
+enum class ParticleBackend;
+struct ParticleEmitInfo;
+struct OpenGLParticleSystemCreateInfo;
+class OpenGLParticleSystem;
+} // namespace abcg
+
+/**
+ * @brief Where particles are simulated.
+ */
+enum class abcg::ParticleBackend {
+  /** @brief Structure of arrays on the CPU, streamed to a vertex buffer every
+   * update. */
+  CPU,
+  /** @brief Ping-pong vertex buffers updated with transform feedback. */
+  GPU
+};
+
+/**
+ * @brief Description of a burst of particles.
+ */
+struct abcg::ParticleEmitInfo {
+  /** @brief Initial position of all particles. */
+  glm::vec3 position{};
+  /** @brief Base velocity of all particles. */
+  glm::vec3 velocity{};
+  /** @brief Maximum magnitude of a random velocity added to each particle. */
+  float speedVariation{};
+  /** @brief Color at birth. The alpha fades to zero along the lifetime. */
+  glm::vec4 color{1.0f};
+  /** @brief Lifetime in seconds. */
+  float lifetime{1.0f};
+  /** @brief Point size in pixels. */
+  float size{1.0f};
+  /** @brief Number of particles. */
+  std::size_t count{1};
+};
+
+/**
+ * @brief Creation info structure for abcg::OpenGLParticleSystem.
+ */
+struct abcg::OpenGLParticleSystemCreateInfo {
+  /** @brief Simulation backend. */
+  ParticleBackend backend{ParticleBackend::CPU};
+  /** @brief Maximum number of live particles. */
+  std::size_t capacity{65536};
+  /** @brief Constant acceleration (e.g., gravity). */
+  glm::vec3 acceleration{};
+  /** @brief Fraction of the velocity lost per second. */
+  float drag{};
+  /** @brief Seed of the random velocity of emitted particles. */
+  unsigned int seed{};
+};
+
+/**
+ * @brief Point-sprite particle system with CPU and GPU simulation backends.
+ *
+ * Both backends share the same emitter API and the same render program:
+ * @code
+ * m_particles.create({.backend = abcg::ParticleBackend::GPU,
+ *                     .capacity = 1'000'000,
+ *                     .acceleration = {0, -1, 0}});
+ * // On impact:
+ * m_particles.emit({.position = {x, y, 0}, .speedVariation = 0.5f,
+ *                   .count = 1000});
+ * // In onUpdate:
+ * m_particles.update(deltaTime);
+ * // In onPaint:
+ * m_particles.render(viewProjection);
+ * @endcode
+ *
+ * The CPU backend keeps each particle attribute in its own contiguous array
+ * so that the integration loops can be vectorized by the compiler. Dead
+ * particles are compacted away, and the live ones are written to a streamed
+ * vertex buffer. When the buffer is full, new particles are dropped.
+ *
+ * The GPU backend keeps all particles in two vertex buffers used alternately
+ * as source and destination of a transform feedback pass. Emitted particles
+ * overwrite the oldest slots of a ring, and dead particles are culled in the
+ * vertex shader. No data is read back; abcg::OpenGLParticleSystem::getLiveCount
+ * is an estimate based on the emitted lifetimes.
+ *
+ * abcg::OpenGLParticleSystem::getSimulationTime returns the duration of the
+ * last simulation step: the CPU time of the update and upload for the CPU
+ * backend, and the GPU time of the transform feedback pass for the GPU
+ * backend. `GL_TIME_ELAPSED` queries are not available in WebGL, where the GPU
+ * backend reports the CPU time spent submitting the pass.
+ */
+class abcg::OpenGLParticleSystem {
+public:
+  void create(OpenGLParticleSystemCreateInfo const &createInfo);
+  void destroy();
+
+  void emit(ParticleEmitInfo const &emitInfo);
+  void update(float deltaTime);
+  void render(glm::mat4 const &viewProjection = glm::mat4{1.0f}) const;
+
+  /**
+   * @brief Returns the simulation backend.
+   *
+   * @return Simulation backend.
+   */
+  [[nodiscard]] ParticleBackend getBackend() const noexcept {
+    return m_createInfo.backend;
+  }
+
+  /**
+   * @brief Returns the maximum number of live particles.
+   *
+   * @return Capacity given at creation.
+   */
+  [[nodiscard]] std::size_t getCapacity() const noexcept {
+    return m_createInfo.capacity;
+  }
+
+  [[nodiscard]] std::size_t getLiveCount() const noexcept;
+
+  /**
+   * @brief Returns the duration of the last simulation step.
+   *
+   * @return Simulation time in milliseconds.
+   */
+  [[nodiscard]] double getSimulationTime() const noexcept {
+    return m_simulationTime;
+  }
+
+private:
+  // Vertex layout of both backends. Age and lifetime are packed in the w
+  // components of position and velocity
+  struct Particle {
+    glm::vec4 positionAge{};
+    glm::vec4 velocityLifetime{};
+    glm::vec4 color{};
+    float size{};
+  };
+
+  // Particle attributes of the CPU backend, one array per component
+  struct ParticleArrays {
+    std::vector<float> positionX, positionY, positionZ;
+    std::vector<float> velocityX, velocityY, velocityZ;
+    std::vector<float> age, lifetime, size;
+    std::vector<glm::vec4> color;
+  };
+
+  void setupVertexArray(OpenGLVertexArray &vertexArray,
+                        OpenGLBuffer const &buffer) const;
+  [[nodiscard]] Particle makeParticle(ParticleEmitInfo const &emitInfo);
+  void updateCPU(float deltaTime);
+  void updateGPU(float deltaTime);
+  void readGPUTime();
+
+  OpenGLParticleSystemCreateInfo m_createInfo{};
+  std::default_random_engine m_randomEngine;
+
+  OpenGLProgram m_renderProgram;
+  double m_simulationTime{};
+
+  // CPU backend
+  ParticleArrays m_arrays;
+  std::size_t m_liveCount{};
+  std::vector<Particle> m_staging;
+  OpenGLBuffer m_streamBuffer;
+  OpenGLVertexArray m_streamVAO;
+
+  // GPU backend
+  OpenGLProgram m_updateProgram;
+  std::array<OpenGLBuffer, 2> m_buffers;
+  std::array<OpenGLVertexArray, 2> m_VAOs;
+  std::size_t m_source{};
+  std::size_t m_ringCursor{};
+  std::vector<Particle> m_pending;
+  std::vector<std::pair<float, std::size_t>> m_batches;
+  std::size_t m_batchCount{};
+  float m_time{};
+  std::array<GLuint, 4> m_queries{};
+  std::size_t m_queryFrame{};
+};
+
+#endif
@@ -0,0 +1,275 @@
+/**
+ * @file abcgOpenGLProgram.cpp
+ * @brief Definition of abcg::OpenGLProgram members.
+ *
+ * This file is part of ABCg (https://github.com/hbatagelo/abcg).
+ *
+ * @copyright (c) 2021--2022 Harlen Batagelo. All rights reserved.
+ * This project is released under the MIT License.
+ */
+
+#include "abcgOpenGLProgram.hpp"
+
+#include <bit>
+
+#include <cppitertools/itertools.hpp>
+#include <fmt/core.h>
+#include <gsl/gsl>
+
+#include "abcgException.hpp"
+#include "abcgOpenGLFunction.hpp"
+
+namespace {
+
+using ResourceList =
+    std::vector<std::pair<std::string, abcg::OpenGLProgramResource>>;
+
+// Returns the name written by glGetActive* without the terminating null
+[[nodiscard]] std::string toName(std::vector<GLchar> const &buffer,
+                                 GLsizei length) {
+  return {buffer.data(), gsl::narrow<std::size_t>(length)};
+}
+
+[[nodiscard]] ResourceList enumerateUniforms(GLuint program) {
+  GLint count{};
+  GLint maxLength{};
+  abcg::glGetProgramiv(program, GL_ACTIVE_UNIFORMS, &count);
+  abcg::glGetProgramiv(program, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+
+  ResourceList uniforms;
+  std::vector<GLchar> buffer(gsl::narrow<std::size_t>(maxLength) + 1);
+  for (auto const index : iter::range(gsl::narrow<GLuint>(count))) {
+    GLsizei length{};
+    abcg::OpenGLProgramResource resource{};
+    abcg::glGetActiveUniform(program, index,
+                             gsl::narrow<GLsizei>(buffer.size()), &length,
+                             &resource.size, &resource.type, buffer.data());
+    auto name{toName(buffer, length)};
+    resource.location = abcg::glGetUniformLocation(program, name.c_str());
+    // Members of uniform blocks have no location
+    if (resource.location < 0)
+      continue;
+
+    // "name[0]" is also accessible as "name"
+    if (name.ends_with("[0]")) {
+      uniforms.emplace_back(name.substr(0, name.size() - 3), resource);
+    }
+    uniforms.emplace_back(std::move(name), resource);
+  }
+  return uniforms;
+}
+
+[[nodiscard]] ResourceList enumerateAttributes(GLuint program) {
+  GLint count{};
+  GLint maxLength{};
+  abcg::glGetProgramiv(program, GL_ACTIVE_ATTRIBUTES, &count);
+  abcg::glGetProgramiv(program, GL_ACTIVE_ATTRIBUTE_MAX_LENGTH, &maxLength);
+
+  ResourceList attributes;
+  std::vector<GLchar> buffer(gsl::narrow<std::size_t>(maxLength) + 1);
+  for (auto const index : iter::range(gsl::narrow<GLuint>(count))) {
+    GLsizei length{};
+    abcg::OpenGLProgramResource resource{};
+    abcg::glGetActiveAttrib(program, index, gsl::narrow<GLsizei>(buffer.size()),
+                            &length, &resource.size, &resource.type,
+                            buffer.data());
+    auto name{toName(buffer, length)};
+    resource.location = abcg::glGetAttribLocation(program, name.c_str());
+    // Built-in attributes (e.g., gl_VertexID) have no location
+    if (resource.location < 0)
+      continue;
+    attributes.emplace_back(std::move(name), resource);
+  }
+  return attributes;
+}
+
+[[nodiscard]] ResourceList enumerateUniformBlocks(GLuint program) {
+  GLint count{};
+  abcg::glGetProgramiv(program, GL_ACTIVE_UNIFORM_BLOCKS, &count);
+
+  ResourceList blocks;
+  std::vector<GLchar> buffer;
+  for (auto const index : iter::range(gsl::narrow<GLuint>(count))) {
+    GLint nameLength{};
+    abcg::glGetActiveUniformBlockiv(program, index, GL_UNIFORM_BLOCK_NAME_LENGTH,
+                                    &nameLength);
+    buffer.resize(gsl::narrow<std::size_t>(nameLength) + 1);
+
+    GLsizei length{};
+    abcg::glGetActiveUniformBlockName(program, index,
+                                      gsl::narrow<GLsizei>(buffer.size()),
+                                      &length, buffer.data());
+    abcg::OpenGLProgramResource resource{
+        .location = gsl::narrow<GLint>(index)};
+    abcg::glGetActiveUniformBlockiv(program, index, GL_UNIFORM_BLOCK_DATA_SIZE,
+                                    &resource.size);
+    blocks.emplace_back(toName(buffer, length), resource);
+  }
+  return blocks;
+}
+
+} // namespace
+
+/**
+ * @brief Enumerates the active resources of a linked program.
+ *
+ * @param program Program object. It must be successfully linked.
+ *
+ * @throw abcg::RuntimeError if two resource names have the same hash. The
+ * program is deleted before throwing, as the caller does not get its name.
+ */
+abcg::OpenGLProgram::OpenGLProgram(GLuint program) : m_program{program} {
+  if (m_program == 0)
+    return;
+
+  try {
+    m_uniforms.build(enumerateUniforms(m_program));
+    m_attributes.build(enumerateAttributes(m_program));
+    m_uniformBlocks.build(enumerateUniformBlocks(m_program));
+  } catch (...) {
+    abcg::glDeleteProgram(m_program);
+    throw;
+  }
+}
+
+/**
+ * @brief Returns the location of an active uniform variable.
+ *
+ * @param name Name of the uniform variable.
+ *
+ * @return Location of the uniform, or -1 if there is no such active uniform
+ * outside of uniform blocks.
+ */
+GLint abcg::OpenGLProgram::getUniformLocation(StringHash name) const noexcept {
+  auto const *resource{m_uniforms.find(name)};
+  return resource != nullptr ? resource->location : -1;
+}
+
+/**
+ * @brief Returns the location of an active vertex attribute.
+ *
+ * @param name Name of the attribute.
+ *
+ * @return Location of the attribute, or -1 if there is no such active
+ * attribute.
+ */
+GLint abcg::OpenGLProgram::getAttributeLocation(
+    StringHash name) const noexcept {
+  auto const *resource{m_attributes.find(name)};
+  return resource != nullptr ? resource->location : -1;
+}
+
+/**
+ * @brief Returns the index of an active uniform block.
+ *
+ * @param name Name of the uniform block.
+ *
+ * @return Index of the uniform block, or `GL_INVALID_INDEX` if there is no
+ * such active block.
+ */
+GLuint
+abcg::OpenGLProgram::getUniformBlockIndex(StringHash name) const noexcept {
+  auto const *resource{m_uniformBlocks.find(name)};
+  return resource != nullptr ? gsl::narrow_cast<GLuint>(resource->location)
+                             : GL_INVALID_INDEX;
+}
+
+/**
+ * @brief Looks up an active uniform variable.
+ *
+ * @param name Name of the uniform variable.
+ *
+ * @return Pointer to the resource, or `nullptr` if not found.
+ */
+abcg::OpenGLProgramResource const *
+abcg::OpenGLProgram::findUniform(StringHash name) const noexcept {
+  return m_uniforms.find(name);
+}
+
+/**
+ * @brief Looks up an active vertex attribute.
+ *
+ * @param name Name of the attribute.
+ *
+ * @return Pointer to the resource, or `nullptr` if not found.
+ */
+abcg::OpenGLProgramResource const *
+abcg::OpenGLProgram::findAttribute(StringHash name) const noexcept {
+  return m_attributes.find(name);
+}
+
+/**
+ * @brief Looks up an active uniform block.
+ *
+ * @param name Name of the uniform block.
+ *
+ * @return Pointer to the resource, or `nullptr` if not found.
+ */
+abcg::OpenGLProgramResource const *
+abcg::OpenGLProgram::findUniformBlock(StringHash name) const noexcept {
+  return m_uniformBlocks.find(name);
+}
+
+/**
+ * @brief Associates an active uniform block with a uniform buffer binding
+ * point.
+ *
+ * Nothing is done if the block is not active.
+ *
+ * @param name Name of the uniform block.
+ * @param binding Uniform buffer binding point.
+ */
+void abcg::OpenGLProgram::bindUniformBlock(StringHash name,
+                                           GLuint binding) const {
+  if (auto const blockIndex{getUniformBlockIndex(name)};
+      blockIndex != GL_INVALID_INDEX) {
+    abcg::glUniformBlockBinding(m_program, blockIndex, binding);
+  }
+}
+
+void abcg::OpenGLProgram::ResourceTable::build(
+    std::vector<std::pair<std::string, OpenGLProgramResource>> const
+        &resources) {
+  m_entries.clear();
+  if (resources.empty())
+    return;
+
+  // Load factor of at most 50%
+  m_entries.resize(std::bit_ceil(resources.size() * 2));
+  std::vector<std::string const *> names(m_entries.size());
+  auto const mask{m_entries.size() - 1};
+
+  for (auto const &[name, resource] : resources) {
+    auto const hash{StringHash::fromString(name).getValue()};
+    auto slot{gsl::narrow_cast<std::size_t>(hash) & mask};
+    while (m_entries.at(slot).used) {
+      if (m_entries.at(slot).hash == hash) {
+        if (*names.at(slot) != name) {
+          throw abcg::RuntimeError(fmt::format(
+              "Hash collision between {} and {}", *names.at(slot), name));
+        }
+        break;
+      }
+      slot = (slot + 1) & mask;
+    }
+    m_entries.at(slot) = {.hash = hash, .used = true, .resource = resource};
+    names.at(slot) = &name;
+  }
+}
+
+abcg::OpenGLProgramResource const *
+abcg::OpenGLProgram::ResourceTable::find(StringHash name) const noexcept {
+  if (m_entries.empty())
+    return nullptr;
+
+  auto const hash{name.getValue()};
+  auto const mask{m_entries.size() - 1};
+  for (auto slot{gsl::narrow_cast<std::size_t>(hash) & mask};;
+       slot = (slot + 1) & mask) {
+    auto const &entry{m_entries[slot]};
+    if (!entry.used)
+      return nullptr;
+    if (entry.hash == hash)
+      return &entry.resource;
+  }
+}
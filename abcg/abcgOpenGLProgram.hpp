@@ -0,0 +1,112 @@
+/**
+ * @file abcgOpenGLProgram.hpp
+ * @brief Header file of abcg::OpenGLProgram.
+ *
+ * Declaration of abcg::OpenGLProgram and related structures.
+ *
+ * This file is part of ABCg (https://github.com/hbatagelo/abcg).
+ *
+ * @copyright (c) 2021--2022 Harlen Batagelo. All rights reserved.
+ * This project is released under the MIT License.
+ */
+
+#ifndef ABCG_OPENGL_PROGRAM_HPP_
+#define ABCG_OPENGL_PROGRAM_HPP_
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "abcgOpenGLExternal.hpp"
+#include "abcgUtil.hpp"
+
+namespace abcg {
+struct OpenGLProgramResource;
+class OpenGLProgram;
+} // namespace abcg
+
+/**
+ * @brief Active uniform, uniform block or vertex attribute of a program.
+ */
+struct abcg::OpenGLProgramResource {
+  /** @brief Location of the uniform or attribute, or index of the uniform
+   * block. */
+  GLint location{-1};
+  /** @brief Data type (e.g., `GL_FLOAT_VEC4`). Zero for uniform blocks. */
+  GLenum type{};
+  /** @brief Number of array elements of the uniform or attribute, or size in
+   * bytes of the uniform block. */
+  GLint size{};
+};
+
+/**
+ * @brief Linked program object with cached locations of its active
+ * resources.
+ *
+ * When constructed from a linked program, all active uniforms, uniform blocks
+ * and vertex attributes are enumerated once and stored in flat open-addressing
+ * tables keyed by abcg::StringHash. Lookups do not call the driver, and names
+ * given as string literals are hashed at compile time:
+ * @code
+ * m_program = abcg::createOpenGLProgram({...});
+ * // ...
+ * abcg::glUseProgram(m_program);
+ * abcg::glUniform4fv(m_program.getUniformLocation("color"), 1, &m_color.r);
+ * @endcode
+ *
+ * Uniforms that belong to uniform blocks have no location and are not listed.
+ * Array uniforms are listed both with and without the `[0]` suffix.
+ *
+ * The object does not own the program. It converts implicitly to the program
+ * name, so that it can be passed to `glUseProgram` and `glDeleteProgram`.
+ */
+class abcg::OpenGLProgram {
+public:
+  OpenGLProgram() = default;
+  explicit OpenGLProgram(GLuint program);
+
+  /**
+   * @brief Conversion to the program name.
+   */
+  // NOLINTNEXTLINE(google-explicit-constructor, hicpp-explicit-conversions)
+  operator GLuint() const noexcept { return m_program; }
+
+  [[nodiscard]] GLint getUniformLocation(StringHash name) const noexcept;
+  [[nodiscard]] GLint getAttributeLocation(StringHash name) const noexcept;
+  [[nodiscard]] GLuint getUniformBlockIndex(StringHash name) const noexcept;
+
+  [[nodiscard]] OpenGLProgramResource const *
+  findUniform(StringHash name) const noexcept;
+  [[nodiscard]] OpenGLProgramResource const *
+  findAttribute(StringHash name) const noexcept;
+  [[nodiscard]] OpenGLProgramResource const *
+  findUniformBlock(StringHash name) const noexcept;
+
+  void bindUniformBlock(StringHash name, GLuint binding) const;
+
+private:
+  // Open-addressing hash table with linear probing
+  class ResourceTable {
+  public:
+    void build(std::vector<std::pair<std::string, OpenGLProgramResource>> const
+                   &resources);
+    [[nodiscard]] OpenGLProgramResource const *
+    find(StringHash name) const noexcept;
+
+  private:
+    struct Entry {
+      std::uint64_t hash{};
+      bool used{};
+      OpenGLProgramResource resource{};
+    };
+    std::vector<Entry> m_entries;
+  };
+
+  GLuint m_program{};
+  ResourceTable m_uniforms;
+  ResourceTable m_attributes;
+  ResourceTable m_uniformBlocks;
+};
+
+#endif
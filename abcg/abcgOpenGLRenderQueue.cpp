@@ -0,0 +1,296 @@
+/**
+ * @file abcgOpenGLRenderQueue.cpp
+ * @brief Definition of abcg::OpenGLRenderQueue members.
+ *
+ * This file is part of ABCg (https://github.com/hbatagelo/abcg).
+ *
+ * @copyright (c) 2021--2022 Harlen Batagelo. All rights reserved.
+ * This project is released under the MIT License.
+ */
+
+#include "abcgOpenGLRenderQueue.hpp"
+
+#include <algorithm>
+
+#include <cppitertools/itertools.hpp>
+#include <gsl/gsl>
+
+#include "abcgException.hpp"
+#include "abcgOpenGLFunction.hpp"
+
+namespace {
+
+constexpr std::uint64_t layerBits{4};
+constexpr std::uint64_t programBits{12};
+constexpr std::uint64_t materialBits{16};
+constexpr std::uint64_t depthBits{31};
+
+constexpr std::uint64_t translucentShift{programBits + materialBits +
+                                         depthBits};
+constexpr std::uint64_t layerShift{translucentShift + 1};
+
+static_assert(layerShift + layerBits == 64);
+
+[[nodiscard]] constexpr std::uint64_t mask(std::uint64_t bits) {
+  return (std::uint64_t{1} << bits) - 1;
+}
+
+// Depth in [0, 1] scaled to the depth bits. This is computed in double
+// precision, as 2^31 - 1 rounds up to 2^31 in float, which would wrap the
+// far plane to zero
+[[nodiscard]] constexpr std::uint64_t quantizeDepth(float depth) {
+  auto const clamped{std::clamp(static_cast<double>(depth), 0.0, 1.0)};
+  return static_cast<std::uint64_t>(clamped *
+                                    static_cast<double>(mask(depthBits)));
+}
+
+[[nodiscard]] constexpr std::uint64_t
+sortKey(std::uint8_t layer, bool translucent, std::uint32_t program,
+        std::uint32_t material, float depth) {
+  auto const quantizedDepth{quantizeDepth(depth)};
+  auto const state{((program & mask(programBits)) << materialBits) |
+                   (material & mask(materialBits))};
+
+  auto key{(std::uint64_t{layer} & mask(layerBits)) << layerShift};
+  if (translucent) {
+    // Back to front
+    key |= std::uint64_t{1} << translucentShift;
+    key |= (mask(depthBits) - quantizedDepth) << (programBits + materialBits);
+    key |= state;
+  } else {
+    // Grouped by state, then front to back
+    key |= state << depthBits;
+    key |= quantizedDepth;
+  }
+  return key;
+}
+
+// The far plane is drawn last among opaque draws and first among translucent
+// draws
+static_assert(quantizeDepth(1.0f) == mask(depthBits));
+static_assert(sortKey(0, false, 0, 0, 1.0f) > sortKey(0, false, 0, 0, 0.999f));
+static_assert(sortKey(0, true, 0, 0, 1.0f) < sortKey(0, true, 0, 0, 0.999f));
+
+} // namespace
+
+/**
+ * @brief Packs the state of a draw into a sort key.
+ *
+ * @param layer Render layer. Only the 4 least significant bits are used.
+ * @param translucent Whether the draw is alpha-blended.
+ * @param program Dense program index. Only the 12 least significant bits are
+ * used.
+ * @param material Material index. Only the 16 least significant bits are used.
+ * @param depth Normalized depth, clamped to [0, 1].
+ *
+ * @return 64-bit key whose ascending order is the draw order.
+ */
+std::uint64_t abcg::OpenGLRenderQueue::makeSortKey(std::uint8_t layer,
+                                                   bool translucent,
+                                                   std::uint32_t program,
+                                                   std::uint32_t material,
+                                                   float depth) noexcept {
+  return sortKey(layer, translucent, program, material, depth);
+}
+
+/**
+ * @brief Registers a material.
+ *
+ * @param material Textures and uniform values of the material.
+ *
+ * @return Index of the material to be used in abcg::OpenGLDrawCommand.
+ *
+ * @throw abcg::RuntimeError if the maximum number of materials is exceeded.
+ */
+std::uint32_t abcg::OpenGLRenderQueue::addMaterial(OpenGLMaterial material) {
+  if (m_materials.size() >= noMaterial) {
+    throw abcg::RuntimeError("Too many render queue materials");
+  }
+  m_materials.push_back(std::move(material));
+  return gsl::narrow<std::uint32_t>(m_materials.size() - 1);
+}
+
+/**
+ * @brief Removes all registered materials.
+ */
+void abcg::OpenGLRenderQueue::clearMaterials() { m_materials.clear(); }
+
+/**
+ * @brief Adds a draw to the queue.
+ *
+ * @param command Draw call and its state.
+ *
+ * @throw abcg::RuntimeError if the material index is not valid.
+ */
+void abcg::OpenGLRenderQueue::submit(OpenGLDrawCommand command) {
+  if (command.material != noMaterial &&
+      command.material >= m_materials.size()) {
+    throw abcg::RuntimeError("Invalid render queue material");
+  }
+  m_keys.emplace_back(makeSortKey(command.layer, command.translucent,
+                                  getProgramIndex(command.program),
+                                  command.material, command.depth),
+                      gsl::narrow<std::uint32_t>(m_commands.size()));
+  m_commands.push_back(std::move(command));
+}
+
+/**
+ * @brief Sorts and issues the submitted draws, and empties the queue.
+ *
+ * Blending (`GL_SRC_ALPHA`, `GL_ONE_MINUS_SRC_ALPHA`) is enabled and depth
+ * writes are disabled for translucent draws. On return, blending is disabled,
+ * depth writes are enabled, and no program and vertex array are bound.
+ */
+void abcg::OpenGLRenderQueue::flush() {
+  m_statistics = {};
+  if (m_commands.empty())
+    return;
+
+  sort();
+
+  GLuint currentProgram{};
+  GLuint currentVertexArray{};
+  auto currentMaterial{noMaterial};
+  auto translucentState{false};
+
+  for (auto const &[key, commandIndex] : m_keys) {
+    auto const &command{m_commands[commandIndex]};
+
+    if (command.translucent != translucentState) {
+      translucentState = command.translucent;
+      if (translucentState) {
+        abcg::glEnable(GL_BLEND);
+        abcg::glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        abcg::glDepthMask(GL_FALSE);
+      } else {
+        abcg::glDisable(GL_BLEND);
+        abcg::glDepthMask(GL_TRUE);
+      }
+    }
+
+    if (command.program != currentProgram) {
+      currentProgram = command.program;
+      abcg::glUseProgram(currentProgram);
+      ++m_statistics.programChanges;
+      // Material uniforms belong to the program
+      currentMaterial = noMaterial;
+    }
+
+    if (command.material != currentMaterial) {
+      currentMaterial = command.material;
+      bindMaterial(currentMaterial, currentProgram);
+      ++m_statistics.materialChanges;
+    }
+
+    if (command.vertexArray != currentVertexArray) {
+      currentVertexArray = command.vertexArray;
+      abcg::glBindVertexArray(currentVertexArray);
+      ++m_statistics.vertexArrayChanges;
+    }
+
+    if (command.setUniforms) {
+      command.setUniforms(currentProgram);
+    }
+
+    if (command.indexType != 0) {
+      // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+      auto const *offset{reinterpret_cast<void const *>(command.first)};
+      if (command.instanceCount == 1) {
+        abcg::glDrawElements(command.mode, command.count, command.indexType,
+                             offset);
+      } else {
+        abcg::glDrawElementsInstanced(command.mode, command.count,
+                                      command.indexType, offset,
+                                      command.instanceCount);
+      }
+    } else {
+      auto const first{gsl::narrow<GLint>(command.first)};
+      if (command.instanceCount == 1) {
+        abcg::glDrawArrays(command.mode, first, command.count);
+      } else {
+        abcg::glDrawArraysInstanced(command.mode, first, command.count,
+                                    command.instanceCount);
+      }
+    }
+    ++m_statistics.drawCalls;
+  }
+
+  if (translucentState) {
+    abcg::glDisable(GL_BLEND);
+    abcg::glDepthMask(GL_TRUE);
+  }
+  abcg::glBindVertexArray(0);
+  abcg::glUseProgram(0);
+
+  m_commands.clear();
+  m_keys.clear();
+  m_programs.clear();
+}
+
+// Maps a program object to a dense index that fits in the sort key. Indices
+// are assigned in order of first submission and are valid until the next
+// flush, so that deleted and recreated programs do not exhaust them
+std::uint32_t abcg::OpenGLRenderQueue::getProgramIndex(GLuint program) {
+  if (auto const iter{std::find(m_programs.begin(), m_programs.end(), program)};
+      iter != m_programs.end()) {
+    return gsl::narrow<std::uint32_t>(iter - m_programs.begin());
+  }
+  if (m_programs.size() > mask(programBits)) {
+    throw abcg::RuntimeError("Too many render queue programs in a flush");
+  }
+  m_programs.push_back(program);
+  return gsl::narrow<std::uint32_t>(m_programs.size() - 1);
+}
+
+// Least significant digit radix sort of the keys, one byte per pass. Passes
+// in which all keys have the same digit are skipped, which is common for the
+// layer and translucency bits.
+void abcg::OpenGLRenderQueue::sort() {
+  constexpr std::size_t radix{256};
+  constexpr std::size_t passes{sizeof(std::uint64_t)};
+
+  std::array<std::array<std::size_t, radix>, passes> histograms{};
+  for (auto const &[key, commandIndex] : m_keys) {
+    for (auto const pass : iter::range(passes)) {
+      ++histograms.at(pass).at((key >> (pass * 8U)) & 0xFFU);
+    }
+  }
+
+  m_sortBuffer.resize(m_keys.size());
+  for (auto const pass : iter::range(passes)) {
+    auto &histogram{histograms.at(pass)};
+    auto const digit{(m_keys.front().first >> (pass * 8U)) & 0xFFU};
+    if (histogram.at(digit) == m_keys.size())
+      continue;
+
+    // Prefix sum
+    std::size_t offset{};
+    for (auto &count : histogram) {
+      auto const bucketSize{count};
+      count = offset;
+      offset += bucketSize;
+    }
+
+    for (auto const &item : m_keys) {
+      m_sortBuffer[histogram.at((item.first >> (pass * 8U)) & 0xFFU)++] = item;
+    }
+    std::swap(m_keys, m_sortBuffer);
+  }
+}
+
+void abcg::OpenGLRenderQueue::bindMaterial(std::uint32_t material,
+                                           GLuint program) const {
+  if (material == noMaterial)
+    return;
+
+  auto const &currentMaterial{m_materials.at(material)};
+  for (auto &&[unit, texture] : iter::enumerate(currentMaterial.textures)) {
+    if (texture == 0)
+      continue;
+    abcg::glActiveTexture(GL_TEXTURE0 + gsl::narrow<GLenum>(unit));
+    abcg::glBindTexture(currentMaterial.textureTarget, texture);
+  }
+  if (currentMaterial.setUniforms) {
+    currentMaterial.setUniforms(program);
+  }
+}
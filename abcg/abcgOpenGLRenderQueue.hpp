@@ -0,0 +1,198 @@
+/**
+ * @file abcgOpenGLRenderQueue.hpp
+ * @brief Header file of abcg::OpenGLRenderQueue.
+ *
+ * Declaration of abcg::OpenGLRenderQueue and related structures.
+ *
+ * This file is part of ABCg (https://github.com/hbatagelo/abcg).
+ *
+ * @copyright (c) 2021--2022 Harlen Batagelo. All rights reserved.
+ * This project is released under the MIT License.
+ */
+
+#ifndef ABCG_OPENGL_RENDER_QUEUE_HPP_
+#define ABCG_OPENGL_RENDER_QUEUE_HPP_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "abcgOpenGLExternal.hpp"
+
+namespace abcg {
+struct OpenGLMaterial;
+struct OpenGLDrawCommand;
+struct OpenGLRenderQueueStatistics;
+class OpenGLRenderQueue;
+} // namespace abcg
+
+/**
+ * @brief Textures and uniform values shared by several draws.
+ *
+ * @sa abcg::OpenGLRenderQueue::addMaterial.
+ */
+struct abcg::OpenGLMaterial {
+  /** @brief Maximum number of textures of a material. */
+  static constexpr std::size_t maxTextures{4};
+
+  /** @brief Texture objects bound to texture units 0, 1, ... Unused entries
+   * must be zero. */
+  std::array<GLuint, maxTextures> textures{};
+  /** @brief Texture target of the textures (e.g., `GL_TEXTURE_2D`). */
+  GLenum textureTarget{GL_TEXTURE_2D};
+  /** @brief Function that sets the uniform variables of the material. It
+   * receives the program currently in use. */
+  std::function<void(GLuint program)> setUniforms{};
+};
+
+/**
+ * @brief Draw call submitted to abcg::OpenGLRenderQueue.
+ */
+struct abcg::OpenGLDrawCommand {
+  /** @brief Program object. */
+  GLuint program{};
+  /** @brief Vertex array object. */
+  GLuint vertexArray{};
+  /** @brief Material index returned by abcg::OpenGLRenderQueue::addMaterial,
+   * or abcg::OpenGLRenderQueue::noMaterial. */
+  std::uint32_t material{};
+  /** @brief Render layer, from 0 to 15. Lower layers are drawn first. */
+  std::uint8_t layer{};
+  /** @brief Whether the draw is alpha-blended. Translucent draws are drawn
+   * after the opaque draws of the same layer, from back to front. */
+  bool translucent{};
+  /** @brief Normalized view-space depth in [0, 1], e.g., the distance to the
+   * camera divided by the distance to the far plane. Opaque draws with the
+   * same state are drawn from front to back. */
+  float depth{};
+
+  /** @brief Primitive type (e.g., `GL_TRIANGLES`). */
+  GLenum mode{GL_TRIANGLES};
+  /** @brief Number of vertices or indices. */
+  GLsizei count{};
+  /** @brief Type of the indices (e.g., `GL_UNSIGNED_INT`), or zero for
+   * non-indexed draws. */
+  GLenum indexType{};
+  /** @brief Offset in bytes of the first index (indexed draws) or index of the
+   * first vertex (non-indexed draws). */
+  std::size_t first{};
+  /** @brief Number of instances. */
+  GLsizei instanceCount{1};
+
+  /** @brief Function that sets per-draw uniform variables (e.g., the model
+   * matrix). It receives the program currently in use. */
+  std::function<void(GLuint program)> setUniforms{};
+};
+
+/**
+ * @brief Counters of state changes of the last flush of a render queue.
+ */
+struct abcg::OpenGLRenderQueueStatistics {
+  /** @brief Number of draw calls. */
+  std::size_t drawCalls{};
+  /** @brief Number of calls to `glUseProgram`. */
+  std::size_t programChanges{};
+  /** @brief Number of material changes. */
+  std::size_t materialChanges{};
+  /** @brief Number of calls to `glBindVertexArray`. */
+  std::size_t vertexArrayChanges{};
+};
+
+/**
+ * @brief Sorts draw calls to minimize OpenGL state changes.
+ *
+ * Draws are submitted as abcg::OpenGLDrawCommand objects during the frame.
+ * abcg::OpenGLRenderQueue::flush packs the layer, translucency, program,
+ * material and depth of each draw into a 64-bit key, radix sorts the keys and
+ * issues the draws in key order, changing the program, material and vertex
+ * array only when they differ from the previous draw. All calls go through
+ * the abcg::gl* wrappers.
+ *
+ * The bits of the key are, from the most significant:
+ *
+ * - Opaque draws: layer (4), translucency (1, zero), program (12), material
+ * (16), depth (31);
+ * - Translucent draws: layer (4), translucency (1, one), inverted depth (31),
+ * program (12), material (16).
+ *
+ * Thus the program changes at most once per program for the opaque draws of
+ * a layer, and translucent draws are correctly ordered from back to front.
+ * The program bits are an index assigned to each distinct program submitted
+ * since the last flush, so up to 4096 programs can be used in a flush.
+ *
+ * @code
+ * // In onCreate
+ * m_material = m_renderQueue.addMaterial({.textures = {m_diffuseTexture}});
+ *
+ * // In onPaint
+ * for (auto const &object : m_objects) {
+ *   m_renderQueue.submit({.program = m_program,
+ *                         .vertexArray = object.vao,
+ *                         .material = m_material,
+ *                         .depth = object.depth,
+ *                         .count = object.indexCount,
+ *                         .indexType = GL_UNSIGNED_INT,
+ *                         .setUniforms = [&object](GLuint program) {
+ *                           abcg::glUniformMatrix4fv(
+ *                               abcg::glGetUniformLocation(program, "model"),
+ *                               1, GL_FALSE, &object.modelMatrix[0][0]);
+ *                         }});
+ * }
+ * m_renderQueue.flush();
+ * @endcode
+ */
+class abcg::OpenGLRenderQueue {
+public:
+  /** @brief Material index of draws that do not use a material. */
+  static constexpr std::uint32_t noMaterial{0xFFFF};
+
+  [[nodiscard]] std::uint32_t addMaterial(OpenGLMaterial material);
+  void clearMaterials();
+
+  void submit(OpenGLDrawCommand command);
+  void flush();
+
+  /**
+   * @brief Returns the number of draws submitted since the last flush.
+   *
+   * @return Number of pending draws.
+   */
+  [[nodiscard]] std::size_t size() const noexcept { return m_commands.size(); }
+
+  /**
+   * @brief Returns the state change counters of the last flush.
+   *
+   * @return Reference to the statistics of the last call to
+   * abcg::OpenGLRenderQueue::flush.
+   */
+  [[nodiscard]] OpenGLRenderQueueStatistics const &
+  getStatistics() const noexcept {
+    return m_statistics;
+  }
+
+  [[nodiscard]] static std::uint64_t makeSortKey(std::uint8_t layer,
+                                                 bool translucent,
+                                                 std::uint32_t program,
+                                                 std::uint32_t material,
+                                                 float depth) noexcept;
+
+private:
+  [[nodiscard]] std::uint32_t getProgramIndex(GLuint program);
+  void sort();
+  void bindMaterial(std::uint32_t material, GLuint program) const;
+
+  std::vector<OpenGLMaterial> m_materials;
+  // Programs of the pending draws, in the order of their key indices
+  std::vector<GLuint> m_programs;
+
+  std::vector<OpenGLDrawCommand> m_commands;
+  // Sort keys paired with command indices, and scratch buffer of the sort
+  std::vector<std::pair<std::uint64_t, std::uint32_t>> m_keys;
+  std::vector<std::pair<std::uint64_t, std::uint32_t>> m_sortBuffer;
+
+  OpenGLRenderQueueStatistics m_statistics{};
+};
+
+#endif
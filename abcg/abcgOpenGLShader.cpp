@@ -154,9 +154,10 @@ static void deleteShaders(std::vector<abcg::OpenGLShader> const &shaderIDs) {
  * the program could not be created, or if the compilation of any shader has
  * failed, or if the linking has failed.
  *
- * @return ID of the program object, or 0 on error.
+ * @return Program object with the locations of its active resources, or a
+ * program object with ID 0 on error.
  */
-GLuint
+abcg::OpenGLProgram
 abcg::createOpenGLProgram(std::vector<ShaderSource> const &pathsOrSources,
                           bool throwOnError) {
   std::vector<ShaderSource> sources;
@@ -174,7 +175,7 @@ abcg::createOpenGLProgram(std::vector<ShaderSource> const &pathsOrSources,
   }
 
   if (!checkOpenGLShaderCompile(compiledShaders, throwOnError))
-    return 0U;
+    return {};
 
   auto const shaderProgram{glCreateProgram()};
   if (shaderProgram == 0) {
@@ -182,7 +183,7 @@ abcg::createOpenGLProgram(std::vector<ShaderSource> const &pathsOrSources,
     if (throwOnError) {
       throw abcg::RuntimeError("Failed to create program");
     }
-    return 0;
+    return {};
   }
 
   for (auto const &shader : compiledShaders) {
@@ -206,10 +207,10 @@ abcg::createOpenGLProgram(std::vector<ShaderSource> const &pathsOrSources,
       throw abcg::RuntimeError("Failed to link program");
     }
     glDeleteProgram(shaderProgram);
-    return 0U;
+    return {};
   }
 
-  return shaderProgram;
+  return OpenGLProgram{shaderProgram};
 }
 
 /**
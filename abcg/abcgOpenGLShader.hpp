@@ -12,6 +12,7 @@
 #define ABCG_OPENGL_SHADER_HPP_
 
 #include "abcgOpenGLExternal.hpp"
+#include "abcgOpenGLProgram.hpp"
 #include "abcgShader.hpp"
 
 #include <vector>
@@ -31,7 +32,7 @@ struct abcg::OpenGLShader {
 };
 
 namespace abcg {
-[[nodiscard]] GLuint
+[[nodiscard]] OpenGLProgram
 createOpenGLProgram(std::vector<ShaderSource> const &pathsOrSources,
                     bool throwOnError = true);
 [[nodiscard]] std::vector<abcg::OpenGLShader>
@@ -0,0 +1,55 @@
+/**
+ * @file abcgOpenGLUniformBuffer.cpp
+ * @brief Definition of helper functions for uniform buffer objects.
+ *
+ * This file is part of ABCg (https://github.com/hbatagelo/abcg).
+ *
+ * @copyright (c) 2021--2022 Harlen Batagelo. All rights reserved.
+ * This project is released under the MIT License.
+ */
+
+#include "abcgOpenGLUniformBuffer.hpp"
+
+#include <algorithm>
+#include <string>
+
+#include <fmt/core.h>
+#include <gsl/gsl>
+
+/**
+ * @brief Associates a uniform block of a program with a binding point.
+ *
+ * This is equivalent to `layout(binding = ...)`, which is not available in
+ * OpenGL ES 3.0 and WebGL 2.0.
+ *
+ * @param program Program object.
+ * @param blockName Name of the uniform block.
+ * @param binding Uniform buffer binding point.
+ */
+void abcg::bindUniformBlock(GLuint program, std::string_view blockName,
+                            GLuint binding) {
+  std::string const name{blockName};
+  auto const blockIndex{abcg::glGetUniformBlockIndex(program, name.c_str())};
+  if (blockIndex == GL_INVALID_INDEX) {
+    fmt::print("Warning: uniform block {} not found in program {}\n", name,
+               program);
+    return;
+  }
+  abcg::glUniformBlockBinding(program, blockIndex, binding);
+}
+
+/**
+ * @brief Returns the distance between consecutive instances of a uniform block
+ * in a buffer.
+ *
+ * @param size Size of the uniform block, in bytes.
+ *
+ * @return Size rounded up to a multiple of `GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT`.
+ */
+std::size_t abcg::getUniformBufferStride(std::size_t size) {
+  GLint alignment{};
+  abcg::glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+  auto const offsetAlignment{
+      std::max(std::size_t{1}, gsl::narrow<std::size_t>(alignment))};
+  return (size + offsetAlignment - 1) / offsetAlignment * offsetAlignment;
+}
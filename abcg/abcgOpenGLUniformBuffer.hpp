@@ -0,0 +1,229 @@
+/**
+ * @file abcgOpenGLUniformBuffer.hpp
+ * @brief Header file of abcg::OpenGLUniformBuffer.
+ *
+ * Declaration of abcg::OpenGLUniformBuffer and helpers for declaring C++
+ * structures with the `std140` layout of GLSL uniform blocks.
+ *
+ * This file is part of ABCg (https://github.com/hbatagelo/abcg).
+ *
+ * @copyright (c) 2021--2022 Harlen Batagelo. All rights reserved.
+ * This project is released under the MIT License.
+ */
+
+#ifndef ABCG_OPENGL_UNIFORM_BUFFER_HPP_
+#define ABCG_OPENGL_UNIFORM_BUFFER_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include <cppitertools/itertools.hpp>
+#include <glm/mat4x4.hpp>
+#include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+
+#include "abcgOpenGLExternal.hpp"
+#include "abcgOpenGLFunction.hpp"
+
+namespace abcg {
+template <typename T> class OpenGLUniformBuffer;
+
+/**
+ * @brief Base alignment of a type in the `std140` layout, or zero if the type
+ * cannot be used as a member of a `std140` structure.
+ *
+ * `bool`, `glm::mat2` and `glm::mat3` are not supported, as their C++ layout
+ * differs from the `std140` layout. Use `GLuint`, `glm::mat4` or `glm::vec4`
+ * columns instead.
+ *
+ * @tparam T Type of the member.
+ */
+template <typename T> inline constexpr std::size_t std140Alignment{0};
+template <> inline constexpr std::size_t std140Alignment<float>{4};
+template <> inline constexpr std::size_t std140Alignment<std::int32_t>{4};
+template <> inline constexpr std::size_t std140Alignment<std::uint32_t>{4};
+template <> inline constexpr std::size_t std140Alignment<glm::vec2>{8};
+template <> inline constexpr std::size_t std140Alignment<glm::ivec2>{8};
+template <> inline constexpr std::size_t std140Alignment<glm::uvec2>{8};
+template <> inline constexpr std::size_t std140Alignment<glm::vec3>{16};
+template <> inline constexpr std::size_t std140Alignment<glm::ivec3>{16};
+template <> inline constexpr std::size_t std140Alignment<glm::uvec3>{16};
+template <> inline constexpr std::size_t std140Alignment<glm::vec4>{16};
+template <> inline constexpr std::size_t std140Alignment<glm::ivec4>{16};
+template <> inline constexpr std::size_t std140Alignment<glm::uvec4>{16};
+template <> inline constexpr std::size_t std140Alignment<glm::mat4>{16};
+
+void bindUniformBlock(GLuint program, std::string_view blockName,
+                      GLuint binding);
+[[nodiscard]] std::size_t getUniformBufferStride(std::size_t size);
+} // namespace abcg
+
+/**
+ * @brief Checks at compile time that a member of a structure has a supported
+ * type and is at a valid `std140` offset.
+ *
+ * @param type Structure type.
+ * @param member Name of the member.
+ */
+#define ABCG_STD140_MEMBER(type, member)                                       \
+  static_assert(abcg::std140Alignment<decltype(type::member)> != 0,            \
+                #type "::" #member " has no std140 equivalent");               \
+  static_assert(offsetof(type, member) %                                       \
+                        abcg::std140Alignment<decltype(type::member)> ==       \
+                    0,                                                         \
+                #type "::" #member " is not std140-aligned")
+
+/**
+ * @brief Uniform buffer object holding one or more instances of a structure
+ * with `std140` layout.
+ *
+ * The structure must be padded to a multiple of 16 bytes (e.g., by declaring
+ * it `alignas(16)`), and each of its members should be checked with
+ * #ABCG_STD140_MEMBER:
+ * @code
+ * struct alignas(16) ObjectData {
+ *   glm::vec4 color{};
+ *   glm::vec2 translation{};
+ *   float scale{};
+ * };
+ * ABCG_STD140_MEMBER(ObjectData, color);
+ * ABCG_STD140_MEMBER(ObjectData, translation);
+ * ABCG_STD140_MEMBER(ObjectData, scale);
+ * @endcode
+ * which matches the following uniform block:
+ * @code
+ * layout(std140) uniform ObjectData {
+ *   vec4 color;
+ *   vec2 translation;
+ *   float scale;
+ * };
+ * @endcode
+ *
+ * All instances are kept in a CPU copy and sent with a single call to
+ * `glBufferSubData` in abcg::OpenGLUniformBuffer::upload. Each instance is
+ * stored at a multiple of `GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT` so that it can
+ * be bound with abcg::OpenGLUniformBuffer::bind before the draw that uses it.
+ * Data shared by all programs (e.g., camera matrices) is stored in a single
+ * instance that is uploaded and bound once per frame.
+ *
+ * @tparam T Structure with `std140` layout.
+ */
+template <typename T> class abcg::OpenGLUniformBuffer {
+  static_assert(std::is_trivially_copyable_v<T> && std::is_standard_layout_v<T>,
+                "Uniform buffer data must be trivially copyable");
+  static_assert(sizeof(T) % 16 == 0,
+                "std140 blocks must be padded to a multiple of 16 bytes");
+
+public:
+  /**
+   * @brief Creates the buffer object.
+   *
+   * @param binding Uniform buffer binding point. Use abcg::bindUniformBlock to
+   * associate the uniform block of a program to this binding point.
+   * @param count Number of instances of the structure.
+   */
+  void create(GLuint binding, std::size_t count = 1) {
+    destroy();
+    m_binding = binding;
+    m_stride = getUniformBufferStride(sizeof(T));
+    m_data.resize(count);
+    m_staging.resize(count * m_stride);
+
+    abcg::glGenBuffers(1, &m_buffer);
+    abcg::glBindBuffer(GL_UNIFORM_BUFFER, m_buffer);
+    abcg::glBufferData(GL_UNIFORM_BUFFER,
+                       static_cast<GLsizeiptr>(m_staging.size()), nullptr,
+                       GL_DYNAMIC_DRAW);
+    abcg::glBindBuffer(GL_UNIFORM_BUFFER, 0);
+  }
+
+  /**
+   * @brief Releases the buffer object.
+   */
+  void destroy() {
+    if (m_buffer != 0) {
+      abcg::glDeleteBuffers(1, &m_buffer);
+      m_buffer = 0;
+    }
+    m_data.clear();
+    m_staging.clear();
+  }
+
+  /**
+   * @brief Accesses the CPU copy of an instance.
+   *
+   * Changes are sent to the GPU in the next call to
+   * abcg::OpenGLUniformBuffer::upload.
+   *
+   * @param index Index of the instance.
+   *
+   * @return Reference to the instance.
+   */
+  [[nodiscard]] T &operator[](std::size_t index) { return m_data.at(index); }
+
+  /**
+   * @brief Accesses the CPU copy of an instance.
+   *
+   * @param index Index of the instance.
+   *
+   * @return Const reference to the instance.
+   */
+  [[nodiscard]] T const &operator[](std::size_t index) const {
+    return m_data.at(index);
+  }
+
+  /**
+   * @brief Sends all instances to the buffer with a single call to
+   * `glBufferSubData`.
+   */
+  void upload() {
+    for (auto const index : iter::range(m_data.size())) {
+      std::memcpy(&m_staging.at(index * m_stride), &m_data.at(index),
+                  sizeof(T));
+    }
+    abcg::glBindBuffer(GL_UNIFORM_BUFFER, m_buffer);
+    abcg::glBufferSubData(GL_UNIFORM_BUFFER, 0,
+                          static_cast<GLsizeiptr>(m_staging.size()),
+                          m_staging.data());
+    abcg::glBindBuffer(GL_UNIFORM_BUFFER, 0);
+  }
+
+  /**
+   * @brief Binds an instance to the binding point of the buffer.
+   *
+   * @param index Index of the instance.
+   */
+  void bind(std::size_t index = 0) const {
+    abcg::glBindBufferRange(GL_UNIFORM_BUFFER, m_binding, m_buffer,
+                            static_cast<GLintptr>(index * m_stride),
+                            static_cast<GLsizeiptr>(sizeof(T)));
+  }
+
+  /**
+   * @brief Returns the number of instances.
+   *
+   * @return Number of instances.
+   */
+  [[nodiscard]] std::size_t size() const noexcept { return m_data.size(); }
+
+  /**
+   * @brief Returns the binding point.
+   *
+   * @return Uniform buffer binding point.
+   */
+  [[nodiscard]] GLuint getBinding() const noexcept { return m_binding; }
+
+private:
+  GLuint m_buffer{};
+  GLuint m_binding{};
+  std::size_t m_stride{};
+  std::vector<T> m_data;
+  std::vector<std::byte> m_staging;
+};
+
+#endif
@@ -15,10 +15,25 @@
 #include <imgui_impl_opengl3.h>
 #include <imgui_impl_sdl.h>
 
+#include "abcgAllocationTracker.hpp"
 #include "abcgEmbeddedFonts.hpp"
 #include "abcgException.hpp"
+#include "abcgOpenGLHandle.hpp"
+#include "abcgProfiler.hpp"
 #include "abcgWindow.hpp"
 
+namespace {
+
+// Scopes measured by the GPU timer of the window
+namespace GPUScope {
+constexpr std::size_t paint{0};
+constexpr std::size_t ui{1};
+constexpr std::size_t swap{2};
+constexpr std::size_t count{3};
+} // namespace GPUScope
+
+} // namespace
+
 /**
  * @brief Returns the configuration settings of the OpenGL context.
  *
@@ -132,30 +147,53 @@ void abcg::OpenGLWindow::onPaint() {
 void abcg::OpenGLWindow::onPaintUI() {
   // FPS counter
   if (abcg::Window::getWindowSettings().showFPS) {
-    auto fps{ImGui::GetIO().Framerate};
-
-    static auto offset{0UL};
-    static auto refreshTime{ImGui::GetTime()};
-    static std::array<float, 150> frames{};
-
-    while (refreshTime < ImGui::GetTime()) {
-      auto const refreshFrequency{60.0};
-      frames.at(offset) = fps;
-      offset = (offset + 1) % frames.size();
-      refreshTime += (1.0 / refreshFrequency);
+    // Frame intervals of the last frames, in milliseconds
+    auto const &history{getFrameTimeHistory()};
+    std::array<float, 150> intervals{};
+    auto const count{std::min(intervals.size(), history.size())};
+    for (auto const index : iter::range(count)) {
+      intervals.at(intervals.size() - count + index) = gsl::narrow_cast<float>(
+          history.getSample(history.size() - count + index).frameInterval);
     }
+    auto const summary{history.getSummary()};
 
     ImGui::SetNextWindowPos(ImVec2(5, 5));
     ImGui::Begin("FPS", nullptr,
                  ImGuiWindowFlags_NoDecoration | ImGuiWindowFlags_NoInputs |
                      ImGuiWindowFlags_NoBringToFrontOnFocus |
                      ImGuiWindowFlags_NoFocusOnAppearing);
-    auto const label{fmt::format("avg {:.1f} FPS", fps)};
-    ImGui::PlotLines("", frames.data(), gsl::narrow<int>(frames.size()),
-                     gsl::narrow<int>(offset), label.c_str(), 0.0f,
-                     // *std::ranges::max_element(frames) * 2,
-                     *std::max_element(frames.begin(), frames.end()) * 2,
-                     ImVec2(gsl::narrow<float>(frames.size()), 50));
+    auto const label{getFrameArena().format("p50 {:.1f} ms, p99 {:.1f} ms",
+                                            summary.frameInterval.p50,
+                                            summary.frameInterval.p99)};
+    ImGui::PlotLines("", intervals.data(), gsl::narrow<int>(intervals.size()),
+                     0, label.c_str(), 0.0f,
+                     // *std::ranges::max_element(intervals) * 2,
+                     *std::max_element(intervals.begin(), intervals.end()) * 2,
+                     ImVec2(gsl::narrow<float>(intervals.size()), 50));
+    if (summary.frameInterval.onePercentLow > 0.0) {
+      auto const lowLabel{getFrameArena().format(
+          "1% low {:.1f} FPS, {} hitches",
+          1000.0 / summary.frameInterval.onePercentLow, summary.hitchCount)};
+      ImGui::TextUnformatted(lowLabel.c_str());
+    }
+    if (auto const &culling{getFrameStatistics().culling};
+        culling.visible + culling.culled > 0) {
+      auto const cullingLabel{getFrameArena().format(
+          "{} visible, {} culled", culling.visible, culling.culled)};
+      ImGui::TextUnformatted(cullingLabel.c_str());
+    }
+    if (auto const &gpu{getFrameStatistics().gpu}; gpu.available) {
+      auto const gpuLabel{getFrameArena().format(
+          "GPU {:.2f} ms paint, {:.2f} ms UI, {:.2f} ms swap", gpu.paint,
+          gpu.ui, gpu.swap)};
+      ImGui::TextUnformatted(gpuLabel.c_str());
+    }
+    if (AllocationTracker::isEnabled()) {
+      auto const &allocations{getFrameStatistics().allocations};
+      auto const allocationLabel{getFrameArena().format(
+          "{} allocations, {} bytes", allocations.count, allocations.bytes)};
+      ImGui::TextUnformatted(allocationLabel.c_str());
+    }
     ImGui::End();
   }
 
@@ -413,19 +451,31 @@ void abcg::OpenGLWindow::create() {
     throw abcg::RuntimeError("Failed to load font file");
   }
 
+  m_GPUTimer.create(GPUScope::count);
+
   onCreate();
 
   onResize(getWindowSize());
 }
 
 void abcg::OpenGLWindow::paint() {
-  onUpdate();
+  {
+    ABCG_PROFILE_ZONE("onUpdate");
+    onUpdate();
+  }
 
   if (m_hidden || m_minimized)
     return;
 
   SDL_GL_MakeCurrent(abcg::Window::getSDLWindow(), m_GLContext);
 
+  // Times of a few frames before, reported with this frame
+  m_GPUTimer.beginFrame();
+  recordGPUTimeStatistics({.available = m_GPUTimer.isSupported(),
+                           .paint = m_GPUTimer.getTime(GPUScope::paint),
+                           .ui = m_GPUTimer.getTime(GPUScope::ui),
+                           .swap = m_GPUTimer.getTime(GPUScope::swap)});
+
 #if defined(__EMSCRIPTEN__)
   // Force window size in windowed mode
   EmscriptenFullscreenChangeEvent fullscreenStatus{};
@@ -441,23 +491,47 @@ void abcg::OpenGLWindow::paint() {
   ImGui_ImplSDL2_NewFrame();
   ImGui::NewFrame();
 
-  onPaintUI();
+  {
+    ABCG_PROFILE_ZONE("onPaintUI");
+    onPaintUI();
+  }
 
-  ImGui::Render();
+  {
+    ABCG_PROFILE_ZONE("ImGui::Render");
+    ImGui::Render();
+  }
 
-  onPaint();
+  {
+    ABCG_PROFILE_ZONE("onPaint");
+    m_GPUTimer.begin(GPUScope::paint);
+    onPaint();
+    m_GPUTimer.end(GPUScope::paint);
+  }
+
+  {
+    ABCG_PROFILE_ZONE("ImGui render");
+    m_GPUTimer.begin(GPUScope::ui);
+    ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+    m_GPUTimer.end(GPUScope::ui);
+  }
 
-  ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+  ABCG_PROFILE_ZONE("Swap");
+  m_GPUTimer.begin(GPUScope::swap);
   if (m_openGLSettings.doubleBuffering) {
     SDL_GL_SwapWindow(abcg::Window::getSDLWindow());
   } else {
     glFinish();
   }
+  m_GPUTimer.end(GPUScope::swap);
 }
 
 void abcg::OpenGLWindow::destroy() {
   onDestroy();
 
+  // Delete pooled objects while the context is still current
+  abcg::OpenGLObjectPool::getInstance().clear();
+  m_GPUTimer.destroy();
+
   if (ImGui::GetCurrentContext() != nullptr) {
     ImGui_ImplOpenGL3_Shutdown();
     ImGui_ImplSDL2_Shutdown();
@@ -17,6 +17,7 @@
 
 #include "abcgExternal.hpp"
 #include "abcgOpenGLFunction.hpp"
+#include "abcgOpenGLGPUTimer.hpp"
 #include "abcgWindow.hpp"
 
 namespace abcg {
@@ -121,6 +122,7 @@ private:
   OpenGLSettings m_openGLSettings;
   std::string m_GLSLVersion;
   SDL_GLContext m_GLContext{};
+  OpenGLGPUTimer m_GPUTimer;
   bool m_hidden{};
   bool m_minimized{};
 };
@@ -0,0 +1,158 @@
+/**
+ * @file abcgProfiler.cpp
+ * @brief Definition of abcg::Profiler members.
+ *
+ * This file is part of ABCg (https://github.com/hbatagelo/abcg).
+ *
+ * @copyright (c) 2021--2022 Harlen Batagelo. All rights reserved.
+ * This project is released under the MIT License.
+ */
+
+#include "abcgProfiler.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <limits>
+#include <string_view>
+
+#include <cppitertools/itertools.hpp>
+#include <fmt/core.h>
+#include <gsl/gsl>
+
+#include "abcgException.hpp"
+#include "abcgUtil.hpp"
+
+/**
+ * @brief Returns the profiler of the application.
+ *
+ * @return Reference to the profiler.
+ */
+abcg::Profiler &abcg::Profiler::getInstance() {
+  static Profiler profiler;
+  return profiler;
+}
+
+/**
+ * @brief Returns the current time of the profiler clock.
+ *
+ * @return Time, in nanoseconds of `std::chrono::steady_clock`.
+ */
+std::uint64_t abcg::Profiler::now() noexcept {
+  using namespace std::chrono;
+  return gsl::narrow_cast<std::uint64_t>(
+      duration_cast<nanoseconds>(steady_clock::now().time_since_epoch())
+          .count());
+}
+
+/**
+ * @brief Records a zone into the ring of the calling thread.
+ *
+ * @param zone Zone to be recorded.
+ */
+void abcg::Profiler::record(ProfilerZone const &zone) {
+  auto &ring{getThreadRing()};
+  auto const count{ring.count.load(std::memory_order_relaxed)};
+  ring.zones.at(count % ringCapacity) = zone;
+  ring.count.store(count + 1, std::memory_order_release);
+}
+
+/**
+ * @brief Returns the zones recorded by a thread, from the oldest to the
+ * newest.
+ *
+ * Zones being overwritten while the thread is still recording may be
+ * inconsistent.
+ *
+ * @param thread Index of the thread, in the order in which the threads
+ * recorded their first zone.
+ *
+ * @return Copy of the zones in the ring of the thread, or an empty vector if
+ * the index is invalid.
+ */
+std::vector<abcg::ProfilerZone>
+abcg::Profiler::getZones(std::size_t thread) const {
+  ThreadRing const *ring{};
+  {
+    std::scoped_lock const lock{m_mutex};
+    if (thread >= m_rings.size())
+      return {};
+    ring = m_rings[thread].get();
+  }
+
+  auto const count{ring->count.load(std::memory_order_acquire)};
+  auto const size{std::min<std::uint64_t>(count, ringCapacity)};
+
+  std::vector<ProfilerZone> zones;
+  zones.reserve(gsl::narrow<std::size_t>(size));
+  for (auto index{count - size}; index < count; ++index) {
+    zones.push_back(ring->zones.at(index % ringCapacity));
+  }
+  return zones;
+}
+
+/**
+ * @brief Writes the zones of all threads to a file in the Chrome trace event
+ * format.
+ *
+ * The file can be opened in `chrome://tracing` or https://ui.perfetto.dev.
+ * Times are relative to the oldest zone.
+ *
+ * @param path Path of the JSON file. An existing file is overwritten.
+ *
+ * @throw abcg::RuntimeError if the file could not be created.
+ */
+void abcg::Profiler::exportChromeTrace(std::string const &path) const {
+  std::vector<std::vector<ProfilerZone>> threads;
+  {
+    std::scoped_lock const lock{m_mutex};
+    threads.resize(m_rings.size());
+  }
+  auto origin{std::numeric_limits<std::uint64_t>::max()};
+  for (auto &&[index, zones] : iter::enumerate(threads)) {
+    zones = getZones(index);
+    // Zones are recorded when they end, so enclosing zones come later
+    for (auto const &zone : zones) {
+      origin = std::min(origin, zone.begin);
+    }
+  }
+
+  std::ofstream stream(path, std::ios::trunc);
+  if (!stream) {
+    throw abcg::RuntimeError(
+        fmt::format("Failed to create profiler trace {}", path));
+  }
+
+  auto const microseconds{[](std::uint64_t nanoseconds) {
+    return gsl::narrow_cast<double>(nanoseconds) / 1000.0;
+  }};
+
+  stream << R"({"displayTimeUnit":"ms","traceEvents":[)";
+  auto separator{""};
+  for (auto &&[thread, zones] : iter::enumerate(threads)) {
+    for (auto const &zone : zones) {
+      stream << fmt::format(
+          R"({}{{"name":"{}","ph":"X","pid":0,"tid":{},"ts":{:.3f},)"
+          R"("dur":{:.3f})",
+          separator, abcg::escapeJSON(zone.name), thread,
+          microseconds(zone.begin - origin),
+          microseconds(zone.end - zone.begin));
+      if (AllocationTracker::isEnabled()) {
+        stream << fmt::format(R"(,"args":{{"allocations":{},"bytes":{}}})",
+                              zone.allocations.count, zone.allocations.bytes);
+      }
+      stream << "}";
+      separator = ",\n";
+    }
+  }
+  stream << "]}\n";
+}
+
+abcg::Profiler::ThreadRing &abcg::Profiler::getThreadRing() {
+  thread_local ThreadRing *threadRing{};
+  if (threadRing == nullptr) {
+    std::scoped_lock const lock{m_mutex};
+    threadRing = m_rings.emplace_back(std::make_unique<ThreadRing>()).get();
+  }
+  return *threadRing;
+}
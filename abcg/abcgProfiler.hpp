@@ -0,0 +1,169 @@
+/**
+ * @file abcgProfiler.hpp
+ * @brief Header file of abcg::Profiler and abcg::ProfilerScope.
+ *
+ * Declaration of the CPU profiler and of the ABCG_PROFILE_ZONE macro.
+ *
+ * This file is part of ABCg (https://github.com/hbatagelo/abcg).
+ *
+ * @copyright (c) 2021--2022 Harlen Batagelo. All rights reserved.
+ * This project is released under the MIT License.
+ */
+
+#ifndef ABCG_PROFILER_HPP_
+#define ABCG_PROFILER_HPP_
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "abcgAllocationTracker.hpp"
+
+namespace abcg {
+struct ProfilerZone;
+class Profiler;
+class ProfilerScope;
+} // namespace abcg
+
+/**
+ * @brief Time interval of a profiling zone.
+ */
+struct abcg::ProfilerZone {
+  /** @brief Zone name. Must be a string with static storage duration. */
+  char const *name{};
+  /** @brief Start time, in nanoseconds of `std::chrono::steady_clock`. */
+  std::uint64_t begin{};
+  /** @brief End time, in nanoseconds of `std::chrono::steady_clock`. */
+  std::uint64_t end{};
+  /** @brief Heap allocations of the thread during the zone, including its
+   * nested zones. Zero unless ABCg was built with
+   * `ENABLE_ALLOCATION_TRACKER`. */
+  AllocationStatistics allocations{};
+};
+
+/**
+ * @brief Collects the profiling zones of all threads.
+ *
+ * Each thread records its zones into its own ring buffer, so that recording
+ * does not take locks nor allocate memory. Only the first zone of a thread
+ * takes a lock to register the ring. When a ring is full, the oldest zones
+ * are overwritten.
+ *
+ * Zones are usually recorded with ABCG_PROFILE_ZONE. The capture can be saved
+ * with abcg::Profiler::exportChromeTrace, or by launching the application
+ * with `--profile <file>`, and opened in `chrome://tracing` or
+ * https://ui.perfetto.dev.
+ */
+class abcg::Profiler {
+public:
+  /** @brief Number of zones kept per thread. */
+  static constexpr std::size_t ringCapacity{std::size_t{1} << 15U};
+
+  [[nodiscard]] static Profiler &getInstance();
+  [[nodiscard]] static std::uint64_t now() noexcept;
+
+  void record(ProfilerZone const &zone);
+  [[nodiscard]] std::vector<ProfilerZone> getZones(std::size_t thread) const;
+  void exportChromeTrace(std::string const &path) const;
+
+  /**
+   * @brief Whether zones are recorded by ABCG_PROFILE_ZONE.
+   *
+   * @return `true` if ABCg was built with `ENABLE_PROFILER`.
+   */
+  [[nodiscard]] static constexpr bool isEnabled() noexcept {
+#if defined(ABCG_PROFILER)
+    return true;
+#else
+    return false;
+#endif
+  }
+
+private:
+  // Single-producer ring. Only the owner thread writes zones; the number of
+  // zones ever written is published with release semantics
+  struct ThreadRing {
+    std::array<ProfilerZone, ringCapacity> zones{};
+    std::atomic<std::uint64_t> count{};
+  };
+
+  [[nodiscard]] ThreadRing &getThreadRing();
+
+  mutable std::mutex m_mutex;
+  std::vector<std::unique_ptr<ThreadRing>> m_rings;
+};
+
+/**
+ * @brief Records a profiling zone from its construction to its destruction.
+ *
+ * Usually created with ABCG_PROFILE_ZONE.
+ */
+class abcg::ProfilerScope {
+public:
+  /**
+   * @brief Starts the zone.
+   *
+   * @param name Zone name. Must be a string with static storage duration,
+   * such as a string literal.
+   */
+  explicit ProfilerScope(char const *name) noexcept
+      : m_name{name}, m_allocations{AllocationTracker::getThreadTotal()},
+        m_begin{Profiler::now()} {}
+  ProfilerScope(ProfilerScope const &) = delete;
+  ProfilerScope(ProfilerScope &&) = delete;
+  ProfilerScope &operator=(ProfilerScope const &) = delete;
+  ProfilerScope &operator=(ProfilerScope &&) = delete;
+
+  /**
+   * @brief Ends the zone and records it.
+   */
+  ~ProfilerScope() {
+    auto const end{Profiler::now()};
+    Profiler::getInstance().record(
+        {.name = m_name,
+         .begin = m_begin,
+         .end = end,
+         .allocations = AllocationTracker::getThreadTotal() - m_allocations});
+  }
+
+private:
+  char const *m_name{};
+  AllocationStatistics m_allocations{};
+  std::uint64_t m_begin{};
+};
+
+// @cond Skipped by Doxygen
+#define ABCG_PROFILE_CONCAT_IMPL(a, b) a##b
+#define ABCG_PROFILE_CONCAT(a, b) ABCG_PROFILE_CONCAT_IMPL(a, b)
+// @endcond
+
+/**
+ * @brief Records a profiling zone from this point to the end of the enclosing
+ * scope.
+ *
+ * @code
+ * void Window::onUpdate() {
+ *   ABCG_PROFILE_ZONE("Window::onUpdate");
+ *   // ...
+ * }
+ * @endcode
+ *
+ * This expands to nothing unless ABCg is built with `ENABLE_PROFILER`, which
+ * defines `ABCG_PROFILER`.
+ *
+ * @param name Zone name, as a string literal.
+ */
+#if defined(ABCG_PROFILER)
+#define ABCG_PROFILE_ZONE(name)                                                \
+  abcg::ProfilerScope const ABCG_PROFILE_CONCAT(abcgProfilerScope,             \
+                                                __LINE__){name}
+#else
+#define ABCG_PROFILE_ZONE(name) static_cast<void>(0)
+#endif
+
+#endif
@@ -11,9 +11,13 @@
 #ifndef ABCG_UTIL_HPP_
 #define ABCG_UTIL_HPP_
 
+#include <cstdint>
 #include <functional>
+#include <string>
+#include <string_view>
 
 namespace abcg {
+class StringHash;
 
 /**
  * @brief Creates a hash value from several values, combining them with a seed
@@ -68,6 +72,94 @@ std::size_t hashCombine(const TFirst &value, const TRest &...rest) {
   return seed;
 }
 
+/**
+ * @brief Escapes a string to be written as a JSON string.
+ *
+ * Quotes and backslashes are preceded by a backslash, and control characters
+ * are written as `\u00XX`.
+ *
+ * @param text String to be escaped.
+ *
+ * @return Escaped string, without the enclosing quotes.
+ */
+inline std::string escapeJSON(std::string_view text) {
+  constexpr std::string_view hexDigits{"0123456789abcdef"};
+  std::string escaped;
+  escaped.reserve(text.size());
+  for (auto const character : text) {
+    std::size_t const code{static_cast<unsigned char>(character)};
+    if (code < 0x20) {
+      escaped += "\\u00";
+      escaped += hexDigits[code >> 4U];
+      escaped += hexDigits[code & 0xFU];
+      continue;
+    }
+    if (character == '"' || character == '\\')
+      escaped += '\\';
+    escaped += character;
+  }
+  return escaped;
+}
+
 } // namespace abcg
 
+/**
+ * @brief 64-bit FNV-1a hash of a string.
+ *
+ * A string literal converts implicitly to abcg::StringHash and is hashed at
+ * compile time, so that functions taking an abcg::StringHash can be called as
+ * in `program.getUniformLocation("color")` without hashing at run time.
+ * Strings known only at run time are hashed with abcg::StringHash::fromString.
+ */
+class abcg::StringHash {
+public:
+  /**
+   * @brief Hashes a string literal at compile time.
+   *
+   * @param string Null-terminated string.
+   */
+  // NOLINTNEXTLINE(google-explicit-constructor, hicpp-explicit-conversions)
+  consteval StringHash(char const *string) noexcept
+      : m_value{fnv1a(string)} {}
+
+  /**
+   * @brief Hashes a string at run time.
+   *
+   * @param string String to be hashed.
+   *
+   * @return Hash of the string.
+   */
+  [[nodiscard]] static constexpr StringHash
+  fromString(std::string_view string) noexcept {
+    return StringHash{fnv1a(string), 0};
+  }
+
+  /**
+   * @brief Returns the hash value.
+   *
+   * @return 64-bit hash value.
+   */
+  [[nodiscard]] constexpr std::uint64_t getValue() const noexcept {
+    return m_value;
+  }
+
+  friend constexpr bool operator==(StringHash, StringHash) noexcept = default;
+
+private:
+  constexpr StringHash(std::uint64_t value, int /*tag*/) noexcept
+      : m_value{value} {}
+
+  [[nodiscard]] static constexpr std::uint64_t
+  fnv1a(std::string_view string) noexcept {
+    std::uint64_t hash{0xcbf29ce484222325};
+    for (auto const character : string) {
+      hash ^= static_cast<std::uint8_t>(character);
+      hash *= 0x100000001b3;
+    }
+    return hash;
+  }
+
+  std::uint64_t m_value{};
+};
+
 #endif
\ No newline at end of file
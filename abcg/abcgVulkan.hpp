@@ -17,6 +17,7 @@
 
 #include "abcg.hpp"
 #include "abcgVulkanBuffer.hpp"
+#include "abcgVulkanGPUCulling.hpp"
 #include "abcgVulkanImage.hpp"
 #include "abcgVulkanPipeline.hpp"
 #include "abcgVulkanShader.hpp"
@@ -60,6 +60,10 @@ void abcg::VulkanBuffer::create(VulkanDevice const &device,
     // Release staging buffer
     m_device.destroyBuffer(stagingBuffer);
     m_device.freeMemory(stagingBufferMemory);
+  } else {
+    // Device local buffer written by the GPU (e.g., by a compute shader)
+    std::tie(m_buffer, m_deviceMemory) = createBuffer(
+        device, createInfo.size, createInfo.usage, createInfo.properties);
   }
 }
 
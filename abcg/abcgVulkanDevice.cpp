@@ -12,6 +12,7 @@
 
 #include <gsl/gsl>
 
+#include <algorithm>
 #include <set>
 
 #include "abcgException.hpp"
@@ -19,6 +20,7 @@
 void abcg::VulkanDevice::create(VulkanPhysicalDevice const &physicalDevice,
                                 std::vector<char const *> const &extensions) {
   m_physicalDevice = physicalDevice;
+  m_extensions.assign(extensions.begin(), extensions.end());
   auto const &queuesFamilies{m_physicalDevice.getQueuesFamilies()};
 
   std::set uniqueQueueFamilies{queuesFamilies.graphics.value(),
@@ -74,6 +76,18 @@ void abcg::VulkanDevice::destroy() {
   m_device.destroy();
 }
 
+/**
+ * @brief Returns whether a device extension was enabled at creation.
+ *
+ * @param extension Extension name (e.g.,
+ * `VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME`).
+ *
+ * @return `true` if the extension is enabled.
+ */
+bool abcg::VulkanDevice::isExtensionEnabled(std::string_view extension) const {
+  return std::ranges::find(m_extensions, extension) != m_extensions.end();
+}
+
 /**
  * @brief Allocates and creates a command buffer to be immediately submitted and
  * released.
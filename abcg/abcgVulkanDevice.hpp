@@ -13,6 +13,10 @@
 #ifndef ABCG_VULKAN_DEVICE_HPP_
 #define ABCG_VULKAN_DEVICE_HPP_
 
+#include <string>
+#include <string_view>
+#include <vector>
+
 #include "abcgVulkanExternal.hpp"
 #include "abcgVulkanPhysicalDevice.hpp"
 
@@ -89,6 +93,8 @@ public:
     return m_commandPools;
   }
 
+  [[nodiscard]] bool isExtensionEnabled(std::string_view extension) const;
+
   void withCommandBuffer(
       std::function<void(vk::CommandBuffer const &commandBuffer)> const &fun,
       vk::QueueFlagBits queueFlag = vk::QueueFlagBits::eGraphics,
@@ -102,6 +108,7 @@ private:
   VulkanPhysicalDevice m_physicalDevice{};
   VulkanCommandPools m_commandPools{};
   VulkanQueues m_queues{};
+  std::vector<std::string> m_extensions{};
 };
 
 #endif
\ No newline at end of file
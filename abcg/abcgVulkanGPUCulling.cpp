@@ -0,0 +1,360 @@
+/**
+ * @file abcgVulkanGPUCulling.cpp
+ * @brief Definition of abcg::VulkanGPUCulling members.
+ *
+ * This file is part of ABCg (https://github.com/hbatagelo/abcg).
+ *
+ * @copyright (c) 2021--2022 Harlen Batagelo. All rights reserved.
+ * This project is released under the MIT License.
+ */
+
+#include "abcgVulkanGPUCulling.hpp"
+
+#include <array>
+
+#include <cppitertools/itertools.hpp>
+#include <gsl/gsl>
+
+#include "abcgBVH.hpp"
+#include "abcgException.hpp"
+#include "abcgVulkanShader.hpp"
+
+namespace {
+
+constexpr std::uint32_t workgroupSize{64};
+
+// Must match the push constant block of the culling shader
+struct PushConstants {
+  std::array<glm::vec4, abcg::Frustum::planeCount> planes{};
+  std::uint32_t objectCount{};
+  // Whether visible objects are compacted with an atomic counter
+  std::uint32_t compact{};
+};
+
+static_assert(sizeof(abcg::VulkanCullObject) == 32);
+static_assert(sizeof(abcg::VulkanCullMesh) == 16);
+static_assert(sizeof(vk::DrawIndexedIndirectCommand) == 20);
+
+constexpr auto cullShaderSource{R"glsl(#version 450
+
+layout(local_size_x = 64) in;
+
+struct Object {
+  vec3 boundsMin;
+  uint mesh;
+  vec3 boundsMax;
+  uint padding;
+};
+
+struct Mesh {
+  uint indexCount;
+  uint firstIndex;
+  int vertexOffset;
+  uint padding;
+};
+
+struct DrawCommand {
+  uint indexCount;
+  uint instanceCount;
+  uint firstIndex;
+  int vertexOffset;
+  uint firstInstance;
+};
+
+layout(std430, binding = 0) readonly buffer Objects { Object objects[]; };
+layout(std430, binding = 1) readonly buffer Meshes { Mesh meshes[]; };
+layout(std430, binding = 2) writeonly buffer Commands {
+  DrawCommand commands[];
+};
+layout(std430, binding = 3) buffer Count { uint drawCount; };
+
+layout(push_constant) uniform PushConstants {
+  vec4 planes[6];
+  uint objectCount;
+  uint compact;
+};
+
+void main() {
+  uint index = gl_GlobalInvocationID.x;
+  if (index >= objectCount) return;
+
+  Object object = objects[index];
+  vec3 center = (object.boundsMin + object.boundsMax) * 0.5;
+  vec3 extent = (object.boundsMax - object.boundsMin) * 0.5;
+
+  bool visible = true;
+  for (int plane = 0; plane < 6; ++plane) {
+    float distance = dot(planes[plane].xyz, center) + planes[plane].w;
+    float radius = dot(abs(planes[plane].xyz), extent);
+    if (distance + radius < 0.0) {
+      visible = false;
+      break;
+    }
+  }
+
+  Mesh mesh = meshes[object.mesh];
+  if (compact != 0u) {
+    if (!visible) return;
+    uint slot = atomicAdd(drawCount, 1u);
+    commands[slot] = DrawCommand(mesh.indexCount, 1u, mesh.firstIndex,
+                                 mesh.vertexOffset, index);
+  } else {
+    commands[index] = DrawCommand(mesh.indexCount, visible ? 1u : 0u,
+                                  mesh.firstIndex, mesh.vertexOffset, index);
+    if (visible) atomicAdd(drawCount, 1u);
+  }
+})glsl"};
+
+} // namespace
+
+/**
+ * @brief Uploads the objects and meshes and creates the culling pipeline.
+ *
+ * @param device Vulkan device.
+ * @param createInfo Objects and meshes.
+ *
+ * @throw abcg::RuntimeError if there are no objects, if an object references
+ * an invalid mesh, or if the device does not support the
+ * `drawIndirectFirstInstance` feature.
+ */
+void abcg::VulkanGPUCulling::create(
+    VulkanDevice const &device, VulkanGPUCullingCreateInfo const &createInfo) {
+  destroy();
+
+  if (createInfo.objects.empty() || createInfo.meshes.empty()) {
+    throw abcg::RuntimeError("GPU culling requires objects and meshes");
+  }
+  for (auto const &object : createInfo.objects) {
+    if (object.mesh >= createInfo.meshes.size()) {
+      throw abcg::RuntimeError("Invalid GPU culling mesh index");
+    }
+  }
+
+  auto const features{
+      static_cast<vk::PhysicalDevice>(device.getPhysicalDevice())
+          .getFeatures()};
+  if (features.drawIndirectFirstInstance != VK_TRUE) {
+    throw abcg::RuntimeError(
+        "GPU culling requires the drawIndirectFirstInstance feature");
+  }
+
+  m_device = static_cast<vk::Device>(device);
+  m_objectCount = gsl::narrow<std::uint32_t>(createInfo.objects.size());
+  m_drawCountSupported =
+      device.isExtensionEnabled(VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME);
+  m_multiDrawSupported = features.multiDrawIndirect == VK_TRUE;
+
+  // Static data, uploaded once through a staging buffer
+  m_objectBuffer.create(
+      device, {.size = createInfo.objects.size_bytes(),
+               .usage = vk::BufferUsageFlagBits::eStorageBuffer,
+               .properties = vk::MemoryPropertyFlagBits::eDeviceLocal,
+               .data = createInfo.objects.data()});
+  m_meshBuffer.create(
+      device, {.size = createInfo.meshes.size_bytes(),
+               .usage = vk::BufferUsageFlagBits::eStorageBuffer,
+               .properties = vk::MemoryPropertyFlagBits::eDeviceLocal,
+               .data = createInfo.meshes.data()});
+
+  // Written by the culling shader, read by the indirect draw
+  m_commandBuffer.create(
+      device,
+      {.size = m_objectCount * sizeof(vk::DrawIndexedIndirectCommand),
+       .usage = vk::BufferUsageFlagBits::eStorageBuffer |
+                vk::BufferUsageFlagBits::eIndirectBuffer,
+       .properties = vk::MemoryPropertyFlagBits::eDeviceLocal});
+  m_countBuffer.create(
+      device, {.size = sizeof(std::uint32_t),
+               .usage = vk::BufferUsageFlagBits::eStorageBuffer |
+                        vk::BufferUsageFlagBits::eIndirectBuffer |
+                        vk::BufferUsageFlagBits::eTransferDst,
+               .properties = vk::MemoryPropertyFlagBits::eDeviceLocal});
+
+  createPipeline(device);
+  createDescriptorSet();
+}
+
+/**
+ * @brief Releases the buffers and the culling pipeline.
+ */
+void abcg::VulkanGPUCulling::destroy() {
+  if (!m_device) {
+    return;
+  }
+
+  m_device.waitIdle();
+  m_device.destroyPipeline(m_pipeline);
+  m_device.destroyPipelineLayout(m_pipelineLayout);
+  m_device.destroyDescriptorPool(m_descriptorPool);
+  m_device.destroyDescriptorSetLayout(m_descriptorSetLayout);
+  m_countBuffer.destroy();
+  m_commandBuffer.destroy();
+  m_meshBuffer.destroy();
+  m_objectBuffer.destroy();
+
+  m_device = vk::Device{};
+  m_objectCount = 0;
+}
+
+/**
+ * @brief Records the culling of the objects against a view frustum.
+ *
+ * This must be recorded outside of a render pass, before
+ * abcg::VulkanGPUCulling::draw.
+ *
+ * @param commandBuffer Command buffer in the recording state.
+ * @param viewProjMatrix Product of the projection matrix and the view matrix.
+ */
+void abcg::VulkanGPUCulling::cull(vk::CommandBuffer const &commandBuffer,
+                                  glm::mat4 const &viewProjMatrix) const {
+  // The commands and the count may still be read by the draws of a previous
+  // frame
+  commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eDrawIndirect,
+                                vk::PipelineStageFlagBits::eTransfer |
+                                    vk::PipelineStageFlagBits::eComputeShader,
+                                {}, {}, {}, {});
+
+  auto const countBuffer{static_cast<vk::Buffer>(m_countBuffer)};
+  commandBuffer.fillBuffer(countBuffer, 0, sizeof(std::uint32_t), 0);
+  commandBuffer.pipelineBarrier(
+      vk::PipelineStageFlagBits::eTransfer,
+      vk::PipelineStageFlagBits::eComputeShader, {}, {},
+      vk::BufferMemoryBarrier{
+          .srcAccessMask = vk::AccessFlagBits::eTransferWrite,
+          .dstAccessMask = vk::AccessFlagBits::eShaderRead |
+                           vk::AccessFlagBits::eShaderWrite,
+          .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+          .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+          .buffer = countBuffer,
+          .size = VK_WHOLE_SIZE},
+      {});
+
+  Frustum const frustum{viewProjMatrix};
+  PushConstants pushConstants{.objectCount = m_objectCount,
+                              .compact = m_drawCountSupported ? 1U : 0U};
+  for (auto const index : iter::range(Frustum::planeCount)) {
+    pushConstants.planes.at(index) = frustum.getPlane(index);
+  }
+
+  commandBuffer.bindPipeline(vk::PipelineBindPoint::eCompute, m_pipeline);
+  commandBuffer.bindDescriptorSets(vk::PipelineBindPoint::eCompute,
+                                   m_pipelineLayout, 0, m_descriptorSet, {});
+  commandBuffer.pushConstants(m_pipelineLayout,
+                              vk::ShaderStageFlagBits::eCompute, 0,
+                              sizeof(pushConstants), &pushConstants);
+  commandBuffer.dispatch((m_objectCount + workgroupSize - 1) / workgroupSize,
+                         1, 1);
+
+  std::array const barriers{
+      vk::BufferMemoryBarrier{
+          .srcAccessMask = vk::AccessFlagBits::eShaderWrite,
+          .dstAccessMask = vk::AccessFlagBits::eIndirectCommandRead,
+          .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+          .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+          .buffer = static_cast<vk::Buffer>(m_commandBuffer),
+          .size = VK_WHOLE_SIZE},
+      vk::BufferMemoryBarrier{
+          .srcAccessMask = vk::AccessFlagBits::eShaderWrite,
+          .dstAccessMask = vk::AccessFlagBits::eIndirectCommandRead,
+          .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+          .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+          .buffer = countBuffer,
+          .size = VK_WHOLE_SIZE}};
+  commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eComputeShader,
+                                vk::PipelineStageFlagBits::eDrawIndirect, {},
+                                {}, barriers, {});
+}
+
+/**
+ * @brief Records the indirect draw of the visible objects.
+ *
+ * This must be recorded inside the main render pass, after binding the
+ * graphics pipeline, the vertex buffers and the index buffer shared by the
+ * meshes.
+ *
+ * @param commandBuffer Command buffer in the recording state.
+ */
+void abcg::VulkanGPUCulling::draw(
+    vk::CommandBuffer const &commandBuffer) const {
+  auto const stride{
+      gsl::narrow<std::uint32_t>(sizeof(vk::DrawIndexedIndirectCommand))};
+  auto const buffer{static_cast<vk::Buffer>(m_commandBuffer)};
+
+  if (m_drawCountSupported) {
+    commandBuffer.drawIndexedIndirectCountKHR(
+        buffer, 0, static_cast<vk::Buffer>(m_countBuffer), 0, m_objectCount,
+        stride);
+  } else if (m_multiDrawSupported) {
+    commandBuffer.drawIndexedIndirect(buffer, 0, m_objectCount, stride);
+  } else {
+    for (auto const index : iter::range(m_objectCount)) {
+      commandBuffer.drawIndexedIndirect(buffer, index * stride, 1, stride);
+    }
+  }
+}
+
+void abcg::VulkanGPUCulling::createPipeline(VulkanDevice const &device) {
+  std::array<vk::DescriptorSetLayoutBinding, 4> bindings{};
+  for (auto &&[binding, layoutBinding] : iter::enumerate(bindings)) {
+    layoutBinding = {.binding = gsl::narrow<std::uint32_t>(binding),
+                     .descriptorType = vk::DescriptorType::eStorageBuffer,
+                     .descriptorCount = 1,
+                     .stageFlags = vk::ShaderStageFlagBits::eCompute};
+  }
+  m_descriptorSetLayout = m_device.createDescriptorSetLayout(
+      {.bindingCount = gsl::narrow<std::uint32_t>(bindings.size()),
+       .pBindings = bindings.data()});
+
+  vk::PushConstantRange const pushConstantRange{
+      .stageFlags = vk::ShaderStageFlagBits::eCompute,
+      .offset = 0,
+      .size = sizeof(PushConstants)};
+  m_pipelineLayout = m_device.createPipelineLayout(
+      {.setLayoutCount = 1,
+       .pSetLayouts = &m_descriptorSetLayout,
+       .pushConstantRangeCount = 1,
+       .pPushConstantRanges = &pushConstantRange});
+
+  VulkanShader shader;
+  shader.create(device,
+                {.source = cullShaderSource, .stage = ShaderStage::Compute});
+
+  auto result{m_device.createComputePipeline(
+      {}, {.stage = {.stage = shader.getStage(),
+                     .module = shader.getModule(),
+                     .pName = "main"},
+           .layout = m_pipelineLayout})};
+  shader.destroy();
+  m_pipeline = result.value;
+}
+
+void abcg::VulkanGPUCulling::createDescriptorSet() {
+  vk::DescriptorPoolSize const poolSize{
+      .type = vk::DescriptorType::eStorageBuffer, .descriptorCount = 4};
+  m_descriptorPool = m_device.createDescriptorPool(
+      {.maxSets = 1, .poolSizeCount = 1, .pPoolSizes = &poolSize});
+
+  m_descriptorSet =
+      m_device
+          .allocateDescriptorSets({.descriptorPool = m_descriptorPool,
+                                   .descriptorSetCount = 1,
+                                   .pSetLayouts = &m_descriptorSetLayout})
+          .front();
+
+  // Bindings 0 to 3 of the culling shader
+  std::array const buffers{&m_objectBuffer, &m_meshBuffer, &m_commandBuffer,
+                           &m_countBuffer};
+  std::array<vk::DescriptorBufferInfo, buffers.size()> bufferInfos{};
+  std::array<vk::WriteDescriptorSet, buffers.size()> writes{};
+  for (auto const binding : iter::range(buffers.size())) {
+    bufferInfos.at(binding) = {
+        .buffer = static_cast<vk::Buffer>(*buffers.at(binding)),
+        .range = VK_WHOLE_SIZE};
+    writes.at(binding) = {.dstSet = m_descriptorSet,
+                          .dstBinding = gsl::narrow<std::uint32_t>(binding),
+                          .descriptorCount = 1,
+                          .descriptorType = vk::DescriptorType::eStorageBuffer,
+                          .pBufferInfo = &bufferInfos.at(binding)};
+  }
+  m_device.updateDescriptorSets(writes, {});
+}
@@ -0,0 +1,184 @@
+/**
+ * @file abcgVulkanGPUCulling.hpp
+ * @brief Header file of abcg::VulkanGPUCulling.
+ *
+ * Declaration of abcg::VulkanGPUCulling and related structures.
+ *
+ * This file is part of ABCg (https://github.com/hbatagelo/abcg).
+ *
+ * @copyright (c) 2021--2022 Harlen Batagelo. All rights reserved.
+ * This project is released under the MIT License.
+ */
+
+#ifndef ABCG_VULKAN_GPU_CULLING_HPP_
+#define ABCG_VULKAN_GPU_CULLING_HPP_
+
+#include <cstdint>
+#include <span>
+
+#include <glm/mat4x4.hpp>
+#include <glm/vec3.hpp>
+
+#include "abcgVulkanBuffer.hpp"
+#include "abcgVulkanDevice.hpp"
+
+namespace abcg {
+struct VulkanCullObject;
+struct VulkanCullMesh;
+struct VulkanGPUCullingCreateInfo;
+class VulkanGPUCulling;
+} // namespace abcg
+
+/**
+ * @brief Static object culled by abcg::VulkanGPUCulling.
+ *
+ * The layout matches the `std430` structure read by the culling shader.
+ */
+struct abcg::VulkanCullObject {
+  /** @brief Minimum corner of the world-space bounding box. */
+  glm::vec3 boundsMin{};
+  /** @brief Index of the mesh in abcg::VulkanGPUCullingCreateInfo::meshes. */
+  std::uint32_t mesh{};
+  /** @brief Maximum corner of the world-space bounding box. */
+  glm::vec3 boundsMax{};
+  /** @brief Unused. */
+  std::uint32_t padding{};
+};
+
+/**
+ * @brief Range of a mesh in the index buffer bound by the application.
+ *
+ * The layout matches the `std430` structure read by the culling shader.
+ */
+struct abcg::VulkanCullMesh {
+  /** @brief Number of indices. */
+  std::uint32_t indexCount{};
+  /** @brief Position of the first index in the index buffer. */
+  std::uint32_t firstIndex{};
+  /** @brief Value added to the indices before fetching the vertices. */
+  std::int32_t vertexOffset{};
+  /** @brief Unused. */
+  std::uint32_t padding{};
+};
+
+/**
+ * @brief Creation info structure for abcg::VulkanGPUCulling::create.
+ */
+struct abcg::VulkanGPUCullingCreateInfo {
+  /** @brief Meshes referenced by the objects. */
+  std::span<VulkanCullMesh const> meshes{};
+  /** @brief Objects to be culled. They are uploaded once to device local
+   * memory. */
+  std::span<VulkanCullObject const> objects{};
+};
+
+/**
+ * @brief GPU-driven frustum culling and indirect drawing of static objects.
+ *
+ * The objects and meshes are uploaded once to device local storage buffers.
+ * Each frame, abcg::VulkanGPUCulling::cull records a compute dispatch that
+ * tests the bounding box of every object against the view frustum and writes
+ * a `VkDrawIndexedIndirectCommand` for each visible object, plus the number of
+ * visible objects. abcg::VulkanGPUCulling::draw then records a single
+ * `vkCmdDrawIndexedIndirectCountKHR` that draws them. The only data sent by
+ * the CPU each frame are the frustum planes, as push constants.
+ *
+ * The `firstInstance` of each command is the index of the object, so that the
+ * vertex shader can fetch per-object data (e.g., the model matrix) from a
+ * storage buffer owned by the application:
+ * @code
+ * layout(std430, set = 0, binding = 0) readonly buffer ObjectData {
+ *   mat4 modelMatrix[];
+ * };
+ * // ... modelMatrix[gl_InstanceIndex] ...
+ * @endcode
+ *
+ * The culling must be recorded outside of a render pass:
+ * @code
+ * void Window::onPaint(abcg::VulkanFrame const &frame) {
+ *   auto const &commandBuffer{frame.commandBuffer};
+ *   commandBuffer.begin({});
+ *   m_culling.cull(commandBuffer, m_projMatrix * m_viewMatrix);
+ *   commandBuffer.beginRenderPass(...);
+ *   commandBuffer.bindPipeline(...);
+ *   commandBuffer.bindVertexBuffers(...);
+ *   commandBuffer.bindIndexBuffer(...);
+ *   m_culling.draw(commandBuffer);
+ *   commandBuffer.endRenderPass();
+ *   commandBuffer.end();
+ * }
+ * @endcode
+ *
+ * If `VK_KHR_draw_indirect_count` is not supported, the shader writes one
+ * command per object, with zero instances for culled objects, and the commands
+ * are drawn with `vkCmdDrawIndexedIndirect`.
+ */
+class abcg::VulkanGPUCulling {
+public:
+  void create(VulkanDevice const &device,
+              VulkanGPUCullingCreateInfo const &createInfo);
+  void destroy();
+
+  void cull(vk::CommandBuffer const &commandBuffer,
+            glm::mat4 const &viewProjMatrix) const;
+  void draw(vk::CommandBuffer const &commandBuffer) const;
+
+  /**
+   * @brief Returns the number of objects.
+   *
+   * @return Number of objects, which is also the maximum number of draws.
+   */
+  [[nodiscard]] std::uint32_t getObjectCount() const noexcept {
+    return m_objectCount;
+  }
+
+  /**
+   * @brief Returns whether the draws are issued with
+   * `vkCmdDrawIndexedIndirectCountKHR`.
+   *
+   * @return `true` if `VK_KHR_draw_indirect_count` is enabled.
+   */
+  [[nodiscard]] bool isDrawCountSupported() const noexcept {
+    return m_drawCountSupported;
+  }
+
+  /**
+   * @brief Returns the buffer of draw commands written by the culling shader.
+   *
+   * @return Buffer of `VkDrawIndexedIndirectCommand`.
+   */
+  [[nodiscard]] VulkanBuffer const &getCommandBuffer() const noexcept {
+    return m_commandBuffer;
+  }
+
+  /**
+   * @brief Returns the buffer with the number of visible objects.
+   *
+   * @return Buffer holding a single `uint32_t`.
+   */
+  [[nodiscard]] VulkanBuffer const &getCountBuffer() const noexcept {
+    return m_countBuffer;
+  }
+
+private:
+  void createPipeline(VulkanDevice const &device);
+  void createDescriptorSet();
+
+  vk::Device m_device{};
+  std::uint32_t m_objectCount{};
+  bool m_drawCountSupported{};
+  bool m_multiDrawSupported{};
+
+  VulkanBuffer m_objectBuffer{};
+  VulkanBuffer m_meshBuffer{};
+  VulkanBuffer m_commandBuffer{};
+  VulkanBuffer m_countBuffer{};
+
+  vk::DescriptorSetLayout m_descriptorSetLayout{};
+  vk::DescriptorPool m_descriptorPool{};
+  vk::DescriptorSet m_descriptorSet{};
+  vk::PipelineLayout m_pipelineLayout{};
+  vk::Pipeline m_pipeline{};
+};
+
+#endif
@@ -10,6 +10,7 @@
 
 #include "abcgVulkanPhysicalDevice.hpp"
 
+#include <algorithm>
 #include <cppitertools/itertools.hpp>
 #include <set>
 #include <span>
@@ -200,6 +201,22 @@ bool abcg::VulkanPhysicalDevice::isDeviceSuitable(
          isDiscrete && hasSamplerAnisotropy;
 }
 
+/**
+ * @brief Returns whether a device extension is supported.
+ *
+ * @param extension Extension name.
+ *
+ * @return `true` if the physical device supports the extension.
+ */
+bool abcg::VulkanPhysicalDevice::isExtensionSupported(
+    std::string_view extension) const {
+  return std::ranges::any_of(
+      m_physicalDevice.enumerateDeviceExtensionProperties(),
+      [extension](auto const &properties) {
+        return extension == std::span{properties.extensionName}.data();
+      });
+}
+
 std::vector<char const *> abcg::VulkanPhysicalDevice::checkExtensionsSupport(
     std::vector<char const *> const &extensions) {
   std::vector<char const *> unsupportedExtensions;
@@ -14,6 +14,7 @@
 #define ABCG_VULKAN_PHYSICAL_DEVICE_HPP_
 
 #include <optional>
+#include <string_view>
 
 #include "abcgVulkanExternal.hpp"
 #include "abcgVulkanInstance.hpp"
@@ -95,6 +96,8 @@ public:
     return m_sampleCount;
   }
 
+  [[nodiscard]] bool isExtensionSupported(std::string_view extension) const;
+
   [[nodiscard]] std::optional<vk::Format>
   getFirstSupportedFormat(std::vector<vk::Format> const &candidates,
                           vk::ImageTiling tiling,
@@ -16,10 +16,20 @@
 
 #include "abcgApplication.hpp"
 #include "abcgException.hpp"
+#include "abcgProfiler.hpp"
 #include "abcgVulkanDevice.hpp"
 #include "abcgVulkanPhysicalDevice.hpp"
 #include "abcgVulkanWindow.hpp"
 
+// Queries written every frame, followed by the begin and end queries of the
+// scopes declared in abcg::VulkanSettings::gpuScopeCount
+namespace TimestampQuery {
+constexpr uint32_t frameBegin{0};
+constexpr uint32_t mainPassEnd{1};
+constexpr uint32_t UIPassEnd{2};
+constexpr uint32_t count{3};
+} // namespace TimestampQuery
+
 struct SurfaceSupport {
   vk::SurfaceKHR surfaceKHR{};
   vk::SurfaceCapabilitiesKHR capabilities{};
@@ -105,6 +115,30 @@ void abcg::VulkanSwapchain::create(VulkanDevice const &device,
                                    glm::ivec2 const &windowSize) {
   m_device = device;
 
+  // Timestamps are written to the graphics queue
+  auto const &physicalDevice{
+      static_cast<vk::PhysicalDevice>(m_device.getPhysicalDevice())};
+  auto const graphicsFamily{
+      m_device.getPhysicalDevice().getQueuesFamilies().graphics.value()};
+  auto const validBits{physicalDevice.getQueueFamilyProperties()
+                           .at(graphicsFamily)
+                           .timestampValidBits};
+  m_timestampPeriod = physicalDevice.getProperties().limits.timestampPeriod;
+  m_timestampSupported = validBits > 0 && m_timestampPeriod > 0.0;
+  m_timestampMask = validBits >= 64 ? std::numeric_limits<uint64_t>::max()
+                                    : (uint64_t{1} << validBits) - 1;
+
+  auto const scopeCount{
+      gsl::narrow<std::size_t>(std::max(settings.gpuScopeCount, 0))};
+  m_queryCount = m_timestampSupported
+                     ? gsl::narrow<uint32_t>(TimestampQuery::count +
+                                             scopeCount * 2)
+                     : 0U;
+  m_queryResults.resize(std::size_t{m_queryCount} * 2);
+  m_mainPassGPUTime = 0.0;
+  m_UIPassGPUTime = 0.0;
+  m_scopeGPUTimes.assign(scopeCount, 0.0);
+
   m_swapChainRebuild = true;
 
   checkRebuild(settings, windowSize);
@@ -148,7 +182,7 @@ void abcg::VulkanSwapchain::render(
     return;
   }
 
-  auto const &frame{m_frames.at(m_currentFrame)};
+  auto &frame{m_frames.at(m_currentFrame)};
 
   // Wait until command buffer for acquired image has finished executing
   while (vk::Result::eTimeout ==
@@ -158,6 +192,23 @@ void abcg::VulkanSwapchain::render(
   device.resetFences(frame.fence);
   device.resetCommandPool(frame.commandPool);
 
+  // The fence has signaled, so the timestamps of the last time this frame was
+  // rendered can be read without waiting
+  if (frame.queriesSubmitted) {
+    readTimestamps(frame);
+  }
+
+  if (m_timestampSupported) {
+    frame.commandBufferQueries.begin(
+        {.flags = vk::CommandBufferUsageFlagBits::eOneTimeSubmit});
+    frame.commandBufferQueries.resetQueryPool(frame.queryPool, 0,
+                                              m_queryCount);
+    frame.commandBufferQueries.writeTimestamp(
+        vk::PipelineStageFlagBits::eTopOfPipe, frame.queryPool,
+        TimestampQuery::frameBegin);
+    frame.commandBufferQueries.end();
+  }
+
   // Main pass
   fun(frame);
 
@@ -165,6 +216,12 @@ void abcg::VulkanSwapchain::render(
   frame.commandBufferUI.begin(
       {.flags = vk::CommandBufferUsageFlagBits::eOneTimeSubmit});
 
+  if (m_timestampSupported) {
+    frame.commandBufferUI.writeTimestamp(
+        vk::PipelineStageFlagBits::eBottomOfPipe, frame.queryPool,
+        TimestampQuery::mainPassEnd);
+  }
+
   std::array<vk::ClearValue, 2> const clearValues{};
 
   frame.commandBufferUI.beginRenderPass(
@@ -176,16 +233,29 @@ void abcg::VulkanSwapchain::render(
       vk::SubpassContents::eInline);
 
   // Record Dear ImGUI primitives into command buffer
-  ImGui_ImplVulkan_RenderDrawData(ImGui::GetDrawData(), frame.commandBufferUI);
+  {
+    ABCG_PROFILE_ZONE("ImGui render");
+    ImGui_ImplVulkan_RenderDrawData(ImGui::GetDrawData(),
+                                    frame.commandBufferUI);
+  }
 
   frame.commandBufferUI.endRenderPass();
 
+  if (m_timestampSupported) {
+    frame.commandBufferUI.writeTimestamp(
+        vk::PipelineStageFlagBits::eBottomOfPipe, frame.queryPool,
+        TimestampQuery::UIPassEnd);
+  }
+
   frame.commandBufferUI.end();
 
   std::array waitSemaphores{presentCompleteSemaphore};
   std::array waitStages{vk::PipelineStageFlags{
       vk::PipelineStageFlagBits::eColorAttachmentOutput}};
-  std::array commandBuffers{frame.commandBuffer, frame.commandBufferUI};
+  std::array commandBuffers{frame.commandBufferQueries, frame.commandBuffer,
+                            frame.commandBufferUI};
+  // The queries command buffer is only recorded if timestamps are supported
+  auto const firstCommandBuffer{m_timestampSupported ? 0U : 1U};
   std::array signalSemaphores{renderCompleteSemaphore};
 
   // Submit command buffer
@@ -193,11 +263,98 @@ void abcg::VulkanSwapchain::render(
       {{.waitSemaphoreCount = gsl::narrow<uint32_t>(waitSemaphores.size()),
         .pWaitSemaphores = waitSemaphores.data(),
         .pWaitDstStageMask = waitStages.data(),
-        .commandBufferCount = commandBuffers.size(),
-        .pCommandBuffers = commandBuffers.data(),
+        .commandBufferCount = gsl::narrow<uint32_t>(commandBuffers.size()) -
+                              firstCommandBuffer,
+        .pCommandBuffers = &commandBuffers.at(firstCommandBuffer),
         .signalSemaphoreCount = gsl::narrow<uint32_t>(signalSemaphores.size()),
         .pSignalSemaphores = signalSemaphores.data()}},
       frame.fence);
+  frame.queriesSubmitted = m_timestampSupported;
+}
+
+/**
+ * @brief Writes the begin timestamp of a GPU scope declared by the
+ * application.
+ *
+ * This must be called while recording the main command buffer of the frame.
+ * Each scope can be measured at most once per frame.
+ *
+ * @param frame Frame being rendered.
+ * @param scope Scope index, smaller than abcg::VulkanSettings::gpuScopeCount.
+ */
+void abcg::VulkanSwapchain::beginGPUScope(VulkanFrame const &frame,
+                                          std::size_t scope) const {
+  Expects(scope < m_scopeGPUTimes.size());
+  if (!m_timestampSupported)
+    return;
+  frame.commandBuffer.writeTimestamp(
+      vk::PipelineStageFlagBits::eTopOfPipe, frame.queryPool,
+      gsl::narrow<uint32_t>(TimestampQuery::count + scope * 2));
+}
+
+/**
+ * @brief Writes the end timestamp of a GPU scope declared by the application.
+ *
+ * @param frame Frame being rendered.
+ * @param scope Scope index, smaller than abcg::VulkanSettings::gpuScopeCount.
+ *
+ * @sa abcg::VulkanSwapchain::beginGPUScope.
+ */
+void abcg::VulkanSwapchain::endGPUScope(VulkanFrame const &frame,
+                                        std::size_t scope) const {
+  Expects(scope < m_scopeGPUTimes.size());
+  if (!m_timestampSupported)
+    return;
+  frame.commandBuffer.writeTimestamp(
+      vk::PipelineStageFlagBits::eBottomOfPipe, frame.queryPool,
+      gsl::narrow<uint32_t>(TimestampQuery::count + scope * 2 + 1));
+}
+
+/**
+ * @brief Returns the GPU time of a scope declared by the application.
+ *
+ * @param scope Scope index, smaller than abcg::VulkanSettings::gpuScopeCount.
+ *
+ * @return Time in milliseconds, measured the last time the scope was written
+ * and its frame was rendered again.
+ */
+double abcg::VulkanSwapchain::getGPUScopeTime(std::size_t scope) const {
+  return m_scopeGPUTimes.at(scope);
+}
+
+// Reads the timestamps of a frame whose fence has signaled. Scopes that were
+// not written in that frame keep their last time
+void abcg::VulkanSwapchain::readTimestamps(VulkanFrame const &frame) {
+  auto const &device{static_cast<vk::Device>(m_device)};
+
+  // eNotReady is returned if some scope was not written, which is expected
+  static_cast<void>(device.getQueryPoolResults(
+      frame.queryPool, 0, m_queryCount,
+      m_queryResults.size() * sizeof(uint64_t), m_queryResults.data(),
+      2 * sizeof(uint64_t),
+      vk::QueryResultFlagBits::e64 |
+          vk::QueryResultFlagBits::eWithAvailability));
+
+  auto const elapsed{
+      [this](uint32_t begin, uint32_t end, double &milliseconds) {
+        if (m_queryResults.at(begin * 2 + 1) == 0 ||
+            m_queryResults.at(end * 2 + 1) == 0)
+          return;
+        auto const ticks{
+            (m_queryResults.at(end * 2) - m_queryResults.at(begin * 2)) &
+            m_timestampMask};
+        milliseconds =
+            gsl::narrow_cast<double>(ticks) * m_timestampPeriod / 1.0e6;
+      }};
+
+  elapsed(TimestampQuery::frameBegin, TimestampQuery::mainPassEnd,
+          m_mainPassGPUTime);
+  elapsed(TimestampQuery::mainPassEnd, TimestampQuery::UIPassEnd,
+          m_UIPassGPUTime);
+  for (auto &&[scope, milliseconds] : iter::enumerate(m_scopeGPUTimes)) {
+    auto const begin{gsl::narrow<uint32_t>(TimestampQuery::count + scope * 2)};
+    elapsed(begin, begin + 1, milliseconds);
+  }
 }
 
 void abcg::VulkanSwapchain::present() {
@@ -395,6 +552,7 @@ void abcg::VulkanSwapchain::destroyFrames() {
   for (auto &frame : m_frames) {
     device.destroyCommandPool(frame.commandPool);
     device.destroyFence(frame.fence);
+    device.destroyQueryPool(frame.queryPool);
     frame.colorImage.destroy();
     device.destroyFramebuffer(frame.framebufferMain);
   }
@@ -729,6 +887,21 @@ void abcg::VulkanSwapchain::createFramebuffers(VulkanSettings const &settings) {
                                      .commandBufferCount = 1})
             .front();
 
+    // Create a primary command buffer for resetting and writing queries
+    frame.commandBufferQueries =
+        device
+            .allocateCommandBuffers({.commandPool = frame.commandPool,
+                                     .level = vk::CommandBufferLevel::ePrimary,
+                                     .commandBufferCount = 1})
+            .front();
+
+    // Create timestamp query pool
+    if (m_timestampSupported) {
+      frame.queryPool =
+          device.createQueryPool({.queryType = vk::QueryType::eTimestamp,
+                                  .queryCount = m_queryCount});
+    }
+
     // Create fence
     frame.fence =
         device.createFence({.flags = vk::FenceCreateFlagBits::eSignaled});
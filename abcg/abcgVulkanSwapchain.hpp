@@ -13,8 +13,10 @@
 #ifndef ABCG_VULKAN_SWAPCHAIN_HPP_
 #define ABCG_VULKAN_SWAPCHAIN_HPP_
 
+#include <cstddef>
 #include <functional>
 #include <glm/fwd.hpp>
+#include <vector>
 
 #include "abcgVulkanDevice.hpp"
 #include "abcgVulkanImage.hpp"
@@ -36,6 +38,11 @@ struct abcg::VulkanFrame {
   vk::CommandPool commandPool{};
   vk::CommandBuffer commandBuffer{};
   vk::CommandBuffer commandBufferUI{};
+  // Resets the timestamp queries and writes the frame start timestamp
+  vk::CommandBuffer commandBufferQueries{};
+  vk::QueryPool queryPool{};
+  // Whether the queries were submitted since the frame was created
+  bool queriesSubmitted{};
   vk::Fence fence{};
   VulkanImage colorImage{};
   vk::Framebuffer framebufferMain{};
@@ -57,6 +64,37 @@ public:
   bool checkRebuild(VulkanSettings const &settings,
                     glm::ivec2 const &windowSize);
 
+  void beginGPUScope(VulkanFrame const &frame, std::size_t scope) const;
+  void endGPUScope(VulkanFrame const &frame, std::size_t scope) const;
+  [[nodiscard]] double getGPUScopeTime(std::size_t scope) const;
+
+  /**
+   * @brief Whether the graphics queue supports timestamp queries.
+   *
+   * @return `true` if the GPU times of the frames are measured.
+   */
+  [[nodiscard]] bool isTimestampSupported() const noexcept {
+    return m_timestampSupported;
+  }
+
+  /**
+   * @brief Returns the GPU time of the main render pass.
+   *
+   * @return Time in milliseconds, measured when the frame was last rendered.
+   */
+  [[nodiscard]] double getMainPassGPUTime() const noexcept {
+    return m_mainPassGPUTime;
+  }
+
+  /**
+   * @brief Returns the GPU time of the UI render pass.
+   *
+   * @return Time in milliseconds, measured when the frame was last rendered.
+   */
+  [[nodiscard]] double getUIPassGPUTime() const noexcept {
+    return m_UIPassGPUTime;
+  }
+
   /**
    * @brief Conversion to vk::SwapchainKHR.
    */
@@ -143,6 +181,8 @@ private:
 
   void createFramebuffers(VulkanSettings const &settings);
 
+  void readTimestamps(VulkanFrame const &frame);
+
   vk::SwapchainKHR m_swapchainKHR;
   VulkanDevice m_device;
 
@@ -166,6 +206,17 @@ private:
   VulkanImage m_depthImage{};
   VulkanImage m_MSAAImage{};
 
+  // Timestamp queries
+  bool m_timestampSupported{};
+  double m_timestampPeriod{}; // Nanoseconds per tick
+  uint64_t m_timestampMask{};
+  uint32_t m_queryCount{};
+  // Pairs of value and availability read back from a query pool
+  std::vector<uint64_t> m_queryResults{};
+  double m_mainPassGPUTime{};
+  double m_UIPassGPUTime{};
+  std::vector<double> m_scopeGPUTimes{};
+
   // Render passes
   vk::RenderPass m_renderPassMain{};
   vk::RenderPass m_renderPassUI{};
@@ -16,9 +16,12 @@
 #include <gsl/gsl>
 #include <imgui_impl_sdl.h>
 #include <imgui_impl_vulkan.h>
+#include <iterator>
 
+#include "abcgAllocationTracker.hpp"
 #include "abcgEmbeddedFonts.hpp"
 #include "abcgException.hpp"
+#include "abcgProfiler.hpp"
 #include "abcgVulkanError.hpp"
 #include "abcgVulkanInstance.hpp"
 #include "abcgWindow.hpp"
@@ -136,29 +139,51 @@ void abcg::VulkanWindow::onPaint([[maybe_unused]] VulkanFrame const &frame) {}
 void abcg::VulkanWindow::onPaintUI() {
   // FPS counter
   if (abcg::Window::getWindowSettings().showFPS) {
-    auto fps{ImGui::GetIO().Framerate};
-
-    static auto offset{0UL};
-    static auto refreshTime{ImGui::GetTime()};
-    static std::array<float, 150> frames{};
-
-    while (refreshTime < ImGui::GetTime()) {
-      auto const refreshFrequency{60.0};
-      frames.at(offset) = fps;
-      offset = (offset + 1) % frames.size();
-      refreshTime += (1.0 / refreshFrequency);
+    // Frame intervals of the last frames, in milliseconds
+    auto const &history{getFrameTimeHistory()};
+    std::array<float, 150> intervals{};
+    auto const count{std::min(intervals.size(), history.size())};
+    for (auto const index : iter::range(count)) {
+      intervals.at(intervals.size() - count + index) = gsl::narrow_cast<float>(
+          history.getSample(history.size() - count + index).frameInterval);
     }
+    auto const summary{history.getSummary()};
 
     ImGui::SetNextWindowPos(ImVec2(5, 5));
     ImGui::Begin("FPS", nullptr,
                  ImGuiWindowFlags_NoDecoration | ImGuiWindowFlags_NoInputs |
                      ImGuiWindowFlags_NoBringToFrontOnFocus |
                      ImGuiWindowFlags_NoFocusOnAppearing);
-    auto const label{fmt::format("avg {:.1f} FPS", fps)};
-    ImGui::PlotLines("", frames.data(), gsl::narrow<int>(frames.size()),
-                     gsl::narrow<int>(offset), label.c_str(), 0.0f,
-                     *std::ranges::max_element(frames) * 2,
-                     ImVec2(gsl::narrow<float>(frames.size()), 50));
+    auto const label{getFrameArena().format("p50 {:.1f} ms, p99 {:.1f} ms",
+                                            summary.frameInterval.p50,
+                                            summary.frameInterval.p99)};
+    ImGui::PlotLines("", intervals.data(), gsl::narrow<int>(intervals.size()),
+                     0, label.c_str(), 0.0f,
+                     *std::ranges::max_element(intervals) * 2,
+                     ImVec2(gsl::narrow<float>(intervals.size()), 50));
+    if (summary.frameInterval.onePercentLow > 0.0) {
+      auto const lowLabel{getFrameArena().format(
+          "1% low {:.1f} FPS, {} hitches",
+          1000.0 / summary.frameInterval.onePercentLow, summary.hitchCount)};
+      ImGui::TextUnformatted(lowLabel.c_str());
+    }
+    if (auto const &culling{getFrameStatistics().culling};
+        culling.visible + culling.culled > 0) {
+      auto const cullingLabel{getFrameArena().format(
+          "{} visible, {} culled", culling.visible, culling.culled)};
+      ImGui::TextUnformatted(cullingLabel.c_str());
+    }
+    if (auto const &gpu{getFrameStatistics().gpu}; gpu.available) {
+      auto const gpuLabel{getFrameArena().format(
+          "GPU {:.2f} ms paint, {:.2f} ms UI", gpu.paint, gpu.ui)};
+      ImGui::TextUnformatted(gpuLabel.c_str());
+    }
+    if (AllocationTracker::isEnabled()) {
+      auto const &allocations{getFrameStatistics().allocations};
+      auto const allocationLabel{getFrameArena().format(
+          "{} allocations, {} bytes", allocations.count, allocations.bytes)};
+      ImGui::TextUnformatted(allocationLabel.c_str());
+    }
     ImGui::End();
   }
 
@@ -214,6 +239,48 @@ void abcg::VulkanWindow::onUpdate() {}
  */
 void abcg::VulkanWindow::onDestroy() {}
 
+/**
+ * @brief Starts measuring the GPU time of a scope of the main pass.
+ *
+ * This must be called in abcg::VulkanWindow::onPaint, while recording
+ * `frame.commandBuffer`. Each scope can be measured at most once per frame.
+ *
+ * @param frame Frame passed to abcg::VulkanWindow::onPaint.
+ * @param scope Scope index, smaller than abcg::VulkanSettings::gpuScopeCount.
+ */
+void abcg::VulkanWindow::beginGPUScope(VulkanFrame const &frame,
+                                       std::size_t scope) const {
+  m_swapchain.beginGPUScope(frame, scope);
+}
+
+/**
+ * @brief Stops measuring the GPU time of a scope of the main pass.
+ *
+ * @param frame Frame passed to abcg::VulkanWindow::onPaint.
+ * @param scope Scope index, smaller than abcg::VulkanSettings::gpuScopeCount.
+ *
+ * @sa abcg::VulkanWindow::beginGPUScope.
+ */
+void abcg::VulkanWindow::endGPUScope(VulkanFrame const &frame,
+                                     std::size_t scope) const {
+  m_swapchain.endGPUScope(frame, scope);
+}
+
+/**
+ * @brief Returns the GPU time of a scope of the main pass.
+ *
+ * The time is read back when the swapchain image of the frame in which the
+ * scope was measured is reused, without waiting for the GPU.
+ *
+ * @param scope Scope index, smaller than abcg::VulkanSettings::gpuScopeCount.
+ *
+ * @return Time in milliseconds, or zero if timestamp queries are not
+ * supported.
+ */
+double abcg::VulkanWindow::getGPUScopeTime(std::size_t scope) const {
+  return m_swapchain.getGPUScopeTime(scope);
+}
+
 void abcg::VulkanWindow::handleEvent(SDL_Event const &event) {
   if (event.window.windowID != abcg::Window::getSDLWindowID())
     return;
@@ -277,7 +344,14 @@ void abcg::VulkanWindow::create() {
                           sampleCount);
 
   // Create logical device
-  m_device.create(m_physicalDevice, m_deviceExtensions);
+  auto deviceExtensions{m_deviceExtensions};
+  std::ranges::copy_if(m_optionalDeviceExtensions,
+                       std::back_inserter(deviceExtensions),
+                       [this](char const *extension) {
+                         return m_physicalDevice.isExtensionSupported(
+                             extension);
+                       });
+  m_device.create(m_physicalDevice, deviceExtensions);
 
   // Create swapchain
   m_swapchain.create(m_device, m_vulkanSettings, getWindowSize());
@@ -374,7 +448,10 @@ void abcg::VulkanWindow::create() {
 }
 
 void abcg::VulkanWindow::paint() {
-  onUpdate();
+  {
+    ABCG_PROFILE_ZONE("onUpdate");
+    onUpdate();
+  }
 
   if (m_hidden || m_minimized)
     return;
@@ -390,11 +467,26 @@ void abcg::VulkanWindow::paint() {
   ImGui_ImplSDL2_NewFrame();
   ImGui::NewFrame();
 
-  onPaintUI();
+  {
+    ABCG_PROFILE_ZONE("onPaintUI");
+    onPaintUI();
+  }
+
+  {
+    ABCG_PROFILE_ZONE("ImGui::Render");
+    ImGui::Render();
+  }
 
-  ImGui::Render();
+  m_swapchain.render([this](auto const &frame) {
+    ABCG_PROFILE_ZONE("onPaint");
+    onPaint(frame);
+  });
+  recordGPUTimeStatistics(
+      {.available = m_swapchain.isTimestampSupported(),
+       .paint = m_swapchain.getMainPassGPUTime(),
+       .ui = m_swapchain.getUIPassGPUTime()});
 
-  m_swapchain.render([this](auto const &frame) { onPaint(frame); });
+  ABCG_PROFILE_ZONE("Present");
   m_swapchain.present();
 }
 
@@ -60,6 +60,15 @@ struct abcg::VulkanSettings {
    * comes first.
    */
   bool vSync{false};
+
+  /** @brief Number of GPU timing scopes declared by the application.
+   *
+   * Each scope is measured with abcg::VulkanWindow::beginGPUScope and
+   * abcg::VulkanWindow::endGPUScope, and its time is returned by
+   * abcg::VulkanWindow::getGPUScopeTime. The main and UI render passes are
+   * always measured if the device supports timestamp queries.
+   */
+  int gpuScopeCount{0};
 };
 
 /**
@@ -104,6 +113,10 @@ protected:
   virtual void onUpdate();
   virtual void onDestroy();
 
+  void beginGPUScope(VulkanFrame const &frame, std::size_t scope) const;
+  void endGPUScope(VulkanFrame const &frame, std::size_t scope) const;
+  [[nodiscard]] double getGPUScopeTime(std::size_t scope) const;
+
 private:
   void handleEvent(SDL_Event const &event) final;
   void create() final;
@@ -114,6 +127,9 @@ private:
   VulkanSettings m_vulkanSettings;
   std::vector<char const *> const m_deviceExtensions{
       VK_KHR_SWAPCHAIN_EXTENSION_NAME};
+  // Enabled only if supported
+  std::vector<char const *> const m_optionalDeviceExtensions{
+      VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME};
   std::vector<char const *> m_layers {
 #if defined(ABCG_VULKAN_DEBUG_REPORT)
     "VK_LAYER_KHRONOS_validation"
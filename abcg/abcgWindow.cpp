@@ -15,6 +15,9 @@
 
 #include <imgui_impl_sdl.h>
 
+#include "abcgAllocationTracker.hpp"
+#include "abcgProfiler.hpp"
+
 static ImVec4 ColorAlpha(ImVec4 const &color, float const alpha) {
   return {color.x, color.y, color.z, alpha};
 }
@@ -130,7 +133,9 @@ int abcg::resizingEventWatcher(void *data, SDL_Event *event) {
     if (SDLWindow == static_cast<SDL_Window *>(data)) {
       abcg::Window &window{*(
           static_cast<abcg::Window *>(SDL_GetWindowData(SDLWindow, "window")))};
-      if (window.m_enableResizingEventWatcher) {
+      // A replayed frame must not be painted twice
+      if (window.m_enableResizingEventWatcher &&
+          window.m_inputRecorder.getMode() != InputRecorderMode::Replay) {
         [[maybe_unused]] bool done{};
         window.templateHandleEvent(*event, done);
         window.templatePaint();
@@ -161,6 +166,9 @@ abcg::fullscreenchangeCallback(int eventType,
  * that, zero is returned. Internally, the delta time accumulates for the next
  * frame(s) until at least 2ms have passed.
  *
+ * When replaying an input recording, this is the delta time of the recorded
+ * frame (see abcg::InputRecorder).
+ *
  * @returns Time in seconds.
  */
 double abcg::Window::getDeltaTime() const noexcept { return m_lastDeltaTime; }
@@ -168,9 +176,117 @@ double abcg::Window::getDeltaTime() const noexcept { return m_lastDeltaTime; }
 /**
  * @brief Returns the time that have passed since the window was created.
  *
+ * When recording or replaying input, this is the sum of the delta times of
+ * the frames painted so far.
+ *
  * @returns Time in seconds.
  */
-double abcg::Window::getElapsedTime() const { return m_elapsedTime.elapsed(); }
+double abcg::Window::getElapsedTime() const {
+  if (m_inputRecorder.getMode() != InputRecorderMode::Off)
+    return m_inputRecorder.getClockTime();
+  return m_elapsedTime.elapsed();
+}
+
+/**
+ * @brief Returns a seed for the random number generators of the application.
+ *
+ * The seed changes on each run, except when replaying an input recording,
+ * where it is the seed of the recorded run (see abcg::InputRecorder).
+ *
+ * @returns Random seed.
+ */
+std::uint64_t abcg::Window::getRandomSeed() const noexcept {
+  return m_inputRecorder.getSeed();
+}
+
+/**
+ * @brief Returns the statistics of the last complete frame.
+ *
+ * @returns Reference to the statistics recorded during the previous call to
+ * abcg::Window::paint.
+ */
+abcg::FrameStatistics const &
+abcg::Window::getFrameStatistics() const noexcept {
+  return m_frameStatistics;
+}
+
+/**
+ * @brief Returns the timings of the last frames.
+ *
+ * The frame interval and the CPU time of abcg::Window::paint are recorded
+ * for every frame, together with the GPU times when they are measured.
+ * Launching the application with `--frame-stats <file>` exports the history
+ * on exit.
+ *
+ * @returns Reference to the frame time history of the window.
+ */
+abcg::FrameTimeHistory const &
+abcg::Window::getFrameTimeHistory() const noexcept {
+  return m_frameTimeHistory;
+}
+
+/**
+ * @brief Returns the publisher of live metrics.
+ *
+ * The metrics of every frame are published to shared memory when the
+ * application is launched with `--metrics <name>`. Use this to register and
+ * set application counters, which can be done even if publishing is
+ * disabled:
+ * @code
+ * // onCreate
+ * m_particlesCounter = getMetricsPublisher().registerCounter("particles");
+ * // onUpdate
+ * getMetricsPublisher().setCounter(m_particlesCounter, particleCount);
+ * @endcode
+ *
+ * @returns Reference to the metrics publisher of the window.
+ */
+abcg::MetricsPublisher &abcg::Window::getMetricsPublisher() noexcept {
+  return m_metricsPublisher;
+}
+
+/**
+ * @brief Returns the linear allocator of the current frame.
+ *
+ * The arena is reset at the start of each frame, so memory allocated from it
+ * in abcg::Window::paint (e.g., in `onUpdate`, `onPaint` or `onPaintUI`) is
+ * valid until the end of the frame:
+ * @code
+ * std::pmr::vector<glm::mat4> transforms{&getFrameArena()};
+ * m_visible.clear();
+ * m_bvh.cull(frustum, m_visible, &getFrameArena());
+ * @endcode
+ *
+ * @returns Reference to the frame arena of the window.
+ */
+abcg::FrameArena &abcg::Window::getFrameArena() noexcept {
+  return m_frameArena;
+}
+
+/**
+ * @brief Adds the result of a culling pass to the statistics of the current
+ * frame.
+ *
+ * @param statistics Counters returned by the culling pass, e.g., by
+ * abcg::BVH::cull.
+ */
+void abcg::Window::recordCullingStatistics(
+    CullingStatistics const &statistics) noexcept {
+  m_currentFrameStatistics.culling += statistics;
+}
+
+/**
+ * @brief Sets the GPU times reported with the statistics of the current
+ * frame.
+ *
+ * This is called by the window classes of each graphics API.
+ *
+ * @param statistics Last GPU times read back from the timer queries.
+ */
+void abcg::Window::recordGPUTimeStatistics(
+    GPUTimeStatistics const &statistics) noexcept {
+  m_currentFrameStatistics.gpu = statistics;
+}
 
 /**
  * @brief Returns the current configuration settings of the window.
@@ -382,6 +498,7 @@ void abcg::Window::templateHandleEvent(SDL_Event const &event, bool &done) {
 void abcg::Window::templateCreate() {
   m_deltaTime.restart();
   m_elapsedTime.restart();
+  m_frameInterval.restart();
 
   create();
 
@@ -390,14 +507,53 @@ void abcg::Window::templateCreate() {
 }
 
 void abcg::Window::templatePaint() {
-  // Cap to 480 Hz
-  if (m_deltaTime.elapsed() >= 1.0 / 480.0) {
-    m_lastDeltaTime = m_deltaTime.restart();
+  ABCG_PROFILE_ZONE("Window::templatePaint");
+
+  if (m_inputRecorder.getMode() == InputRecorderMode::Replay) {
+    // Fixed clock
+    m_lastDeltaTime = m_inputRecorder.getDeltaTime();
   } else {
-    m_lastDeltaTime = 0.0;
+    // Cap to 480 Hz
+    if (m_deltaTime.elapsed() >= 1.0 / 480.0) {
+      m_lastDeltaTime = m_deltaTime.restart();
+    } else {
+      m_lastDeltaTime = 0.0;
+    }
+    m_inputRecorder.recordFrame(m_lastDeltaTime);
   }
 
+  // Allocations since the previous frame started
+  m_currentFrameStatistics.allocations =
+      AllocationTracker::getInstance().recordFrame();
+  m_frameStatistics = m_currentFrameStatistics;
+  m_currentFrameStatistics = {};
+  m_frameArena.reset();
+
+  auto const frameInterval{m_frameInterval.restart()};
+  Timer const cpuTime;
+
   paint();
+
+  auto const &gpu{m_currentFrameStatistics.gpu};
+  FrameTimeSample const sample{.cpuTime = cpuTime.elapsed() * 1000.0,
+                               .frameInterval = frameInterval * 1000.0,
+                               .gpuTime = gpu.paint + gpu.ui + gpu.swap,
+                               .gpuAvailable = gpu.available};
+  m_frameTimeHistory.record(sample);
+
+  if (m_metricsPublisher.isOpen()) {
+    auto const &culling{m_currentFrameStatistics.culling};
+    m_metricsPublisher.publish(
+        {.frame = m_frameTimeHistory.getFrameCount() - 1,
+         .time = m_elapsedTime.elapsed(),
+         .cpuTime = sample.cpuTime,
+         .frameInterval = sample.frameInterval,
+         .gpuPaint = gpu.paint,
+         .gpuUI = gpu.ui,
+         .gpuSwap = gpu.swap,
+         .visible = culling.visible,
+         .culled = culling.culled});
+  }
 }
 
 void abcg::Window::templateDestroy() {
@@ -406,6 +562,9 @@ void abcg::Window::templateDestroy() {
 
   destroy();
 
+  m_inputRecorder.stop();
+  m_metricsPublisher.close();
+
   SDL_DestroyWindow(m_window);
   m_window = nullptr;
   m_windowID = 0;
@@ -13,9 +13,15 @@
 #ifndef ABCG_WINDOW_HPP_
 #define ABCG_WINDOW_HPP_
 
+#include <cstdint>
 #include <string>
 
 #include "abcgExternal.hpp"
+#include "abcgFrameArena.hpp"
+#include "abcgFrameStatistics.hpp"
+#include "abcgFrameTimeHistory.hpp"
+#include "abcgInputRecorder.hpp"
+#include "abcgMetrics.hpp"
 #include "abcgTimer.hpp"
 
 #if defined(__EMSCRIPTEN__)
@@ -154,6 +160,13 @@ protected:
 
   [[nodiscard]] double getDeltaTime() const noexcept;
   [[nodiscard]] double getElapsedTime() const;
+  [[nodiscard]] std::uint64_t getRandomSeed() const noexcept;
+  [[nodiscard]] FrameStatistics const &getFrameStatistics() const noexcept;
+  [[nodiscard]] FrameTimeHistory const &getFrameTimeHistory() const noexcept;
+  [[nodiscard]] MetricsPublisher &getMetricsPublisher() noexcept;
+  [[nodiscard]] FrameArena &getFrameArena() noexcept;
+  void recordCullingStatistics(CullingStatistics const &statistics) noexcept;
+  void recordGPUTimeStatistics(GPUTimeStatistics const &statistics) noexcept;
   [[nodiscard]] SDL_Window *getSDLWindow() const noexcept;
   [[nodiscard]] Uint32 getSDLWindowID() const noexcept;
   [[nodiscard]] bool createSDLWindow(SDL_WindowFlags extraFlags);
@@ -176,6 +189,21 @@ private:
   Timer m_elapsedTime;
   double m_lastDeltaTime{};
 
+  InputRecorder m_inputRecorder;
+
+  // Statistics of the last complete frame and of the frame being painted
+  FrameStatistics m_frameStatistics;
+  FrameStatistics m_currentFrameStatistics;
+
+  // Raw timings of the last frames
+  FrameTimeHistory m_frameTimeHistory;
+  Timer m_frameInterval;
+
+  MetricsPublisher m_metricsPublisher;
+
+  // Transient allocations of the frame being painted
+  FrameArena m_frameArena;
+
   bool m_enableResizingEventWatcher{true};
 
   friend Application;
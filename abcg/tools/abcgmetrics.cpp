@@ -0,0 +1,125 @@
+/**
+ * @file abcgmetrics.cpp
+ * @brief Command-line reader of the metrics published by
+ * abcg::MetricsPublisher.
+ *
+ * Follows the metrics published by an ABCg application launched with
+ * `--metrics <name>`, and prints one line per frame until the application
+ * exits. With `--json`, each line is a JSON object.
+ *
+ * Usage: `abcgmetrics <name> [--json]`
+ *
+ * This file is part of ABCg (https://github.com/hbatagelo/abcg).
+ *
+ * @copyright (c) 2021--2022 Harlen Batagelo. All rights reserved.
+ * This project is released under the MIT License.
+ */
+
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <csignal>
+#include <cstdio>
+#include <exception>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include <sys/types.h>
+
+#include <cppitertools/itertools.hpp>
+#include <fmt/core.h>
+#include <gsl/gsl>
+
+#include "abcgMetrics.hpp"
+#include "abcgUtil.hpp"
+
+namespace {
+
+void printText(abcg::MetricsSample const &sample,
+               std::vector<std::string> const &counterNames) {
+  fmt::print("frame {} {:.2f} ms interval, {:.2f} ms CPU, {:.2f} ms GPU, "
+             "{:.1f} MiB",
+             sample.frame, sample.frameInterval, sample.cpuTime,
+             sample.gpuPaint + sample.gpuUI + sample.gpuSwap,
+             gsl::narrow_cast<double>(sample.residentMemory) / 1048576.0);
+  for (auto &&[name, value] : iter::zip(counterNames, sample.counters)) {
+    fmt::print(", {} {}", name, value);
+  }
+  fmt::print("\n");
+}
+
+// JSON has no representation of NaN and infinity
+std::string toJSON(double value, std::string_view format) {
+  if (!std::isfinite(value))
+    return "null";
+  return fmt::vformat(format, fmt::make_format_args(value));
+}
+
+void printJSON(abcg::MetricsSample const &sample,
+               std::vector<std::string> const &counterNames) {
+  fmt::print(R"({{"frame":{},"time":{},"cpu":{},"interval":{},)"
+             R"("gpu":{{"paint":{},"ui":{},"swap":{}}},)"
+             R"("visible":{},"culled":{},"residentMemory":{},"counters":{{)",
+             sample.frame, toJSON(sample.time, "{:.4f}"),
+             toJSON(sample.cpuTime, "{:.4f}"),
+             toJSON(sample.frameInterval, "{:.4f}"),
+             toJSON(sample.gpuPaint, "{:.4f}"), toJSON(sample.gpuUI, "{:.4f}"),
+             toJSON(sample.gpuSwap, "{:.4f}"), sample.visible, sample.culled,
+             sample.residentMemory);
+  auto separator{""};
+  for (auto &&[name, value] : iter::zip(counterNames, sample.counters)) {
+    fmt::print(R"({}"{}":{})", separator, abcg::escapeJSON(name),
+               toJSON(value, "{}"));
+    separator = ",";
+  }
+  fmt::print("}}}}\n");
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  try {
+    if (argc < 2) {
+      fmt::print(stderr, "Usage: abcgmetrics <name> [--json]\n");
+      return 1;
+    }
+    std::string const name{argv[1]};
+    auto const json{argc > 2 && std::string_view{argv[2]} == "--json"};
+
+    abcg::MetricsReader reader;
+    reader.open(name);
+    auto const process{gsl::narrow<pid_t>(reader.getPublisherProcess())};
+
+    // Start from the newest sample
+    auto next{reader.getPublishedCount()};
+    while (true) {
+      auto const published{reader.getPublishedCount()};
+      if (published - next > reader.getCapacity()) {
+        fmt::print(stderr, "Skipped {} samples\n",
+                   published - next - reader.getCapacity());
+        next = published - reader.getCapacity();
+      }
+
+      auto const counterNames{reader.getCounterNames()};
+      for (; next < published; ++next) {
+        if (auto const sample{reader.read(next)}; sample.has_value()) {
+          json ? printJSON(*sample, counterNames)
+               : printText(*sample, counterNames);
+        }
+      }
+      std::fflush(stdout);
+
+      // The publisher has exited
+      if (kill(process, 0) != 0 && errno == ESRCH)
+        break;
+
+      std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+  } catch (std::exception const &exception) {
+    fmt::print(stderr, "{}\n", exception.what());
+    return 1;
+  }
+  return 0;
+}
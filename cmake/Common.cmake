@@ -17,6 +17,12 @@ option(ENABLE_IPO "Enable Interprocedural Optimization" ON)
 # mold
 option(ENABLE_MOLD "Enable mold (Modern Linker)" OFF)
 
+# CPU profiling zones
+option(ENABLE_PROFILER "Enable ABCg profiling zones" ON)
+
+# Heap allocation tracking (replaces the global operator new)
+option(ENABLE_ALLOCATION_TRACKER "Enable ABCg heap allocation tracking" OFF)
+
 if(NOT ${CMAKE_SYSTEM_NAME} MATCHES "Emscripten")
   set(OPTIONS_TARGET options)
   set(SANITIZERS_TARGET sanitizers)
@@ -2,20 +2,16 @@
 
 layout(location = 0) in vec2 inPosition;
 
-uniform vec4 color;
-uniform float rotation;
-uniform float scale;
-uniform vec2 translation;
+layout(std140) uniform ObjectData {
+  vec4 color;
+  vec2 translation;
+  float scale;
+};
 
 out vec4 fragColor;
 
 void main() {
-  float sinAngle = sin(rotation);
-  float cosAngle = cos(rotation);
-  vec2 rotated = vec2(inPosition.x * cosAngle - inPosition.y * sinAngle,
-                      inPosition.x * sinAngle + inPosition.y * cosAngle);
-
-  vec2 newPosition = rotated * scale + translation;
+  vec2 newPosition = inPosition * scale + translation;
   gl_Position = vec4(newPosition, 0, 1);
   fragColor = color;
 }
\ No newline at end of file
@@ -0,0 +1,14 @@
+#version 300 es
+
+precision mediump float;
+
+in vec4 fragColor;
+
+out vec4 outColor;
+
+void main() {
+  // Round point sprite with a soft edge
+  float distance = length(gl_PointCoord - vec2(0.5)) * 2.0;
+  if (distance > 1.0) discard;
+  outColor = fragColor * (1.0 - distance * distance);
+}
\ No newline at end of file
@@ -0,0 +1,25 @@
+#version 300 es
+
+// xy: position at time zero; z: depth in [0, 1]; w: twinkle phase
+layout(location = 0) in vec4 inStar;
+
+uniform float time;
+
+out vec4 fragColor;
+
+void main() {
+  float depth = inStar.z;
+
+  // Parallax: nearer stars fall faster, wrapping around [-1, 1]
+  float speed = mix(0.02, 0.2, depth * depth);
+  float y = mod(inStar.y - time * speed + 1.0, 2.0) - 1.0;
+
+  // Twinkle with a per-star phase and frequency
+  float frequency = mix(1.0, 4.0, fract(inStar.w * 7.0));
+  float twinkle = 0.75 + 0.25 * sin(time * frequency + inStar.w * 6.2831853);
+  float intensity = mix(0.3, 1.0, depth) * twinkle;
+
+  gl_PointSize = mix(1.0, 3.0, depth);
+  gl_Position = vec4(inStar.x, y, 0, 1);
+  fragColor = vec4(vec3(intensity), 1);
+}
\ No newline at end of file
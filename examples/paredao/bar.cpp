@@ -1,112 +1,12 @@
 #include "bar.hpp"
 
-#include <glm/fwd.hpp>
-#include <glm/gtx/fast_trigonometry.hpp>
+#include <gsl/gsl>
 
-void Bar::create(GLuint program) {
-  destroy();
+void Bar::reset() { m_translation = glm::vec2{0, -0.975}; }
 
-  m_program = program;
-
-  // Get location of uniforms in the program
-  m_colorLoc = abcg::glGetUniformLocation(m_program, "color");
-  m_scaleLoc = abcg::glGetUniformLocation(m_program, "scale");
-  m_translationLoc = abcg::glGetUniformLocation(m_program, "translation");
-
-  // Reset bar attributes
-  m_translation = glm::vec2{0, -0.975};
-
-  // clang-format off
-  std::array positions{
-      // Bar body
-      glm::vec2{-22.5f, +02.5f}, glm::vec2{+22.5f, +02.5f},
-      glm::vec2{-22.5f, -02.5f}, glm::vec2{+22.5f, -02.5f}
-      };
-
-  // Normalize
-  for (auto &position : positions) {
-    position /= glm::vec2{15.5f, 15.5f};
-  }
-
-  std::array const indices{0, 1, 3,
-                           0, 2, 3};
-  // clang-format on                           
-
-  // Generate VBO
-  abcg::glGenBuffers(1, &m_VBO);
-  abcg::glBindBuffer(GL_ARRAY_BUFFER, m_VBO);
-  abcg::glBufferData(GL_ARRAY_BUFFER, sizeof(positions), positions.data(),
-                     GL_STATIC_DRAW);
-  abcg::glBindBuffer(GL_ARRAY_BUFFER, 0);
-
-  // Generate EBO
-  abcg::glGenBuffers(1, &m_EBO);
-  abcg::glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_EBO);
-  abcg::glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices.data(),
-                     GL_STATIC_DRAW);
-  abcg::glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
-
-  // Get location of attributes in the program
-  GLint positionAttribute{abcg::glGetAttribLocation(m_program, "inPosition")};
-
-  // Create VAO
-  abcg::glGenVertexArrays(1, &m_VAO);
-
-  // Bind vertex attributes to current VAO
-  abcg::glBindVertexArray(m_VAO);
-
-  abcg::glEnableVertexAttribArray(positionAttribute);
-  abcg::glBindBuffer(GL_ARRAY_BUFFER, m_VBO);
-  abcg::glVertexAttribPointer(positionAttribute, 2, GL_FLOAT, GL_FALSE, 0,
-                              nullptr);
-  abcg::glBindBuffer(GL_ARRAY_BUFFER, 0);
-
-  abcg::glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_EBO);
-
-  // End of binding to current VAO
-  abcg::glBindVertexArray(0);
-}
-
-void Bar::paint(const GameData &gameData) {
-  if (gameData.m_state != State::Playing) return;
-
-  abcg::glUseProgram(m_program);
-
-  abcg::glBindVertexArray(m_VAO);
-
-  abcg::glUniform1f(m_scaleLoc, m_scale);
-  abcg::glUniform2fv(m_translationLoc, 1, &m_translation.x);
-
-  // Restart thruster blink timer every 100 ms
-  if (m_trailBlinkTimer.elapsed() > 100.0 / 1000.0) m_trailBlinkTimer.restart();
-
-  if (gameData.m_input[static_cast<size_t>(Input::Up)]) {
-    // Show thruster trail during 50 ms
-    if (m_trailBlinkTimer.elapsed() < 50.0 / 1000.0) {
-      abcg::glEnable(GL_BLEND);
-      abcg::glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-
-      // 50% transparent
-      abcg::glUniform4f(m_colorLoc, 1, 1, 1, 0.5f);
-
-      abcg::glDrawElements(GL_TRIANGLES, 14 * 3, GL_UNSIGNED_INT, nullptr);
-
-      abcg::glDisable(GL_BLEND);
-    }
-  }
-
-  abcg::glUniform4fv(m_colorLoc, 1, &m_color.r);
-  abcg::glDrawElements(GL_TRIANGLES, 12 * 3, GL_UNSIGNED_INT, nullptr);
-
-  abcg::glBindVertexArray(0);
-
-  abcg::glUseProgram(0);
-}
-
-void Bar::destroy() {
-  abcg::glDeleteBuffers(1, &m_VBO);
-  abcg::glDeleteBuffers(1, &m_EBO);
-  abcg::glDeleteVertexArrays(1, &m_VAO);
+Box Bar::getBox() const {
+  auto const halfSize{glm::vec2{m_halfWidth, m_halfHeight} * m_scale};
+  return {.min = m_translation - halfSize, .max = m_translation + halfSize};
 }
 
 void Bar::update(GameData const &gameData, float deltaTime) {
@@ -1,33 +1,27 @@
 #ifndef SHIP_HPP_
 #define SHIP_HPP_
 
-#include "abcgOpenGL.hpp"
+#include <glm/vec2.hpp>
+#include <glm/vec4.hpp>
 
+#include "collision.hpp"
 #include "gamedata.hpp"
 
 class Bar {
 public:
-  void create(GLuint program);
-  void paint(GameData const &gameData);
-  void destroy();
+  void reset();
   void update(GameData const &gameData, float deltaTime);
+  [[nodiscard]] Box getBox() const;
+
+  bool operator==(Bar const &) const = default;
+
+  // Half extents of the geometry, before scaling
+  static constexpr float m_halfWidth{22.5f / 15.5f};
+  static constexpr float m_halfHeight{2.5f / 15.5f};
 
   glm::vec4 m_color{1};
   float m_scale{0.125f};
   glm::vec2 m_translation{};
   glm::vec2 m_velocity{};
-
-  abcg::Timer m_trailBlinkTimer;
-  abcg::Timer m_bulletCoolDownTimer;
-
-private:
-  GLuint m_program{};
-  GLint m_translationLoc{};
-  GLint m_colorLoc{};
-  GLint m_scaleLoc{};
-
-  GLuint m_VAO{};
-  GLuint m_VBO{};
-  GLuint m_EBO{};
 };
 #endif
\ No newline at end of file
@@ -0,0 +1,68 @@
+// Steps many independent paredao games at once with BatchSimulation. The
+// bars are driven by a bot that follows the ball.
+//
+// Usage: paredao_batch [games] [steps] [threads] [seed]
+
+#include <chrono>
+#include <exception>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fmt/core.h>
+
+#include "batchsimulation.hpp"
+
+int main(int argc, char **argv) {
+  try {
+    auto const games{argc > 1 ? std::stoull(argv[1]) : 65'536ULL};
+    auto const steps{argc > 2 ? std::stoull(argv[2]) : 1'000ULL};
+    auto const threads{argc > 3 ? std::stoull(argv[3])
+                                : std::thread::hardware_concurrency()};
+    auto const seed{argc > 4 ? std::stoul(argv[4]) : 42UL};
+    auto const deltaTime{1.0f / 60.0f};
+
+    BatchSimulation simulation;
+    simulation.create(games, static_cast<unsigned int>(seed), threads);
+
+    std::vector<GameInput> inputs(games);
+    auto bounces{0.0};
+    auto gamesLost{0ULL};
+    auto const start{std::chrono::steady_clock::now()};
+
+    for (auto step{0ULL}; step < steps; ++step) {
+      // Move each bar toward its ball
+      auto const ballX{simulation.getBallX()};
+      auto const barX{simulation.getBarX()};
+      for (auto index{0ULL}; index < games; ++index) {
+        auto const offset{ballX[index] - barX[index]};
+        inputs[index] = static_cast<GameInput>(
+            (offset > +0.02f ? 1U << static_cast<unsigned>(Input::Right)
+                             : 0U) |
+            (offset < -0.02f ? 1U << static_cast<unsigned>(Input::Left) : 0U));
+      }
+
+      simulation.step(inputs, deltaTime);
+
+      auto const done{simulation.getDone()};
+      auto const reward{simulation.getReward()};
+      for (auto index{0ULL}; index < games; ++index) {
+        gamesLost += done[index];
+        bounces += reward[index] + done[index];
+      }
+    }
+
+    std::chrono::duration<double> const elapsed{
+        std::chrono::steady_clock::now() - start};
+
+    fmt::print("{} games, {} steps of {:.4f} s, {} threads, seed {}\n", games,
+               steps, deltaTime, threads, seed);
+    fmt::print("{:.0f} bounces, {} games lost\n", bounces, gamesLost);
+    fmt::print("{:.3f} s, {:.0f} simulated game steps/s\n", elapsed.count(),
+               static_cast<double>(games * steps) / elapsed.count());
+  } catch (std::exception const &exception) {
+    fmt::print(stderr, "{}\n", exception.what());
+    return -1;
+  }
+  return 0;
+}
\ No newline at end of file
@@ -0,0 +1,202 @@
+#include "batchsimulation.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include <cppitertools/itertools.hpp>
+#include <gsl/gsl>
+
+#include "ball.hpp"
+#include "bar.hpp"
+
+namespace {
+
+// Same dimensions as Ball and Bar
+Ball const defaultBall;
+Bar const defaultBar;
+float const ballRadius{defaultBall.m_scale};
+float const barY{-0.975f};
+float const barHalfWidth{Bar::m_halfWidth * defaultBar.m_scale};
+float const barHalfHeight{Bar::m_halfHeight * defaultBar.m_scale};
+float const barLimit{0.825f};
+float const loseY{-0.92f};
+
+// Random number in [0, 1) from a xorshift32 state
+float random(std::uint32_t &state) {
+  state ^= state << 13U;
+  state ^= state >> 17U;
+  state ^= state << 5U;
+  return static_cast<float>(state >> 8U) / 16777216.0f;
+}
+
+} // namespace
+
+BatchSimulation::~BatchSimulation() { destroy(); }
+
+void BatchSimulation::create(std::size_t gameCount, unsigned int seed,
+                             std::size_t threadCount) {
+  destroy();
+
+  for (auto *array :
+       {&m_ballX, &m_ballY, &m_velocityX, &m_velocityY, &m_barX, &m_reward}) {
+    array->assign(gameCount, 0.0f);
+  }
+  m_randomState.resize(gameCount);
+  m_done.assign(gameCount, 0);
+
+  for (auto const index : iter::range(gameCount)) {
+    // Nonzero, distinct state for each game
+    m_randomState[index] =
+        gsl::narrow_cast<std::uint32_t>(seed + index * 2654435761U) | 1U;
+    resetGame(index);
+  }
+
+  // The calling thread steps the first range; each worker steps another
+  auto const maxThreads{std::max<std::size_t>(gameCount, 1)};
+  m_threadCount = std::clamp<std::size_t>(threadCount, 1, maxThreads);
+  if (m_threadCount > 1) {
+    auto const count{gsl::narrow<std::ptrdiff_t>(m_threadCount)};
+    m_start = std::make_unique<std::barrier<>>(count);
+    m_finish = std::make_unique<std::barrier<>>(count);
+    m_stop = false;
+    for (auto const worker : iter::range<std::size_t>(1, m_threadCount)) {
+      m_workers.emplace_back([this, worker] { workerLoop(worker); });
+    }
+  }
+}
+
+void BatchSimulation::destroy() {
+  if (!m_workers.empty()) {
+    m_stop = true;
+    m_start->arrive_and_wait();
+    m_workers.clear();
+  }
+  m_start.reset();
+  m_finish.reset();
+}
+
+void BatchSimulation::step(std::span<GameInput const> inputs,
+                           float deltaTime) {
+  Expects(inputs.size() == size());
+
+  m_inputs = inputs;
+  m_deltaTime = deltaTime;
+
+  if (m_workers.empty()) {
+    stepRange(0, size());
+    return;
+  }
+
+  m_start->arrive_and_wait();
+  stepRange(0, size() / m_threadCount);
+  m_finish->arrive_and_wait();
+}
+
+void BatchSimulation::resetGame(std::size_t index) {
+  m_ballX[index] = 0.0f;
+  m_ballY[index] = -0.9f;
+  m_barX[index] = 0.0f;
+
+  // Random direction pointing up, as in Ball::reset
+  auto &state{m_randomState[index]};
+  auto const x{random(state) * 2.0f - 1.0f};
+  auto const y{std::max(random(state), 1.0e-3f)};
+  auto const speed{0.5f / std::sqrt(x * x + y * y)};
+  m_velocityX[index] = x * speed;
+  m_velocityY[index] = y * speed;
+}
+
+void BatchSimulation::stepRange(std::size_t begin, std::size_t end) {
+  // Games lost in the previous step start over
+  for (auto const index : iter::range(begin, end)) {
+    if (m_done[index] != 0)
+      resetGame(index);
+  }
+
+  auto const deltaTime{m_deltaTime};
+  auto const infinity{std::numeric_limits<float>::infinity()};
+
+  auto const *inputs{m_inputs.data()};
+  auto *ballX{m_ballX.data()};
+  auto *ballY{m_ballY.data()};
+  auto *velocityX{m_velocityX.data()};
+  auto *velocityY{m_velocityY.data()};
+  auto *barX{m_barX.data()};
+  auto *done{m_done.data()};
+  auto *reward{m_reward.data()};
+
+  // NOLINTBEGIN(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+  // Bar, as in Bar::update
+  for (auto index{begin}; index < end; ++index) {
+    auto const left{(inputs[index] >> static_cast<unsigned>(Input::Left)) &
+                    1U};
+    auto const right{(inputs[index] >> static_cast<unsigned>(Input::Right)) &
+                     1U};
+    auto x{barX[index]};
+    x -= (left != 0U && x > -barLimit) ? deltaTime : 0.0f;
+    x += (right != 0U && x < barLimit) ? deltaTime : 0.0f;
+    barX[index] = x;
+  }
+
+  // Ball, as in Ball::update. Each contact is the earliest time of impact
+  // against the side walls, the top wall and the top face of the bar
+  auto const minX{-1.0f + ballRadius};
+  auto const maxX{1.0f - ballRadius};
+  auto const maxY{1.0f - ballRadius};
+  auto const barTop{barY + barHalfHeight + ballRadius};
+  auto const barReach{barHalfWidth + ballRadius};
+  for (auto index{begin}; index < end; ++index) {
+    auto x{ballX[index]};
+    auto y{ballY[index]};
+    auto vx{velocityX[index]};
+    auto vy{velocityY[index]};
+    auto timeLeft{deltaTime};
+    auto bounces{0.0f};
+
+    for (auto contact{0}; contact < 2; ++contact) {
+      auto const toWallX{vx < 0.0f   ? (minX - x) / vx
+                         : vx > 0.0f ? (maxX - x) / vx
+                                     : infinity};
+      auto const toWallY{vy > 0.0f ? (maxY - y) / vy : infinity};
+      auto toBar{vy < 0.0f && y >= barTop ? (barTop - y) / vy : infinity};
+      toBar = std::abs(x + vx * toBar - barX[index]) <= barReach ? toBar
+                                                                  : infinity;
+
+      auto const time{
+          std::max(0.0f, std::min(std::min(toWallX, toWallY), toBar))};
+      auto const hit{time <= timeLeft};
+      auto const advance{hit ? time : timeLeft};
+      x += vx * advance;
+      y += vy * advance;
+      timeLeft -= advance;
+
+      vx = hit && time == std::max(0.0f, toWallX) ? -vx : vx;
+      auto const hitBar{hit && time == std::max(0.0f, toBar)};
+      vy = hitBar || (hit && time == std::max(0.0f, toWallY)) ? -vy : vy;
+      bounces += hitBar ? 1.0f : 0.0f;
+    }
+
+    auto const lost{y < loseY};
+    ballX[index] = x;
+    ballY[index] = y;
+    velocityX[index] = vx;
+    velocityY[index] = vy;
+    done[index] = lost ? 1 : 0;
+    reward[index] = bounces - (lost ? 1.0f : 0.0f);
+  }
+  // NOLINTEND(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+}
+
+void BatchSimulation::workerLoop(std::size_t worker) {
+  auto const begin{size() * worker / m_threadCount};
+  auto const end{size() * (worker + 1) / m_threadCount};
+
+  while (true) {
+    m_start->arrive_and_wait();
+    if (m_stop)
+      break;
+    stepRange(begin, end);
+    m_finish->arrive_and_wait();
+  }
+}
\ No newline at end of file
@@ -0,0 +1,90 @@
+#ifndef BATCHSIMULATION_HPP_
+#define BATCHSIMULATION_HPP_
+
+#include <atomic>
+#include <barrier>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <thread>
+#include <vector>
+
+#include "gamedata.hpp"
+
+// Input of one game: bit i is Input i, i.e., GameData::m_input.to_ulong()
+using GameInput = std::uint8_t;
+
+// Many independent games stepped together for bot training. The state of
+// each game is stored in one array per component (structure of arrays), and
+// each step is a few branch-free loops over the arrays, which the compiler
+// turns into SIMD code. Games are split into contiguous ranges, one per
+// worker thread.
+//
+// The rules are the same as those of Simulation, with two simplifications
+// that keep the loops branch-free: the bar is only its top face (widened by
+// the ball radius), and there are at most two contacts per step. A lost game
+// is reset at the start of the next step instead of after 5 seconds.
+class BatchSimulation {
+public:
+  BatchSimulation() = default;
+  BatchSimulation(BatchSimulation const &) = delete;
+  BatchSimulation &operator=(BatchSimulation const &) = delete;
+  ~BatchSimulation();
+
+  void create(std::size_t gameCount, unsigned int seed,
+              std::size_t threadCount = std::thread::hardware_concurrency());
+  void destroy();
+
+  // Advances all games by deltaTime. inputs must have one element per game
+  void step(std::span<GameInput const> inputs, float deltaTime);
+
+  [[nodiscard]] std::size_t size() const noexcept { return m_ballX.size(); }
+
+  // 1 if the game was lost in the last step
+  [[nodiscard]] std::span<std::uint8_t const> getDone() const noexcept {
+    return m_done;
+  }
+  // +1 for each bounce off the bar and -1 for a lost game in the last step
+  [[nodiscard]] std::span<float const> getReward() const noexcept {
+    return m_reward;
+  }
+
+  [[nodiscard]] std::span<float const> getBallX() const noexcept {
+    return m_ballX;
+  }
+  [[nodiscard]] std::span<float const> getBallY() const noexcept {
+    return m_ballY;
+  }
+  [[nodiscard]] std::span<float const> getBarX() const noexcept {
+    return m_barX;
+  }
+
+private:
+  void resetGame(std::size_t index);
+  void stepRange(std::size_t begin, std::size_t end);
+  void workerLoop(std::size_t worker);
+
+  // Game state
+  std::vector<float> m_ballX, m_ballY;
+  std::vector<float> m_velocityX, m_velocityY;
+  std::vector<float> m_barX;
+  std::vector<std::uint32_t> m_randomState;
+
+  // Output of the last step
+  std::vector<std::uint8_t> m_done;
+  std::vector<float> m_reward;
+
+  // Arguments of the current step, read by the workers
+  std::span<GameInput const> m_inputs;
+  float m_deltaTime{};
+
+  // Worker threads wait on m_start, step their range, and wait on m_finish
+  std::size_t m_threadCount{1};
+  std::vector<std::jthread> m_workers;
+  std::unique_ptr<std::barrier<>> m_start;
+  std::unique_ptr<std::barrier<>> m_finish;
+  std::atomic<bool> m_stop{};
+};
+
+#endif
\ No newline at end of file
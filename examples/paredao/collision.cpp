@@ -0,0 +1,99 @@
+#include "collision.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+#include <glm/geometric.hpp>
+
+namespace {
+
+// Circle against a point, i.e., a ray against a circle centered at the point
+std::optional<Contact> sweepCirclePoint(glm::vec2 center, float radius,
+                                        glm::vec2 displacement,
+                                        glm::vec2 point) {
+  auto const offset{center - point};
+  auto const a{glm::dot(displacement, displacement)};
+  auto const b{glm::dot(offset, displacement)};
+  auto const c{glm::dot(offset, offset) - radius * radius};
+
+  // Not moving toward the point
+  if (b >= 0.0f || a == 0.0f)
+    return std::nullopt;
+
+  // Already overlapping
+  if (c <= 0.0f)
+    return Contact{.time = 0.0f, .normal = glm::normalize(offset)};
+
+  auto const discriminant{b * b - a * c};
+  if (discriminant < 0.0f)
+    return std::nullopt;
+
+  auto const time{(-b - std::sqrt(discriminant)) / a};
+  if (time > 1.0f)
+    return std::nullopt;
+
+  return Contact{.time = time,
+                 .normal = glm::normalize(offset + displacement * time)};
+}
+
+} // namespace
+
+std::optional<Contact> earliestContact(std::optional<Contact> const &first,
+                                       std::optional<Contact> const &second) {
+  if (!first)
+    return second;
+  if (!second)
+    return first;
+  return first->time <= second->time ? first : second;
+}
+
+std::optional<Contact> sweepCircleSegment(glm::vec2 center, float radius,
+                                          glm::vec2 displacement,
+                                          Segment const &segment) {
+  auto const edge{segment.b - segment.a};
+  auto const length{glm::length(edge)};
+  if (length == 0.0f)
+    return sweepCirclePoint(center, radius, displacement, segment.a);
+
+  // Normal of the side of the segment where the circle is
+  auto normal{glm::vec2{-edge.y, edge.x} / length};
+  auto distance{glm::dot(center - segment.a, normal)};
+  if (distance < 0.0f) {
+    normal = -normal;
+    distance = -distance;
+  }
+
+  // Contact with the interior of the segment
+  if (auto const approach{glm::dot(displacement, normal)}; approach < 0.0f) {
+    auto const time{std::max(0.0f, (distance - radius) / -approach)};
+    if (time <= 1.0f) {
+      auto const contactCenter{center + displacement * time};
+      auto const along{glm::dot(contactCenter - segment.a, edge) /
+                       (length * length)};
+      if (along >= 0.0f && along <= 1.0f)
+        return Contact{.time = time, .normal = normal};
+    }
+  }
+
+  // Contact with the end points
+  return earliestContact(
+      sweepCirclePoint(center, radius, displacement, segment.a),
+      sweepCirclePoint(center, radius, displacement, segment.b));
+}
+
+std::optional<Contact> sweepCircleBox(glm::vec2 center, float radius,
+                                      glm::vec2 displacement, Box const &box) {
+  std::array const edges{
+      Segment{{box.min.x, box.min.y}, {box.max.x, box.min.y}},
+      Segment{{box.max.x, box.min.y}, {box.max.x, box.max.y}},
+      Segment{{box.max.x, box.max.y}, {box.min.x, box.max.y}},
+      Segment{{box.min.x, box.max.y}, {box.min.x, box.min.y}}};
+
+  std::optional<Contact> contact;
+  for (auto const &edge : edges) {
+    contact = earliestContact(
+        contact, sweepCircleSegment(center, radius, displacement, edge));
+  }
+  return contact;
+}
\ No newline at end of file
@@ -0,0 +1,40 @@
+#ifndef COLLISION_HPP_
+#define COLLISION_HPP_
+
+#include <optional>
+
+#include <glm/vec2.hpp>
+
+// First contact of a moving circle
+struct Contact {
+  // Fraction of the displacement traveled before the contact, in [0, 1]
+  float time{};
+  // Unit normal of the surface at the contact, pointing toward the circle
+  glm::vec2 normal{};
+};
+
+struct Segment {
+  glm::vec2 a{};
+  glm::vec2 b{};
+};
+
+struct Box {
+  glm::vec2 min{};
+  glm::vec2 max{};
+};
+
+[[nodiscard]] std::optional<Contact>
+earliestContact(std::optional<Contact> const &first,
+                std::optional<Contact> const &second);
+
+// Swept tests of a circle moving from center to center + displacement. Only
+// contacts where the circle moves toward the surface are reported, so a
+// circle that has just bounced off a surface does not hit it again
+[[nodiscard]] std::optional<Contact>
+sweepCircleSegment(glm::vec2 center, float radius, glm::vec2 displacement,
+                   Segment const &segment);
+[[nodiscard]] std::optional<Contact>
+sweepCircleBox(glm::vec2 center, float radius, glm::vec2 displacement,
+               Box const &box);
+
+#endif
\ No newline at end of file
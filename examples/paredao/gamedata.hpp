@@ -9,6 +9,8 @@ enum class State { Playing, GameOver, Win };
 struct GameData {
   State m_state{State::Playing};
   std::bitset<5> m_input; // [fire, up, down, left, right]
+
+  bool operator==(GameData const &) const = default;
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,101 @@
+// Runs the paredao simulation at maximum speed, without window, graphics or
+// UI. The bar is driven by a bot that follows the ball.
+//
+// With a rollback of n frames, each frame is followed by restoring the
+// snapshot of n frames before and simulating them again, as when a late
+// input arrives. The re-simulated state must be identical.
+//
+// Usage: paredao_headless [frames] [seed] [time step in seconds] [rollback]
+
+#include <chrono>
+#include <exception>
+#include <string>
+
+#include <fmt/core.h>
+#include <gsl/gsl>
+
+#include "simulation.hpp"
+#include "snapshotring.hpp"
+
+namespace {
+
+// Moves the bar toward the ball
+void moveBar(Simulation &simulation) {
+  auto const offset{simulation.getBall().m_translation.x -
+                    simulation.getBar().m_translation.x};
+  simulation.setInput(Input::Left, offset < -0.02f);
+  simulation.setInput(Input::Right, offset > +0.02f);
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  try {
+    auto const frames{argc > 1 ? std::stoull(argv[1]) : 1'000'000ULL};
+    auto const seed{argc > 2 ? std::stoul(argv[2]) : 42UL};
+    auto const deltaTime{argc > 3 ? std::stof(argv[3]) : 1.0f / 60.0f};
+    auto const rollback{argc > 4 ? std::stoull(argv[4]) : 0ULL};
+
+    Simulation simulation;
+    simulation.create(static_cast<unsigned int>(seed));
+
+    SnapshotRing snapshots{gsl::narrow<std::size_t>(rollback + 1)};
+    snapshots.save(simulation);
+    SimulationState current;
+    SimulationState resimulated;
+    auto mismatches{0ULL};
+
+    auto bounces{0ULL};
+    auto gamesLost{0ULL};
+    auto const start{std::chrono::steady_clock::now()};
+
+    for (auto frame{0ULL}; frame < frames; ++frame) {
+      moveBar(simulation);
+
+      auto const wasPlaying{simulation.getGameData().m_state ==
+                            State::Playing};
+      simulation.step(deltaTime);
+
+      if (simulation.getBall().m_hitBar)
+        ++bounces;
+      if (wasPlaying && simulation.getGameData().m_state != State::Playing)
+        ++gamesLost;
+
+      if (rollback == 0)
+        continue;
+
+      snapshots.save(simulation);
+      if (simulation.getFrame() < rollback)
+        continue;
+      auto const target{simulation.getFrame() - rollback};
+
+      simulation.save(current);
+      snapshots.restore(simulation, target);
+      for (auto step{0ULL}; step < rollback; ++step) {
+        moveBar(simulation);
+        simulation.step(deltaTime);
+        snapshots.save(simulation);
+      }
+      simulation.save(resimulated);
+      if (!(resimulated == current))
+        ++mismatches;
+    }
+
+    std::chrono::duration<double> const elapsed{
+        std::chrono::steady_clock::now() - start};
+
+    fmt::print("{} frames of {:.4f} s with seed {}\n", frames, deltaTime,
+               seed);
+    fmt::print("{} bounces, {} games lost\n", bounces, gamesLost);
+    if (rollback > 0) {
+      fmt::print("Rollback of {} frames: {} mismatches\n", rollback,
+                 mismatches);
+    }
+    fmt::print("{:.3f} s, {:.0f} simulated frames/s\n", elapsed.count(),
+               static_cast<double>(frames) / elapsed.count());
+  } catch (std::exception const &exception) {
+    fmt::print(stderr, "{}\n", exception.what());
+    return -1;
+  }
+  return 0;
+}
\ No newline at end of file
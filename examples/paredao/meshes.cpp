@@ -0,0 +1,114 @@
+#include "meshes.hpp"
+
+#include "bar.hpp"
+
+void BallMesh::create(abcg::OpenGLProgram const &program, int polygonSides) {
+  destroy();
+
+  // Create geometry data
+  std::vector<glm::vec2> positions{{0, 0}};
+  auto const step{M_PI * 2 / polygonSides};
+  for (auto const angle : iter::range(0.0, M_PI * 2, step)) {
+    positions.emplace_back(std::cos(angle), std::sin(angle));
+  }
+  positions.push_back(positions.at(1));
+  m_vertexCount = gsl::narrow<GLsizei>(positions.size());
+
+  // Generate VBO
+  m_VBO = abcg::OpenGLBuffer::acquire();
+  abcg::glBindBuffer(GL_ARRAY_BUFFER, m_VBO.get());
+  abcg::glBufferData(GL_ARRAY_BUFFER, positions.size() * sizeof(glm::vec2),
+                     positions.data(), GL_STATIC_DRAW);
+  abcg::glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+  // Get location of attributes in the program
+  auto const positionAttribute{program.getAttributeLocation("inPosition")};
+
+  // Create VAO
+  m_VAO = abcg::OpenGLVertexArray::acquire();
+
+  // Bind vertex attributes to current VAO
+  abcg::glBindVertexArray(m_VAO.get());
+
+  abcg::glBindBuffer(GL_ARRAY_BUFFER, m_VBO.get());
+  abcg::glEnableVertexAttribArray(positionAttribute);
+  abcg::glVertexAttribPointer(positionAttribute, 2, GL_FLOAT, GL_FALSE, 0,
+                              nullptr);
+  abcg::glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+  // End of binding to current VAO
+  abcg::glBindVertexArray(0);
+}
+
+void BallMesh::draw() const {
+  abcg::glBindVertexArray(m_VAO.get());
+  abcg::glDrawArrays(GL_TRIANGLE_FAN, 0, m_vertexCount);
+  abcg::glBindVertexArray(0);
+}
+
+void BallMesh::destroy() {
+  m_VBO.reset();
+  m_VAO.reset();
+  m_vertexCount = 0;
+}
+
+void BarMesh::create(abcg::OpenGLProgram const &program) {
+  destroy();
+
+  // clang-format off
+  std::array const positions{
+      glm::vec2{-Bar::m_halfWidth, +Bar::m_halfHeight},
+      glm::vec2{+Bar::m_halfWidth, +Bar::m_halfHeight},
+      glm::vec2{-Bar::m_halfWidth, -Bar::m_halfHeight},
+      glm::vec2{+Bar::m_halfWidth, -Bar::m_halfHeight}};
+
+  std::array const indices{0, 1, 3,
+                           0, 2, 3};
+  // clang-format on
+
+  // Generate VBO
+  m_VBO = abcg::OpenGLBuffer::acquire();
+  abcg::glBindBuffer(GL_ARRAY_BUFFER, m_VBO.get());
+  abcg::glBufferData(GL_ARRAY_BUFFER, sizeof(positions), positions.data(),
+                     GL_STATIC_DRAW);
+  abcg::glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+  // Generate EBO
+  m_EBO = abcg::OpenGLBuffer::acquire();
+  abcg::glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_EBO.get());
+  abcg::glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices.data(),
+                     GL_STATIC_DRAW);
+  abcg::glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+  // Get location of attributes in the program
+  auto const positionAttribute{program.getAttributeLocation("inPosition")};
+
+  // Create VAO
+  m_VAO = abcg::OpenGLVertexArray::acquire();
+
+  // Bind vertex attributes to current VAO
+  abcg::glBindVertexArray(m_VAO.get());
+
+  abcg::glEnableVertexAttribArray(positionAttribute);
+  abcg::glBindBuffer(GL_ARRAY_BUFFER, m_VBO.get());
+  abcg::glVertexAttribPointer(positionAttribute, 2, GL_FLOAT, GL_FALSE, 0,
+                              nullptr);
+  abcg::glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+  abcg::glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_EBO.get());
+
+  // End of binding to current VAO
+  abcg::glBindVertexArray(0);
+}
+
+void BarMesh::draw() const {
+  abcg::glBindVertexArray(m_VAO.get());
+  abcg::glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, nullptr);
+  abcg::glBindVertexArray(0);
+}
+
+void BarMesh::destroy() {
+  m_VBO.reset();
+  m_EBO.reset();
+  m_VAO.reset();
+}
\ No newline at end of file
@@ -0,0 +1,32 @@
+#ifndef MESHES_HPP_
+#define MESHES_HPP_
+
+#include "abcgOpenGL.hpp"
+
+// Unit circle shared by all balls. It is built once and reused by restarts
+class BallMesh {
+public:
+  void create(abcg::OpenGLProgram const &program, int polygonSides = 20);
+  void draw() const;
+  void destroy();
+
+private:
+  abcg::OpenGLVertexArray m_VAO;
+  abcg::OpenGLBuffer m_VBO;
+  GLsizei m_vertexCount{};
+};
+
+// Unscaled bar rectangle
+class BarMesh {
+public:
+  void create(abcg::OpenGLProgram const &program);
+  void draw() const;
+  void destroy();
+
+private:
+  abcg::OpenGLVertexArray m_VAO;
+  abcg::OpenGLBuffer m_VBO;
+  abcg::OpenGLBuffer m_EBO;
+};
+
+#endif
\ No newline at end of file
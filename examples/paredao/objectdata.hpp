@@ -0,0 +1,21 @@
+#ifndef OBJECTDATA_HPP_
+#define OBJECTDATA_HPP_
+
+#include "abcgOpenGL.hpp"
+
+// Contents of the ObjectData uniform block of objects.vert
+struct alignas(16) ObjectData {
+  glm::vec4 color{1};
+  glm::vec2 translation{};
+  float scale{1};
+};
+ABCG_STD140_MEMBER(ObjectData, color);
+ABCG_STD140_MEMBER(ObjectData, translation);
+ABCG_STD140_MEMBER(ObjectData, scale);
+
+// Instances of ObjectData in the uniform buffer
+enum class ObjectSlot { Ball, Bar, BarTrail, Count };
+
+using ObjectBuffer = abcg::OpenGLUniformBuffer<ObjectData>;
+
+#endif
\ No newline at end of file
@@ -0,0 +1,49 @@
+#include "simulation.hpp"
+
+#include <gsl/gsl>
+
+void Simulation::create(unsigned int seed) {
+  m_state = {};
+  m_state.randomEngine.seed(seed);
+
+  restart();
+}
+
+void Simulation::restart() {
+  m_state.gameData.m_state = State::Playing;
+  m_state.restartWaitTime = 0.0f;
+
+  m_state.bar.reset();
+  m_state.ball.reset(m_state.randomEngine);
+}
+
+void Simulation::step(float deltaTime) {
+  ++m_state.frame;
+
+  // Wait 5 seconds before restarting
+  if (m_state.gameData.m_state != State::Playing) {
+    m_state.restartWaitTime += deltaTime;
+    if (m_state.restartWaitTime > 5.0f) {
+      restart();
+      return;
+    }
+  }
+
+  m_state.bar.update(m_state.gameData, deltaTime);
+  m_state.ball.update(m_state.bar, deltaTime);
+
+  if (m_state.gameData.m_state == State::Playing) {
+    checkWinCondition();
+  }
+}
+
+void Simulation::setInput(Input input, bool pressed) {
+  m_state.gameData.m_input.set(gsl::narrow<size_t>(input), pressed);
+}
+
+void Simulation::checkWinCondition() {
+  if (m_state.ball.m_translation.y < -0.92f) {
+    m_state.gameData.m_state = State::GameOver;
+    m_state.restartWaitTime = 0.0f;
+  }
+}
\ No newline at end of file
@@ -0,0 +1,58 @@
+#ifndef SIMULATION_HPP_
+#define SIMULATION_HPP_
+
+#include <cstdint>
+#include <random>
+#include <type_traits>
+
+#include "ball.hpp"
+#include "bar.hpp"
+#include "gamedata.hpp"
+
+// Complete state of a game. It is trivially copyable, so that a snapshot is
+// a single contiguous copy with no allocation
+struct SimulationState {
+  GameData gameData;
+  Ball ball;
+  Bar bar;
+
+  // Simulated seconds since the game was lost
+  float restartWaitTime{};
+
+  // Number of steps since the simulation was created
+  std::uint64_t frame{};
+
+  std::default_random_engine randomEngine;
+
+  bool operator==(SimulationState const &) const = default;
+};
+
+static_assert(std::is_trivially_copyable_v<SimulationState>);
+
+// Game state and rules, independent of windows, graphics and UI. Given the
+// same seed, time steps and inputs, it always produces the same game
+class Simulation {
+public:
+  void create(unsigned int seed);
+  void restart();
+  void step(float deltaTime);
+  void setInput(Input input, bool pressed);
+
+  // Snapshot of the whole state, e.g., for rolling back and re-simulating
+  void save(SimulationState &snapshot) const { snapshot = m_state; }
+  void restore(SimulationState const &snapshot) { m_state = snapshot; }
+
+  [[nodiscard]] GameData const &getGameData() const {
+    return m_state.gameData;
+  }
+  [[nodiscard]] Ball const &getBall() const { return m_state.ball; }
+  [[nodiscard]] Bar const &getBar() const { return m_state.bar; }
+  [[nodiscard]] std::uint64_t getFrame() const { return m_state.frame; }
+
+private:
+  void checkWinCondition();
+
+  SimulationState m_state;
+};
+
+#endif
\ No newline at end of file
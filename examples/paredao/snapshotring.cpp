@@ -0,0 +1,25 @@
+#include "snapshotring.hpp"
+
+#include <gsl/gsl>
+
+SnapshotRing::SnapshotRing(std::size_t capacity)
+    : m_snapshots(capacity), m_used(capacity) {
+  Expects(capacity > 0);
+}
+
+void SnapshotRing::save(Simulation const &simulation) {
+  auto const slot{simulation.getFrame() % m_snapshots.size()};
+  simulation.save(m_snapshots[slot]);
+  m_used[slot] = true;
+}
+
+// The frame must not have been overwritten by a later one
+void SnapshotRing::restore(Simulation &simulation, std::uint64_t frame) const {
+  Expects(contains(frame));
+  simulation.restore(m_snapshots[frame % m_snapshots.size()]);
+}
+
+bool SnapshotRing::contains(std::uint64_t frame) const {
+  auto const slot{frame % m_snapshots.size()};
+  return m_used[slot] && m_snapshots[slot].frame == frame;
+}
\ No newline at end of file
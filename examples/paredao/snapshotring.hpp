@@ -0,0 +1,28 @@
+#ifndef SNAPSHOTRING_HPP_
+#define SNAPSHOTRING_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "simulation.hpp"
+
+// Snapshots of the last frames of a simulation, for rolling back and
+// re-simulating. The snapshot of frame f is kept in slot f % capacity. All
+// slots are allocated on construction, so saving is a single copy
+class SnapshotRing {
+public:
+  explicit SnapshotRing(std::size_t capacity);
+
+  void save(Simulation const &simulation);
+  void restore(Simulation &simulation, std::uint64_t frame) const;
+  [[nodiscard]] bool contains(std::uint64_t frame) const;
+
+  [[nodiscard]] std::size_t capacity() const { return m_snapshots.size(); }
+
+private:
+  std::vector<SimulationState> m_snapshots;
+  std::vector<bool> m_used;
+};
+
+#endif
\ No newline at end of file
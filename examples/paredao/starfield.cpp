@@ -0,0 +1,68 @@
+#include "starfield.hpp"
+
+void Starfield::create(abcg::OpenGLProgram const &program, int starCount,
+                       std::default_random_engine &randomEngine) {
+  destroy();
+
+  m_program = program;
+  m_timeLocation = program.getUniformLocation("time");
+  m_starCount = starCount;
+
+  // Each star is (x, y, depth, phase). Motion is computed in stars.vert, so
+  // the buffer is never updated after this
+  std::uniform_real_distribution randomPosition{-1.0f, 1.0f};
+  std::uniform_real_distribution randomUnit{0.0f, 1.0f};
+  std::vector<glm::vec4> stars(gsl::narrow<std::size_t>(starCount));
+  for (auto &star : stars) {
+    star = {randomPosition(randomEngine), randomPosition(randomEngine),
+            randomUnit(randomEngine), randomUnit(randomEngine)};
+  }
+
+  // Generate VBO
+  m_VBO = abcg::OpenGLBuffer::acquire();
+  abcg::glBindBuffer(GL_ARRAY_BUFFER, m_VBO.get());
+  abcg::glBufferData(GL_ARRAY_BUFFER, stars.size() * sizeof(glm::vec4),
+                     stars.data(), GL_STATIC_DRAW);
+  abcg::glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+  // Get location of attributes in the program
+  auto const starAttribute{program.getAttributeLocation("inStar")};
+
+  // Create VAO
+  m_VAO = abcg::OpenGLVertexArray::acquire();
+
+  // Bind vertex attributes to current VAO
+  abcg::glBindVertexArray(m_VAO.get());
+
+  abcg::glBindBuffer(GL_ARRAY_BUFFER, m_VBO.get());
+  abcg::glEnableVertexAttribArray(starAttribute);
+  abcg::glVertexAttribPointer(starAttribute, 4, GL_FLOAT, GL_FALSE, 0,
+                              nullptr);
+  abcg::glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+  // End of binding to current VAO
+  abcg::glBindVertexArray(0);
+}
+
+void Starfield::paint(float time) const {
+  abcg::glUseProgram(m_program);
+  abcg::glUniform1f(m_timeLocation, time);
+
+  // Additive blending so that overlapping stars get brighter
+  abcg::glEnable(GL_BLEND);
+  abcg::glBlendFunc(GL_ONE, GL_ONE);
+
+  abcg::glBindVertexArray(m_VAO.get());
+  abcg::glDrawArrays(GL_POINTS, 0, m_starCount);
+  abcg::glBindVertexArray(0);
+
+  abcg::glDisable(GL_BLEND);
+
+  abcg::glUseProgram(0);
+}
+
+void Starfield::destroy() {
+  m_VBO.reset();
+  m_VAO.reset();
+  m_starCount = 0;
+}
\ No newline at end of file
@@ -0,0 +1,25 @@
+#ifndef STARFIELD_HPP_
+#define STARFIELD_HPP_
+
+#include <random>
+
+#include "abcgOpenGL.hpp"
+
+// Background stars animated entirely in the vertex shader
+class Starfield {
+public:
+  void create(abcg::OpenGLProgram const &program, int starCount,
+              std::default_random_engine &randomEngine);
+  void paint(float time) const;
+  void destroy();
+
+private:
+  GLuint m_program{};
+  GLint m_timeLocation{};
+
+  abcg::OpenGLVertexArray m_VAO;
+  abcg::OpenGLBuffer m_VBO;
+  GLsizei m_starCount{};
+};
+
+#endif
\ No newline at end of file
@@ -1,19 +1,15 @@
 #include "window.hpp"
+#include <cmath>
 #include <cstdio>
 
 void Window::onEvent(SDL_Event const &event) {
   // Keyboard events
-  if (event.type == SDL_KEYDOWN) {
+  if (event.type == SDL_KEYDOWN || event.type == SDL_KEYUP) {
+    auto const pressed{event.type == SDL_KEYDOWN};
     if (event.key.keysym.sym == SDLK_LEFT)
-      m_gameData.m_input.set(gsl::narrow<size_t>(Input::Left));
+      m_simulation.setInput(Input::Left, pressed);
     if (event.key.keysym.sym == SDLK_RIGHT)
-      m_gameData.m_input.set(gsl::narrow<size_t>(Input::Right));
-  }
-  if (event.type == SDL_KEYUP) {
-    if (event.key.keysym.sym == SDLK_LEFT)
-      m_gameData.m_input.reset(gsl::narrow<size_t>(Input::Left));
-    if (event.key.keysym.sym == SDLK_RIGHT)
-      m_gameData.m_input.reset(gsl::narrow<size_t>(Input::Right));
+      m_simulation.setInput(Input::Right, pressed);
   }
 }
 
@@ -27,6 +23,13 @@ void Window::onCreate() {
     throw abcg::RuntimeError("Cannot load font file");
   }
 
+  // Create program to render the stars
+  m_starsProgram =
+      abcg::createOpenGLProgram({{.source = assetsPath + "stars.vert",
+                                  .stage = abcg::ShaderStage::Vertex},
+                                 {.source = assetsPath + "stars.frag",
+                                  .stage = abcg::ShaderStage::Fragment}});
+
   // Create program to render the other objects
   m_objectsProgram =
       abcg::createOpenGLProgram({{.source = assetsPath + "objects.vert",
@@ -34,51 +37,124 @@ void Window::onCreate() {
                                  {.source = assetsPath + "objects.frag",
                                   .stage = abcg::ShaderStage::Fragment}});
 
+  // Create uniform buffer with one ObjectData for each object
+  GLuint const objectDataBinding{0};
+  m_objectsProgram.bindUniformBlock("ObjectData", objectDataBinding);
+  m_objectBuffer.create(objectDataBinding,
+                        gsl::narrow<std::size_t>(ObjectSlot::Count));
+
   abcg::glClearColor(0, 0, 0, 1);
 
 #if !defined(__EMSCRIPTEN__)
   abcg::glEnable(GL_PROGRAM_POINT_SIZE);
 #endif
 
-  // Start pseudo-random number generator
-  m_randomEngine.seed(
-      std::chrono::steady_clock::now().time_since_epoch().count());
+  // Start pseudo-random number generator. The seed is the same when
+  // replaying an input recording
+  m_randomEngine.seed(getRandomSeed());
+
+  m_starfield.create(m_starsProgram, m_starCount, m_randomEngine);
+
+  // Geometry is created once and kept across restarts
+  m_ballMesh.create(m_objectsProgram);
+  m_barMesh.create(m_objectsProgram);
 
-  restart();
+  createParticles(abcg::ParticleBackend::CPU);
+
+  m_simulation.create(static_cast<unsigned int>(m_randomEngine()));
 }
 
-void Window::restart() {
-  m_gameData.m_state = State::Playing;
+void Window::createParticles(abcg::ParticleBackend backend) {
+  // The GPU backend simulates 10x more particles
+  auto const capacity{backend == abcg::ParticleBackend::CPU
+                           ? std::size_t{100'000}
+                           : std::size_t{1'000'000}};
+  m_particles.create({.backend = backend,
+                      .capacity = capacity,
+                      .acceleration = {0.0f, -1.5f, 0.0f},
+                      .drag = 1.0f,
+                      .seed = static_cast<unsigned int>(m_randomEngine())});
+}
 
-  m_bar.create(m_objectsProgram);
-  m_ball.create(m_objectsProgram);
+void Window::emitImpact() {
+  auto const &ball{m_simulation.getBall()};
+  m_particles.emit({.position = glm::vec3{ball.m_translation, 0.0f},
+                    .velocity = glm::vec3{ball.m_velocity * 0.25f, 0.0f},
+                    .speedVariation = 0.6f,
+                    .color = {1.0f, 0.8f, 0.3f, 1.0f},
+                    .lifetime = 0.8f,
+                    .size = 3.0f,
+                    .count = m_particles.getCapacity() / 50});
 }
 
 void Window::onUpdate() {
   auto const deltaTime{gsl::narrow_cast<float>(getDeltaTime())};
 
-  // Wait 5 seconds before restarting
-  if (m_gameData.m_state != State::Playing &&
-      m_restartWaitTimer.elapsed() > 5) {
-    restart();
-    return;
+  {
+    ABCG_PROFILE_ZONE("Simulation::step");
+    m_simulation.step(deltaTime);
   }
 
-  m_bar.update(m_gameData, deltaTime);
-  m_ball.update(m_bar, deltaTime);
-
-  if (m_gameData.m_state == State::Playing) {
-    checkCollisions();
-    checkWinCondition();
+  if (m_simulation.getBall().m_hitBar) {
+    emitImpact();
   }
+
+  ABCG_PROFILE_ZONE("OpenGLParticleSystem::update");
+  m_particles.update(deltaTime);
 }
 
 void Window::onPaint() {
   abcg::glClear(GL_COLOR_BUFFER_BIT);
   abcg::glViewport(0, 0, m_viewportSize.x, m_viewportSize.y);
 
-  m_ball.paint();
-  m_bar.paint(m_gameData);
+  m_starfield.paint(gsl::narrow_cast<float>(getElapsedTime()));
+
+  auto const &gameData{m_simulation.getGameData()};
+  auto const &ball{m_simulation.getBall()};
+  auto const &bar{m_simulation.getBar()};
+
+  // Upload the data of all objects with a single glBufferSubData
+  m_objectBuffer[gsl::narrow<std::size_t>(ObjectSlot::Ball)] = {
+      .color = ball.m_color,
+      .translation = ball.m_translation,
+      .scale = ball.m_scale};
+  m_objectBuffer[gsl::narrow<std::size_t>(ObjectSlot::Bar)] = {
+      .color = bar.m_color,
+      .translation = bar.m_translation,
+      .scale = bar.m_scale};
+  // 50% transparent
+  m_objectBuffer[gsl::narrow<std::size_t>(ObjectSlot::BarTrail)] = {
+      .color = glm::vec4{1, 1, 1, 0.5f},
+      .translation = bar.m_translation,
+      .scale = bar.m_scale};
+  m_objectBuffer.upload();
+
+  abcg::glUseProgram(m_objectsProgram);
+
+  m_objectBuffer.bind(gsl::narrow<std::size_t>(ObjectSlot::Ball));
+  m_ballMesh.draw();
+
+  if (gameData.m_state == State::Playing) {
+    // Show thruster trail during 50 ms every 100 ms. The window clock is
+    // used so that replayed runs blink identically
+    if (gameData.m_input[gsl::narrow<size_t>(Input::Up)] &&
+        std::fmod(getElapsedTime(), 100.0 / 1000.0) < 50.0 / 1000.0) {
+      abcg::glEnable(GL_BLEND);
+      abcg::glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+      m_objectBuffer.bind(gsl::narrow<std::size_t>(ObjectSlot::BarTrail));
+      m_barMesh.draw();
+
+      abcg::glDisable(GL_BLEND);
+    }
+
+    m_objectBuffer.bind(gsl::narrow<std::size_t>(ObjectSlot::Bar));
+    m_barMesh.draw();
+  }
+
+  abcg::glUseProgram(0);
+
+  m_particles.render();
 }
 
 void Window::onPaintUI() {
@@ -96,15 +172,41 @@ void Window::onPaintUI() {
     ImGui::Begin(" ", nullptr, flags);
     ImGui::PushFont(m_font);
 
-    if (m_gameData.m_state == State::GameOver) {
+    auto const state{m_simulation.getGameData().m_state};
+    if (state == State::GameOver) {
       ImGui::Text("Game Over!");
-    } else if (m_gameData.m_state == State::Win) {
+    } else if (state == State::Win) {
       ImGui::Text("*You Win!*");
     }
 
     ImGui::PopFont();
     ImGui::End();
   }
+
+  // Particle backend selection and simulation time
+  {
+    auto const size{ImVec2(220, 80)};
+    ImGui::SetNextWindowPos(ImVec2(m_viewportSize.x - size.x - 5, 5));
+    ImGui::SetNextWindowSize(size);
+    ImGui::Begin("Particles", nullptr, ImGuiWindowFlags_NoDecoration);
+
+    auto backend{m_particles.getBackend()};
+    auto const cpu{backend == abcg::ParticleBackend::CPU};
+    if (ImGui::RadioButton("CPU", cpu)) {
+      backend = abcg::ParticleBackend::CPU;
+    }
+    ImGui::SameLine();
+    if (ImGui::RadioButton("GPU", !cpu)) {
+      backend = abcg::ParticleBackend::GPU;
+    }
+    if (backend != m_particles.getBackend()) {
+      createParticles(backend);
+    }
+
+    ImGui::Text("%zu live", m_particles.getLiveCount());
+    ImGui::Text("%.3f ms simulation", m_particles.getSimulationTime());
+    ImGui::End();
+  }
 }
 
 void Window::onResize(glm::ivec2 const &size) {
@@ -116,23 +218,10 @@ void Window::onResize(glm::ivec2 const &size) {
 void Window::onDestroy() {
   abcg::glDeleteProgram(m_starsProgram);
   abcg::glDeleteProgram(m_objectsProgram);
+  m_objectBuffer.destroy();
 
-  m_ball.destroy();
-  m_bar.destroy();
-}
-
-void Window::checkCollisions() {
-  // Check collision between ball and bar
-  if (m_ball.m_translation.y < -0.85f) {
-    if (glm::distance(m_ball.m_translation, m_bar.m_translation) < 0.3) {
-      m_ball.m_velocity.y = m_ball.m_velocity.y;
-    }
-  }
-}
-
-void Window::checkWinCondition() {
-  if (m_ball.m_translation.y < -0.92f) {
-    m_gameData.m_state = State::GameOver;
-    m_restartWaitTimer.restart();
-  }
+  m_particles.destroy();
+  m_starfield.destroy();
+  m_barMesh.destroy();
+  m_ballMesh.destroy();
 }
\ No newline at end of file
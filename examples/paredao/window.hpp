@@ -5,8 +5,10 @@
 
 #include "abcgOpenGL.hpp"
 
-#include "ball.hpp"
-#include "bar.hpp"
+#include "meshes.hpp"
+#include "objectdata.hpp"
+#include "simulation.hpp"
+#include "starfield.hpp"
 
 class Window : public abcg::OpenGLWindow {
 protected:
@@ -17,27 +19,35 @@ protected:
   void onPaintUI() override;
   void onResize(glm::ivec2 const &size) override;
   void onDestroy() override;
-  void checkCollisions();
-  void checkWinCondition();
 
 private:
   glm::ivec2 m_viewportSize{};
 
-  GLuint m_starsProgram{};
-  GLuint m_objectsProgram{};
+  abcg::OpenGLProgram m_starsProgram;
+  abcg::OpenGLProgram m_objectsProgram;
 
-  GameData m_gameData;
+  // Uniform buffer of all objects, uploaded once per frame
+  ObjectBuffer m_objectBuffer;
 
-  Ball m_ball;
-  Bar m_bar;
+  // Number of stars. Raise it to stress vertex throughput
+  static constexpr int m_starCount{131072};
+  Starfield m_starfield;
 
-  abcg::Timer m_restartWaitTimer;
+  // Game state, updated in onUpdate and drawn with the meshes below
+  Simulation m_simulation;
+
+  BallMesh m_ballMesh;
+  BarMesh m_barMesh;
+
+  // Sparks emitted when the ball hits the bar
+  abcg::OpenGLParticleSystem m_particles;
 
   ImFont *m_font{};
 
   std::default_random_engine m_randomEngine;
 
-  void restart();
+  void createParticles(abcg::ParticleBackend backend);
+  void emitImpact();
 };
 
 #endif
\ No newline at end of file